@@ -1,9 +1,14 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+#include "aabb.h"
 #include "ray.h"
 #include "vec3.h"
 
-class Material;
+class Hittable;
 
 /**
  * Struct storing the point of intersection, surface normal, 
@@ -16,15 +21,26 @@ struct HitRecord {
   // vec3 representing the surface normal 
   vec3 surface_normal_;
 
-  // shared pointer to the class of the material of the hit object
-  std::shared_ptr<Material> material_pointer;
+  // material ID (index into the scene's material_table) of the material of the hit object
+  uint32_t material_id_;
 
-  // double representing the t value at which the intersection occurs
-  double t_;
+  // real representing the t value at which the intersection occurs
+  real t_;
 
   // bool that is true if the ray is front facing (insersects the hittable obect from the inside)
   bool front_facing_;
 
+  // pointer to the primitive object that was hit (set by intersect, used to finalize the hit)
+  const Hittable* hit_object_;
+
+  // index of the primitive that was hit within the hit object, for objects that store several 
+  // primitives (like sphere_set)
+  uint32_t primitive_index_;
+
+  // object hit inside an instance (set by instance::intersect, whose hit_object_ is the 
+  // instance itself)
+  const Hittable* instanced_object_;
+
   /**
    * Sets the surface normal to always point against the direction of the ray and updates front_facing_
    * 
@@ -46,6 +62,78 @@ struct HitRecord {
   }
 };
 
+// hit records are copied, batched, and sorted as plain bytes
+static_assert(std::is_trivially_copyable<HitRecord>::value, "HitRecord must stay trivially copyable");
+
+// largest number of rays in a RayPacket (a multiple of every RealLanes width)
+const size_t kMaxRayPacketSize = 16;
+
+/**
+ * Struct storing a bundle of coherent rays (like the camera rays of a block of pixels) that are
+ * traced together, with the closest hit found so far for each of them
+ *
+ * The origins and inverse directions are also stored as a structure of arrays so traversal can
+ * test a box against several rays of the packet at once. Slots past size_ have a max_t_ of
+ * -infinity, so they never hit anything
+ */
+struct RayPacket {
+  // rays of the packet
+  ray rays_[kMaxRayPacketSize];
+
+  // x, y, and z components of the origins of the rays
+  real origin_x_[kMaxRayPacketSize];
+  real origin_y_[kMaxRayPacketSize];
+  real origin_z_[kMaxRayPacketSize];
+
+  // x, y, and z components of 1 / the directions of the rays
+  real inverse_direction_x_[kMaxRayPacketSize];
+  real inverse_direction_y_[kMaxRayPacketSize];
+  real inverse_direction_z_[kMaxRayPacketSize];
+
+  // maximum t value of every ray (the t value of its closest hit once it has hit something)
+  real max_t_[kMaxRayPacketSize];
+
+  // closest hit of every ray that was_hit_ is true for (only updated like intersect does)
+  HitRecord hit_records_[kMaxRayPacketSize];
+
+  // true for every ray that has hit something
+  bool was_hit_[kMaxRayPacketSize];
+
+  // number of rays in the packet
+  size_t size_;
+
+  /**
+   * Removes every ray from the packet
+   */
+  inline void clear() {
+    size_ = 0;
+    for (size_t i = 0; i < kMaxRayPacketSize; ++i) {
+      max_t_[i] = -infinity;
+      was_hit_[i] = false;
+    }
+  }
+
+  /**
+   * Adds the given ray to the packet (which must hold fewer than kMaxRayPacketSize rays)
+   *
+   * @param kRay constant reference to the ray to add
+   * @param max_t real representing the maximum t value for the intersections of the ray
+   */
+  inline void add(const ray& kRay, real max_t) {
+    const vec3 kInverseDirection = inverseDirection(kRay.direction());
+    rays_[size_] = kRay;
+    origin_x_[size_] = kRay.origin().x();
+    origin_y_[size_] = kRay.origin().y();
+    origin_z_[size_] = kRay.origin().z();
+    inverse_direction_x_[size_] = kInverseDirection.x();
+    inverse_direction_y_[size_] = kInverseDirection.y();
+    inverse_direction_z_[size_] = kInverseDirection.z();
+    max_t_[size_] = max_t;
+    was_hit_[size_] = false;
+    ++size_;
+  }
+};
+
 /**
  * Class representing a hittable object
  */
@@ -57,23 +145,114 @@ class Hittable {
     virtual ~Hittable() {}
 
     /**
-     * Virtual Function that returns true if the hittable object was hit by the given ray 
-     * in the given range of values for t
+     * Returns true if the hittable object was hit by the given ray in the given range of 
+     * values for t
      * 
      * Updates the hit record with the closest point of intersection, corresponding t value, 
      * and the unit surface normal, and whether the ray intersects the hit object from the inside
      * or the outside
      * 
-     * NOTE: If not overridden, always returns false
+     * Runs intersect to find the closest hit and then finalizes only that hit, so surface data 
+     * is never computed for hits that a nearer object later replaces
      * 
      * @param kRay constant reference to the ray to check if it hits the hittable object
-     * @param min_t double representing the minimum t value for the intersection
-     * @param max_t double representing the maximum t value for the intersection
+     * @param min_t real representing the minimum t value for the intersection
+     * @param max_t real representing the maximum t value for the intersection
      * @param hit_record reference to a hit record to update with the details of the intersection of the ray
      *     and the hit object (not updated if not hit within the acceptable t value range)
      * @return true if the hittable object was hit by the given ray in the given range of values for t 
      *     and false otherwise
      */
-    virtual bool wasHit(const ray& kRay, double min_t, double max_t, 
+    inline bool wasHit(const ray& kRay, real min_t, real max_t, HitRecord& hit_record) const {
+      if (!intersect(kRay, min_t, max_t, hit_record)) {
+        return false;
+      }
+      hit_record.hit_object_->finalizeHit(kRay, hit_record);
+      return true;
+    }
+
+    /**
+     * Virtual Function that returns true if the hittable object was hit by the given ray 
+     * in the given range of values for t
+     * 
+     * Only updates the t value, hit object, and material ID of the hit record, which is all that 
+     * is needed to find the closest hit and to group hits by material (see finalizeHit for the 
+     * rest of the hit record)
+     * 
+     * @param kRay constant reference to the ray to check if it hits the hittable object
+     * @param min_t real representing the minimum t value for the intersection
+     * @param max_t real representing the maximum t value for the intersection
+     * @param hit_record reference to a hit record to update with the t value of the closest 
+     *     intersection and the primitive object that was hit and its material (not updated if 
+     *     not hit within the acceptable t value range)
+     * @return true if the hittable object was hit by the given ray in the given range of values for t 
+     *     and false otherwise
+     */
+    virtual bool intersect(const ray& kRay, real min_t, real max_t, 
         HitRecord& hit_record) const = 0;
+
+    /**
+     * Virtual Function that returns true if anything in the hittable object is hit by the 
+     * given ray in the given range of values for t
+     * 
+     * Returns as soon as any hit is found, without looking for the closest one or filling in a 
+     * hit record, which is all that shadow and visibility rays need to know
+     * 
+     * NOTE: If not overridden, runs intersect (which finds the closest hit)
+     * 
+     * @param kRay constant reference to the ray to check if it hits the hittable object
+     * @param min_t real representing the minimum t value for the intersection
+     * @param max_t real representing the maximum t value for the intersection
+     * @return true if the hittable object was hit by the given ray anywhere in the given range 
+     *     of values for t and false otherwise
+     */
+    virtual bool isOccluded(const ray& kRay, real min_t, real max_t) const {
+      HitRecord hit_record = HitRecord();
+      return intersect(kRay, min_t, max_t, hit_record);
+    }
+
+    /**
+     * Virtual Function that finds the closest hit of every ray of the given packet in the given
+     * range of values for t (up to the max_t_ of each ray)
+     *
+     * Updates max_t_, hit_records_, and was_hit_ of every ray that hits the hittable object
+     * closer than its max_t_, like intersect does for a single ray (hits are not finalized)
+     *
+     * NOTE: If not overridden, runs intersect for every ray of the packet on its own
+     *
+     * @param packet reference to the packet of rays to check
+     * @param min_t real representing the minimum t value for the intersections
+     */
+    virtual void intersectPacket(RayPacket& packet, real min_t) const {
+      for (size_t i = 0; i < packet.size_; ++i) {
+        if (intersect(packet.rays_[i], min_t, packet.max_t_[i], packet.hit_records_[i])) {
+          packet.max_t_[i] = packet.hit_records_[i].t_;
+          packet.was_hit_[i] = true;
+        }
+      }
+    }
+
+    /**
+     * Virtual Function that fills in the point of intersection, surface normal, and front facing 
+     * flag of a hit record whose t value, hit object, and material were set by intersect
+     * 
+     * NOTE: If not overridden, does nothing (objects that contain other objects record the 
+     * primitive that was hit, so they are never asked to finalize a hit themselves)
+     * 
+     * @param kRay constant reference to the ray that hit the hittable object
+     * @param hit_record reference to the hit record to finalize
+     */
+    virtual void finalizeHit(const ray& kRay, HitRecord& hit_record) const {}
+
+    /**
+     * Virtual Function that computes the axis-aligned box bounding the hittable object over
+     * the given interval of time (so that moving objects can bound their whole motion)
+     * 
+     * @param time0 real representing the start of the time interval the box must cover
+     * @param time1 real representing the end of the time interval the box must cover
+     * @param output_box reference to an aabb to update with the bounding box of the hittable 
+     *     object (not updated if the object has no bounding box)
+     * @return true if the hittable object has a (finite) bounding box and false otherwise
+     */
+    virtual bool boundingBox(real time0, real time1, aabb& output_box) const = 0;
 };
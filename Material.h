@@ -19,8 +19,91 @@ class Material {
      */
     virtual bool scatter(const ray& kRay, const HitRecord& kHitRecord, 
         color& attenuation, ray& scattered_ray) const = 0;
+
+    /**
+     * Returns the name of the type of the material, for reports
+     * 
+     * NOTE: If not overridden, returns "Material"
+     * 
+     * @return a constant pointer to the name of the type of the material
+     */
+    virtual const char* typeName() const {
+      return "Material";
+    }
 };
 
+// The scatter functions of the built in materials, shared by their classes (virtual dispatch) 
+// and by material_table's closed set of materials (switch dispatch)
+
+/**
+ * Scatters the given ray off of a Lambertian (diffuse) surface with the given albedo
+ * 
+ * @param kAlbedo constant reference to a color representing the albedo of the surface
+ * @param kRay a constant reference to the ray to be scattered
+ * @param kHitRecord a constant reference to a HitRecord storing where the ray hit the surface
+ * @param attenuation a reference to a color to be updated with how much the given ray is attenuated
+ * @param scattered_ray a reference to a ray to be updated with the scattered ray
+ * @return a bool that is true if the ray was scattered and false if the ray was absorbed
+ */
+inline bool scatterLambertian(const color& kAlbedo, const ray& kRay, const HitRecord& kHitRecord, 
+    color& attenuation, ray& scattered_ray) {
+  vec3 scatter_direction = kHitRecord.surface_normal_ + randomUnitVector();
+  // guard against scatter direction that is close to 0
+  if (scatter_direction.nearZero()) {
+    scatter_direction = kHitRecord.surface_normal_;
+  }
+  scattered_ray = ray(kHitRecord.point_of_intersection_, scatter_direction);
+  attenuation = kAlbedo;
+  return true;
+}
+
+/**
+ * Scatters the given ray off of a metal surface with the given albedo and fuzziness
+ * 
+ * @param kAlbedo constant reference to a color representing the albedo of the surface
+ * @param fuzziness real representing how fuzzy the reflection is (at most 1)
+ * @param kRay a constant reference to the ray to be scattered
+ * @param kHitRecord a constant reference to a HitRecord storing where the ray hit the surface
+ * @param attenuation a reference to a color to be updated with how much the given ray is attenuated
+ * @param scattered_ray a reference to a ray to be updated with the scattered ray
+ * @return a bool that is true if the ray was scattered and false if the ray was absorbed
+ */
+inline bool scatterMetal(const color& kAlbedo, real fuzziness, const ray& kRay, 
+    const HitRecord& kHitRecord, color& attenuation, ray& scattered_ray) {
+  const vec3 kReflectedRay = reflect(unitVector(kRay.direction()), kHitRecord.surface_normal_);
+  scattered_ray = ray(kHitRecord.point_of_intersection_, kReflectedRay 
+      + randomPointInUnitSphere() * fuzziness);
+  attenuation = kAlbedo;
+  return (dot(scattered_ray.direction(), kHitRecord.surface_normal_) > 0);
+}
+
+/**
+ * Refracts the given ray through a dielectric surface with the given index of refraction
+ * 
+ * @param index_of_refraction real representing the index of refraction of the surface
+ * @param kRay a constant reference to the ray to be scattered
+ * @param kHitRecord a constant reference to a HitRecord storing where the ray hit the surface
+ * @param attenuation a reference to a color to be updated with how much the given ray is attenuated
+ * @param scattered_ray a reference to a ray to be updated with the scattered ray
+ * @return a bool that is true if the ray was scattered and false if the ray was absorbed
+ */
+inline bool scatterDielectric(real index_of_refraction, const ray& kRay, 
+    const HitRecord& kHitRecord, color& attenuation, ray& scattered_ray) {
+  attenuation = color(1.0, 1.0, 1.0);
+
+  real refraction_ratio;
+  if (kHitRecord.front_facing_) {
+    refraction_ratio = 1.0 / index_of_refraction;
+  } else {
+    refraction_ratio = index_of_refraction;
+  }
+
+  const vec3 kRefractedRay = refract(unitVector(kRay.direction()), kHitRecord.surface_normal_, 
+      refraction_ratio);
+  scattered_ray = ray(kHitRecord.point_of_intersection_, kRefractedRay);
+  return true;
+}
+
 /**
  * Class representing a Lambertian (diffuse) Material
  */
@@ -36,14 +119,21 @@ class Lambertian : public Material {
     // see Material class docs
     virtual bool scatter(const ray& kRay, const HitRecord& kHitRecord, 
         color& attenuation, ray& scattered_ray) const override {
-      vec3 scatter_direction = kHitRecord.surface_normal_ + randomUnitVector();
-      // guard against scatter direction that is close to 0
-      if (scatter_direction.nearZero()) {
-        scatter_direction = kHitRecord.surface_normal_;
-      }
-      scattered_ray = ray(kHitRecord.point_of_intersection_, scatter_direction);
-      attenuation = albedo_;
-      return true;
+      return scatterLambertian(albedo_, kRay, kHitRecord, attenuation, scattered_ray);
+    }
+
+    // see Material class docs
+    virtual const char* typeName() const override {
+      return "Lambertian";
+    }
+
+    /**
+     * Returns the albedo of the material
+     * 
+     * @return a color representing the albedo of the material
+     */
+    color albedo() const {
+      return albedo_;
     }
 
   private:
@@ -60,9 +150,9 @@ class Metal : public Material {
      * Constructor that sets the metal material's albedo to the given albedo
      * 
      * @param albedo constant reference to a color representing the metal material's albedo
-     * @param fuzziness double representing how fuzzy the metal's reflection is
+     * @param fuzziness real representing how fuzzy the metal's reflection is
      */ 
-    Metal(const color& kAlbedo, double fuzziness) : albedo_(kAlbedo) {
+    Metal(const color& kAlbedo, real fuzziness) : albedo_(kAlbedo) {
       if (fuzziness >= 1) {
         fuzziness_ = 1;
       } else {
@@ -73,18 +163,37 @@ class Metal : public Material {
     // see Material class docs
     virtual bool scatter(const ray& kRay, const HitRecord& kHitRecord, 
         color& attenuation, ray& scattered_ray) const override {
-      const vec3 kReflectedRay = reflect(unitVector(kRay.direction()), kHitRecord.surface_normal_);
-      scattered_ray = ray(kHitRecord.point_of_intersection_, kReflectedRay 
-          + randomPointInUnitSphere() * fuzziness_);
-      attenuation = albedo_;
-      return (dot(scattered_ray.direction(), kHitRecord.surface_normal_) > 0);
+      return scatterMetal(albedo_, fuzziness_, kRay, kHitRecord, attenuation, scattered_ray);
+    }
+
+    // see Material class docs
+    virtual const char* typeName() const override {
+      return "Metal";
+    }
+
+    /**
+     * Returns the albedo of the material
+     * 
+     * @return a color representing the albedo of the material
+     */
+    color albedo() const {
+      return albedo_;
+    }
+
+    /**
+     * Returns how fuzzy the reflection of the material is
+     * 
+     * @return a real representing the fuzziness of the material (between 0 and 1)
+     */
+    real fuzziness() const {
+      return fuzziness_;
     }
 
   private:
     // color that stores the Metal Material's albedo (ability to reflect sunlight)
     color albedo_;
-    // double storing how fuzzy the reflection is (1 is completely fuzzy, 0 is no fuzziness)
-    double fuzziness_;
+    // real storing how fuzzy the reflection is (1 is completely fuzzy, 0 is no fuzziness)
+    real fuzziness_;
 };
 
 /**
@@ -96,27 +205,29 @@ class Dielectric : public Material {
      * Constructor that sets the dielectric material's index of refraction to the given 
      * index of refraction
      * 
-     * @param index_of_refraction double representing the index of refraction of the 
+     * @param index_of_refraction real representing the index of refraction of the 
      *    dielectric material
      */ 
-    Dielectric(double index_of_refraction) : index_of_refraction_(index_of_refraction) {}
+    Dielectric(real index_of_refraction) : index_of_refraction_(index_of_refraction) {}
 
     // see Material class docs
     virtual bool scatter(const ray& kRay, const HitRecord& kHitRecord, 
         color& attenuation, ray& scattered_ray) const override {
-      attenuation = color(1.0, 1.0, 1.0);
+      return scatterDielectric(index_of_refraction_, kRay, kHitRecord, attenuation, scattered_ray);
+    }
 
-      double refraction_ratio;
-      if (kHitRecord.front_facing_) {
-        refraction_ratio = 1.0 / index_of_refraction_;
-      } else {
-        refraction_ratio = index_of_refraction_;
-      }
+    // see Material class docs
+    virtual const char* typeName() const override {
+      return "Dielectric";
+    }
 
-      const vec3 kRefractedRay = refract(unitVector(kRay.direction()), kHitRecord.surface_normal_, 
-          refraction_ratio);
-      scattered_ray = ray(kHitRecord.point_of_intersection_, kRefractedRay);
-      return true;
+    /**
+     * Returns the index of refraction of the material
+     * 
+     * @return a real representing the index of refraction of the material
+     */
+    real indexOfRefraction() const {
+      return index_of_refraction_;
     }
 
   private:
@@ -128,5 +239,5 @@ class Dielectric : public Material {
      *  1.3 - 1.7 ~ glass
      *  2.4 ~ diamond
      */
-    double index_of_refraction_;
+    real index_of_refraction_;
 };
@@ -0,0 +1,51 @@
+#include "aabb.h"
+
+aabb::aabb() : minimum_(point3(infinity, infinity, infinity)),
+    maximum_(point3(-infinity, -infinity, -infinity)) {}
+
+aabb::aabb(const point3& minimum, const point3& maximum) : minimum_(minimum),
+    maximum_(maximum) {}
+
+point3 aabb::minimum() const {
+  return minimum_;
+}
+
+point3 aabb::maximum() const {
+  return maximum_;
+}
+
+bool aabb::wasHit(const ray& kRay, real min_t, real max_t) const {
+  // clip [min_t, max_t] against the pair of planes (slab) bounding the box on each axis
+  return wasHit(kRay.origin(), inverseDirection(kRay.direction()), min_t, max_t);
+}
+
+real aabb::surfaceArea() const {
+  const vec3 kExtent = maximum_ - minimum_;
+  if (kExtent.x() < 0 || kExtent.y() < 0 || kExtent.z() < 0) {
+    return 0;
+  }
+  return 2 * ((kExtent.x() * kExtent.y()) + (kExtent.y() * kExtent.z())
+      + (kExtent.z() * kExtent.x()));
+}
+
+point3 aabb::centroid() const {
+  return (minimum_ + maximum_) * 0.5;
+}
+
+aabb surroundingBox(const aabb& kBoxOne, const aabb& kBoxTwo) {
+  const point3 kMinimum = point3(std::fmin(kBoxOne.minimum().x(), kBoxTwo.minimum().x()),
+      std::fmin(kBoxOne.minimum().y(), kBoxTwo.minimum().y()),
+      std::fmin(kBoxOne.minimum().z(), kBoxTwo.minimum().z()));
+  const point3 kMaximum = point3(std::fmax(kBoxOne.maximum().x(), kBoxTwo.maximum().x()),
+      std::fmax(kBoxOne.maximum().y(), kBoxTwo.maximum().y()),
+      std::fmax(kBoxOne.maximum().z(), kBoxTwo.maximum().z()));
+  return aabb(kMinimum, kMaximum);
+}
+
+aabb surroundingBox(const aabb& kBox, const point3& kPoint) {
+  return surroundingBox(kBox, aabb(kPoint, kPoint));
+}
+
+vec3 inverseDirection(const vec3& kDirection) {
+  return vec3(1.0 / kDirection.x(), 1.0 / kDirection.y(), 1.0 / kDirection.z());
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "constants_and_utilities.h"
+#include "ray.h"
+#include "vec3.h"
+
+/**
+ * Class representing an axis-aligned bounding box
+ */
+class aabb {
+  public:
+    /**
+     * Default Constructor
+     * Creates an empty box (minimum at +infinity and maximum at -infinity) so that
+     * surrounding it with any other box results in the other box
+     */
+    aabb();
+
+    /**
+     * Constructor that sets the corners of the box to the given corners
+     *
+     * @param minimum constant reference to a point3 representing the corner of the box
+     *     with the smallest x, y, and z values
+     * @param maximum constant reference to a point3 representing the corner of the box
+     *     with the largest x, y, and z values
+     */
+    aabb(const point3& minimum, const point3& maximum);
+
+    /**
+     * Returns the corner of the box with the smallest x, y, and z values
+     *
+     * @return a point3 representing the minimum corner of the box
+     */
+    point3 minimum() const;
+
+    /**
+     * Returns the corner of the box with the largest x, y, and z values
+     *
+     * @return a point3 representing the maximum corner of the box
+     */
+    point3 maximum() const;
+
+    /**
+     * Returns true if the given ray passes through the box in the given range of values for t
+     *
+     * @param kRay constant reference to the ray to check against the box
+     * @param min_t real representing the minimum t value for the intersection
+     * @param max_t real representing the maximum t value for the intersection
+     * @return true if the ray overlaps the box somewhere in [min_t, max_t] and false otherwise
+     */
+    bool wasHit(const ray& kRay, real min_t, real max_t) const;
+
+    /**
+     * Returns true if the ray with the given origin and inverse direction passes through
+     * the box in the given range of values for t
+     *
+     * Branch-free slab test meant for traversal loops, where the inverse direction is computed
+     * once per ray instead of once per box. The near and far planes of each slab are picked by
+     * the sign of the inverse direction rather than by comparing the two t values, so when a ray
+     * parallel to a slab starts exactly on one of its planes (0 * infinity, a NaN t value), that
+     * NaN lands on the comparisons below, which are ordered to ignore it
+     *
+     * @param kOrigin constant reference to a point3 representing the origin of the ray
+     * @param kInverseDirection constant reference to a vec3 storing 1 / direction for each
+     *     component of the ray's direction
+     * @param min_t real representing the minimum t value for the intersection
+     * @param max_t real representing the maximum t value for the intersection
+     * @return true if the ray overlaps the box somewhere in [min_t, max_t] and false otherwise
+     */
+    inline bool wasHit(const point3& kOrigin, const vec3& kInverseDirection, real min_t,
+        real max_t) const {
+      for (int axis = 0; axis < 3; ++axis) {
+        const real kT0 = (minimum_[axis] - kOrigin[axis]) * kInverseDirection[axis];
+        const real kT1 = (maximum_[axis] - kOrigin[axis]) * kInverseDirection[axis];
+        const bool kNegative = kInverseDirection[axis] < 0;
+        const real kNear = kNegative ? kT1 : kT0;
+        const real kFar = kNegative ? kT0 : kT1;
+        min_t = kNear > min_t ? kNear : min_t;
+        max_t = kFar < max_t ? kFar : max_t;
+      }
+      return min_t <= max_t;
+    }
+
+    /**
+     * Returns the surface area of the box (0 for an empty box)
+     *
+     * @return a real representing the surface area of the box
+     */
+    real surfaceArea() const;
+
+    /**
+     * Returns the center of the box
+     *
+     * @return a point3 representing the center of the box
+     */
+    point3 centroid() const;
+
+  private:
+    // point3 representing the corner of the box with the smallest x, y, and z values
+    point3 minimum_;
+    // point3 representing the corner of the box with the largest x, y, and z values
+    point3 maximum_;
+};
+
+/**
+ * Returns the smallest box that contains both of the given boxes
+ *
+ * @param kBoxOne constant reference to the first box to surround
+ * @param kBoxTwo constant reference to the second box to surround
+ * @return an aabb that contains both of the given boxes
+ */
+aabb surroundingBox(const aabb& kBoxOne, const aabb& kBoxTwo);
+
+/**
+ * Returns the smallest box that contains the given box and the given point
+ *
+ * @param kBox constant reference to the box to surround
+ * @param kPoint constant reference to the point to surround
+ * @return an aabb that contains both the given box and the given point
+ */
+aabb surroundingBox(const aabb& kBox, const point3& kPoint);
+
+/**
+ * Returns the component-wise inverse of the given direction, for use with the 
+ * aabb slab test
+ *
+ * @param kDirection constant reference to the vec3 direction to invert
+ * @return a vec3 storing 1 / component for each component of the given direction
+ */
+vec3 inverseDirection(const vec3& kDirection);
@@ -0,0 +1,125 @@
+#include <cmath>
+#include <stdexcept>
+
+#include "affine_transform.h"
+
+affine_transform::affine_transform() {
+  for (int row = 0; row < 3; ++row) {
+    for (int column = 0; column < 4; ++column) {
+      matrix_[row][column] = row == column ? 1 : 0;
+    }
+  }
+}
+
+affine_transform affine_transform::translation(const vec3& kOffset) {
+  affine_transform transform = affine_transform();
+  for (int row = 0; row < 3; ++row) {
+    transform.matrix_[row][3] = kOffset[row];
+  }
+  return transform;
+}
+
+affine_transform affine_transform::scaling(const vec3& kFactors) {
+  affine_transform transform = affine_transform();
+  for (int row = 0; row < 3; ++row) {
+    transform.matrix_[row][row] = kFactors[row];
+  }
+  return transform;
+}
+
+affine_transform affine_transform::rotation(const vec3& kAxis, real degrees) {
+  // Rodrigues' rotation formula: R = cI + s[u]x + (1 - c)uu^T
+  const vec3 kUnitAxis = unitVector(kAxis);
+  const real kRadians = static_cast<real>(degrees_to_radians(degrees));
+  const real kCos = std::cos(kRadians);
+  const real kSin = std::sin(kRadians);
+  const real kCrossProductMatrix[3][3] = {
+      {0, -kUnitAxis.z(), kUnitAxis.y()},
+      {kUnitAxis.z(), 0, -kUnitAxis.x()},
+      {-kUnitAxis.y(), kUnitAxis.x(), 0}};
+  affine_transform transform = affine_transform();
+  for (int row = 0; row < 3; ++row) {
+    for (int column = 0; column < 3; ++column) {
+      transform.matrix_[row][column] = (row == column ? kCos : 0)
+          + (kSin * kCrossProductMatrix[row][column])
+          + ((1 - kCos) * kUnitAxis[row] * kUnitAxis[column]);
+    }
+  }
+  return transform;
+}
+
+affine_transform affine_transform::operator*(const affine_transform& kFirst) const {
+  affine_transform product = affine_transform();
+  for (int row = 0; row < 3; ++row) {
+    for (int column = 0; column < 4; ++column) {
+      // the implicit fourth row of both matrices is (0, 0, 0, 1)
+      real value = column == 3 ? matrix_[row][3] : 0;
+      for (int k = 0; k < 3; ++k) {
+        value += matrix_[row][k] * kFirst.matrix_[k][column];
+      }
+      product.matrix_[row][column] = value;
+    }
+  }
+  return product;
+}
+
+affine_transform affine_transform::inverse() const {
+  const real (&a)[3][4] = matrix_;
+  const real kDeterminant = (a[0][0] * ((a[1][1] * a[2][2]) - (a[1][2] * a[2][1])))
+      - (a[0][1] * ((a[1][0] * a[2][2]) - (a[1][2] * a[2][0])))
+      + (a[0][2] * ((a[1][0] * a[2][1]) - (a[1][1] * a[2][0])));
+  if (kDeterminant == 0) {
+    throw std::invalid_argument("affine_transform: a singular transform has no inverse");
+  }
+
+  // the inverse of A is its adjugate over its determinant, and the inverse translation is
+  // -(A^-1)b
+  affine_transform inverse_transform = affine_transform();
+  real (&inverse)[3][4] = inverse_transform.matrix_;
+  for (int row = 0; row < 3; ++row) {
+    for (int column = 0; column < 3; ++column) {
+      // cofactor of a[column][row], from the rows and columns after it (cyclically)
+      const int kRow1 = (column + 1) % 3;
+      const int kRow2 = (column + 2) % 3;
+      const int kColumn1 = (row + 1) % 3;
+      const int kColumn2 = (row + 2) % 3;
+      inverse[row][column] = ((a[kRow1][kColumn1] * a[kRow2][kColumn2])
+          - (a[kRow1][kColumn2] * a[kRow2][kColumn1])) / kDeterminant;
+    }
+  }
+  for (int row = 0; row < 3; ++row) {
+    inverse[row][3] = -((inverse[row][0] * a[0][3]) + (inverse[row][1] * a[1][3])
+        + (inverse[row][2] * a[2][3]));
+  }
+  return inverse_transform;
+}
+
+point3 affine_transform::transformPoint(const point3& kPoint) const {
+  return transformVector(kPoint) + point3(matrix_[0][3], matrix_[1][3], matrix_[2][3]);
+}
+
+vec3 affine_transform::transformVector(const vec3& kVector) const {
+  return vec3(
+      (matrix_[0][0] * kVector.x()) + (matrix_[0][1] * kVector.y()) + (matrix_[0][2] * kVector.z()),
+      (matrix_[1][0] * kVector.x()) + (matrix_[1][1] * kVector.y()) + (matrix_[1][2] * kVector.z()),
+      (matrix_[2][0] * kVector.x()) + (matrix_[2][1] * kVector.y()) + (matrix_[2][2] * kVector.z()));
+}
+
+vec3 affine_transform::transposeTransformVector(const vec3& kVector) const {
+  return vec3(
+      (matrix_[0][0] * kVector.x()) + (matrix_[1][0] * kVector.y()) + (matrix_[2][0] * kVector.z()),
+      (matrix_[0][1] * kVector.x()) + (matrix_[1][1] * kVector.y()) + (matrix_[2][1] * kVector.z()),
+      (matrix_[0][2] * kVector.x()) + (matrix_[1][2] * kVector.y()) + (matrix_[2][2] * kVector.z()));
+}
+
+aabb affine_transform::transformBox(const aabb& kBox) const {
+  aabb box = aabb();
+  for (int corner = 0; corner < 8; ++corner) {
+    const point3 kCorner = point3(
+        (corner & 1) ? kBox.maximum().x() : kBox.minimum().x(),
+        (corner & 2) ? kBox.maximum().y() : kBox.minimum().y(),
+        (corner & 4) ? kBox.maximum().z() : kBox.minimum().z());
+    box = surroundingBox(box, transformPoint(kCorner));
+  }
+  return box;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "aabb.h"
+#include "constants_and_utilities.h"
+#include "vec3.h"
+
+/**
+ * Class representing an affine transform (a linear map followed by a translation) of 3D space
+ *
+ * Stored as the 3x4 matrix [A | b] that maps a point p to Ap + b and a vector v to Av
+ */
+class affine_transform {
+  public:
+    /**
+     * Default Constructor (makes the identity transform)
+     */
+    affine_transform();
+
+    /**
+     * Returns the transform that moves every point by the given offset
+     *
+     * @param kOffset constant reference to a vec3 representing the offset to move points by
+     * @return the translation by kOffset
+     */
+    static affine_transform translation(const vec3& kOffset);
+
+    /**
+     * Returns the transform that scales every point away from the origin by the given factors
+     *
+     * @param kFactors constant reference to a vec3 storing the factors to scale x, y, and z by
+     * @return the scaling by kFactors
+     */
+    static affine_transform scaling(const vec3& kFactors);
+
+    /**
+     * Returns the transform that rotates every point about the given axis through the origin
+     *
+     * @param kAxis constant reference to a vec3 representing the axis to rotate about (does not
+     *     have to be a unit vector)
+     * @param degrees real representing the counterclockwise angle to rotate by, looking down the
+     *     axis towards the origin
+     * @return the rotation by degrees about kAxis
+     */
+    static affine_transform rotation(const vec3& kAxis, real degrees);
+
+    /**
+     * Returns the transform that applies the given transform and then this one
+     *
+     * @param kFirst constant reference to the transform to apply first
+     * @return the composition of this transform with kFirst
+     */
+    affine_transform operator*(const affine_transform& kFirst) const;
+
+    /**
+     * Returns the inverse of this transform
+     *
+     * @return the transform that undoes this one
+     * @throws std::invalid_argument if the transform is singular (flattens space)
+     */
+    affine_transform inverse() const;
+
+    /**
+     * Applies the transform to the given point
+     *
+     * @param kPoint constant reference to the point to transform
+     * @return a point3 representing Ap + b
+     */
+    point3 transformPoint(const point3& kPoint) const;
+
+    /**
+     * Applies the linear part of the transform to the given vector
+     *
+     * @param kVector constant reference to the vector to transform
+     * @return a vec3 representing Av
+     */
+    vec3 transformVector(const vec3& kVector) const;
+
+    /**
+     * Applies the transpose of the linear part of the transform to the given vector, which is
+     * how the inverse of a transform carries surface normals
+     *
+     * @param kVector constant reference to the vector to transform
+     * @return a vec3 representing (A^T)v
+     */
+    vec3 transposeTransformVector(const vec3& kVector) const;
+
+    /**
+     * Returns the axis-aligned box bounding the given box after the transform
+     *
+     * @param kBox constant reference to the box to transform
+     * @return an aabb bounding all 8 transformed corners of kBox
+     */
+    aabb transformBox(const aabb& kBox) const;
+
+  private:
+    // rows of the 3x4 matrix [A | b]
+    real matrix_[3][4];
+};
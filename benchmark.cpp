@@ -0,0 +1,1002 @@
+#include <algorithm>
+#include <cstdio>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "benchmark.h"
+#include "bvh.h"
+#include "compressed_bvh.h"
+#include "Hittable.h"
+#include "instance.h"
+#include "mapped_bvh.h"
+#include "Material.h"
+#include "renderer.h"
+#include "scenes.h"
+#include "sphere.h"
+#include "sphere_set.h"
+#include "wide_bvh.h"
+
+double secondsSince(const std::chrono::steady_clock::time_point& kStart) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - kStart).count();
+}
+
+/**
+ * Times the given number of calls of scatter on the given material, scattering the given
+ * rays off of the given hits, and adds the time per call to the given stream
+ *
+ * @param kName constant reference to the name of the material to report
+ * @param kMaterial constant reference to the material to scatter off of
+ * @param kRays constant reference to the rays to scatter
+ * @param kHitRecords constant reference to where each of the rays hit
+ * @param num_calls the number of calls to time
+ * @param stream reference to a stream to add the result to
+ */
+void benchmarkScatter(const std::string& kName, const Material& kMaterial,
+    const std::vector<ray>& kRays, const std::vector<HitRecord>& kHitRecords,
+    size_t num_calls, std::ostream& stream) {
+  ray scattered_ray;
+  color attenuation;
+  double checksum = 0;
+  const std::chrono::steady_clock::time_point kStart = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_calls; ++i) {
+    const size_t kIndex = i % kRays.size();
+    if (kMaterial.scatter(kRays[kIndex], kHitRecords[kIndex], attenuation, scattered_ray)) {
+      checksum += scattered_ray.direction().x();
+    }
+  }
+  const double kSeconds = secondsSince(kStart);
+  stream << "  " << kName << "::scatter: " << (kSeconds * 1e9 / num_calls) << " ns/call"
+      << " (checksum " << checksum << ")\n";
+}
+
+void benchmarkVec3(std::ostream& stream) {
+  const size_t kNumRays = 1 << 16;
+  const size_t kNumCalls = 1 << 23;
+  setRandomStream(0, 0, 0);
+
+  const Lambertian kLambertian = Lambertian(color(0.7, 0.3, 0.3));
+  const sphere kSphere = sphere(point3(0.0, 0.0, -1.0), 0.5, 0);
+
+  // rays from around the origin toward the sphere, roughly half of which hit it
+  std::vector<ray> rays;
+  for (size_t i = 0; i < kNumRays; ++i) {
+    rays.push_back(ray(randomVector(-0.1, 0.1), point3(0.0, 0.0, -1.0) + randomVector(-0.7, 0.7)));
+  }
+
+  stream << "vec3 backend: " << kVec3BackendName << " (sizeof(vec3) = " << sizeof(vec3) << ")\n";
+
+  HitRecord hit_record = HitRecord();
+  size_t num_hits = 0;
+  const std::chrono::steady_clock::time_point kStart = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kNumCalls; ++i) {
+    if (kSphere.wasHit(rays[i % kNumRays], 0.001, infinity, hit_record)) {
+      ++num_hits;
+    }
+  }
+  const double kSeconds = secondsSince(kStart);
+  stream << "  sphere::wasHit: " << (kSeconds * 1e9 / kNumCalls) << " ns/call (" << num_hits
+      << " hits)\n";
+
+  // scatter every ray that hits the sphere off of its hit
+  std::vector<ray> hit_rays;
+  std::vector<HitRecord> hit_records;
+  for (const ray& kRay : rays) {
+    if (kSphere.wasHit(kRay, 0.001, infinity, hit_record)) {
+      hit_rays.push_back(kRay);
+      hit_records.push_back(hit_record);
+    }
+  }
+  benchmarkScatter("Lambertian", kLambertian, hit_rays, hit_records, kNumCalls, stream);
+  benchmarkScatter("Metal", Metal(color(0.8, 0.6, 0.2), 0.3), hit_rays, hit_records, kNumCalls,
+      stream);
+  benchmarkScatter("Dielectric", Dielectric(1.5), hit_rays, hit_records, kNumCalls, stream);
+}
+
+/**
+ * Returns the average of every channel of every pixel of the given framebuffer
+ *
+ * @param kFramebuffer constant reference to the framebuffer returned by renderImage
+ * @param kSettings constant reference to the settings the framebuffer was rendered with
+ * @return a double representing the mean brightness of the image (before gamma correction)
+ */
+double meanPixelValue(const std::vector<color>& kFramebuffer, const RenderSettings& kSettings) {
+  double sum = 0;
+  for (const color& kPixelColor : kFramebuffer) {
+    sum += kPixelColor.x() + kPixelColor.y() + kPixelColor.z();
+  }
+  return sum / (3.0 * kFramebuffer.size() * kSettings.samples_per_pixel_);
+}
+
+/**
+ * Renders the given scene with the given settings and adds the render time, average path 
+ * length, and mean pixel value to the given stream
+ *
+ * @param kLabel constant reference to the label of the render to report
+ * @param kObjects constant reference to the hittable objects to render
+ * @param kMaterials constant reference to the table of the materials of the objects
+ * @param kSettings constant reference to the settings to render with
+ * @param stream reference to a stream to add the result to
+ */
+void benchmarkPathLength(const std::string& kLabel, const Hittable& kObjects, 
+    const material_table& kMaterials, const RenderSettings& kSettings, std::ostream& stream) {
+  RenderStatistics statistics = RenderStatistics();
+  const std::chrono::steady_clock::time_point kStart = std::chrono::steady_clock::now();
+  const std::vector<color> kFramebuffer = renderImage(camera(), kObjects, kMaterials, kSettings, 
+      statistics);
+  const double kSeconds = secondsSince(kStart);
+  // the renderer reports its progress on the same line of the terminal, so start a new one
+  stream << "\n  " << kLabel << ": " << kSeconds << " s, average path length " 
+      << statistics.averagePathLength() << " bounces, mean pixel value " 
+      << meanPixelValue(kFramebuffer, kSettings) << "\n";
+}
+
+void benchmarkRussianRoulette(std::ostream& stream) {
+  hittable_list world = hittable_list();
+  material_table materials = material_table();
+  addGlassSpheresScene(world, materials);
+  const bvh kWorldHierarchy = bvh(world);
+
+  RenderSettings settings = RenderSettings();
+  settings.image_width_ = 200;
+  settings.image_height_ = 112;
+  settings.samples_per_pixel_ = 32;
+  settings.max_ray_bounces_ = 50;
+  settings.tile_size_ = 16;
+  settings.num_threads_ = 0;
+
+  stream << "glassSpheres, " << settings.image_width_ << "x" << settings.image_height_ << ", "
+      << settings.samples_per_pixel_ << " samples per pixel, at most " 
+      << settings.max_ray_bounces_ << " bounces\n";
+  settings.use_russian_roulette_ = false;
+  benchmarkPathLength("no Russian roulette", kWorldHierarchy, materials, settings, stream);
+  settings.use_russian_roulette_ = true;
+  for (size_t min_bounces : {0, 3, 5, 10}) {
+    settings.russian_roulette_min_bounces_ = min_bounces;
+    benchmarkPathLength("Russian roulette after " + std::to_string(min_bounces) + " bounces", 
+        kWorldHierarchy, materials, settings, stream);
+  }
+}
+
+/**
+ * Returns true if the two given framebuffers store exactly the same colors
+ *
+ * @param kFirst constant reference to the first framebuffer to compare
+ * @param kSecond constant reference to the second framebuffer to compare
+ * @return true if every channel of every pixel is equal and false otherwise
+ */
+bool sameFramebuffers(const std::vector<color>& kFirst, const std::vector<color>& kSecond) {
+  if (kFirst.size() != kSecond.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < kFirst.size(); ++i) {
+    if (kFirst[i].x() != kSecond[i].x() || kFirst[i].y() != kSecond[i].y() 
+        || kFirst[i].z() != kSecond[i].z()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Renders the given scene one path at a time and then as wavefronts, and adds the render 
+ * time and bounce throughput of both modes, and whether they rendered the same image, to 
+ * the given stream
+ *
+ * @param kSceneName constant reference to the name of the scene to report
+ * @param kObjects constant reference to the hittable objects to render
+ * @param kMaterials constant reference to the table of the materials of the objects
+ * @param settings the settings to render with (use_wavefront_ is overwritten)
+ * @param stream reference to a stream to add the results to
+ */
+void benchmarkWavefrontScene(const std::string& kSceneName, const Hittable& kObjects, 
+    const material_table& kMaterials, RenderSettings settings, std::ostream& stream) {
+  std::vector<color> framebuffers[2];
+  for (int mode = 0; mode < 2; ++mode) {
+    settings.use_wavefront_ = mode == 1;
+    RenderStatistics statistics = RenderStatistics();
+    const std::chrono::steady_clock::time_point kStart = std::chrono::steady_clock::now();
+    framebuffers[mode] = renderImage(camera(), kObjects, kMaterials, settings, statistics);
+    const double kSeconds = secondsSince(kStart);
+    // the renderer reports its progress on the same line of the terminal, so start a new one
+    stream << "\n  " << kSceneName << (settings.use_wavefront_ ? ", wavefront: " : ", one path at a time: ")
+        << kSeconds << " s, " << (statistics.num_bounces_ / kSeconds / 1e6) << " M bounces/s\n";
+  }
+  stream << "  same image: " << (sameFramebuffers(framebuffers[0], framebuffers[1]) ? "yes" : "no") << "\n";
+}
+
+void benchmarkWavefront(std::ostream& stream) {
+  RenderSettings settings = RenderSettings();
+  settings.image_width_ = 400;
+  settings.image_height_ = 225;
+  settings.samples_per_pixel_ = 16;
+  settings.max_ray_bounces_ = 50;
+  settings.tile_size_ = 16;
+  settings.num_threads_ = 0;
+
+  hittable_list metal_world = hittable_list();
+  material_table metal_materials = material_table();
+  addMetalSpheresScene(metal_world, metal_materials);
+  benchmarkWavefrontScene("metalSpheres", bvh(metal_world), metal_materials, settings, stream);
+
+  hittable_list glass_world = hittable_list();
+  material_table glass_materials = material_table();
+  addGlassSpheresScene(glass_world, glass_materials);
+  benchmarkWavefrontScene("glassSpheres", bvh(glass_world), glass_materials, settings, stream);
+}
+
+void benchmarkMaterialSort(std::ostream& stream) {
+  RenderSettings settings = RenderSettings();
+  settings.image_width_ = 400;
+  settings.image_height_ = 225;
+  settings.samples_per_pixel_ = 16;
+  settings.max_ray_bounces_ = 50;
+  settings.tile_size_ = 16;
+  settings.num_threads_ = 0;
+  settings.use_wavefront_ = true;
+
+  hittable_list world = hittable_list();
+  material_table materials = material_table();
+  addMetalSpheresScene(world, materials);
+  const bvh kWorldHierarchy = bvh(world);
+
+  for (int sort = 0; sort < 2; ++sort) {
+    settings.sort_by_material_ = sort == 1;
+    RenderStatistics statistics = RenderStatistics();
+    const std::chrono::steady_clock::time_point kStart = std::chrono::steady_clock::now();
+    renderImage(camera(), kWorldHierarchy, materials, settings, statistics);
+    const double kSeconds = secondsSince(kStart);
+    // the renderer reports its progress on the same line of the terminal, so start a new one
+    stream << "\n  metalSpheres, wavefront, " << (settings.sort_by_material_ ? "sorted" : "unsorted")
+        << " hits: " << kSeconds << " s, " << (statistics.num_bounces_ / kSeconds / 1e6) 
+        << " M bounces/s\n";
+    for (uint32_t material_id : materials.materialsByType()) {
+      stream << "    " << materials.get(material_id).typeName() << " #" << material_id << ": "
+          << statistics.material_shade_counts_[material_id] << " hits";
+      if (settings.sort_by_material_) {
+        // summed over every thread, so this is the throughput of a single thread
+        stream << ", " << (statistics.material_shade_counts_[material_id] 
+            / statistics.material_shade_seconds_[material_id] / 1e6) << " M hits/s per thread";
+      }
+      stream << "\n";
+    }
+  }
+}
+
+void benchmarkMaterialDispatch(std::ostream& stream) {
+  RenderSettings settings = RenderSettings();
+  settings.image_width_ = 400;
+  settings.image_height_ = 225;
+  settings.samples_per_pixel_ = 32;
+  settings.max_ray_bounces_ = 50;
+  settings.tile_size_ = 16;
+  settings.num_threads_ = 0;
+
+  hittable_list world = hittable_list();
+  material_table materials = material_table();
+  addMetalSpheresScene(world, materials);
+  const bvh kWorldHierarchy = bvh(world);
+
+  std::vector<color> framebuffers[2];
+  for (int dispatch = 0; dispatch < 2; ++dispatch) {
+    settings.use_virtual_materials_ = dispatch == 0;
+    RenderStatistics statistics = RenderStatistics();
+    const std::chrono::steady_clock::time_point kStart = std::chrono::steady_clock::now();
+    framebuffers[dispatch] = renderImage(camera(), kWorldHierarchy, materials, settings, statistics);
+    const double kSeconds = secondsSince(kStart);
+    // the renderer reports its progress on the same line of the terminal, so start a new one
+    stream << "\n  metalSpheres, " << (settings.use_virtual_materials_ ? "virtual" : "switch")
+        << " dispatch: " << kSeconds << " s, " << (statistics.num_bounces_ / kSeconds / 1e6) 
+        << " M bounces/s\n";
+  }
+  stream << "  same image: " << (sameFramebuffers(framebuffers[0], framebuffers[1]) ? "yes" : "no")
+      << "\n";
+}
+
+/**
+ * Times the given number of closest hit queries of the given rays against the given objects, 
+ * and adds the time per query to the given stream
+ *
+ * @param kName constant reference to the name of the objects to report
+ * @param kObjects constant reference to the objects to intersect
+ * @param kRays constant reference to the rays to intersect the objects with
+ * @param num_queries the number of queries to time
+ * @param stream reference to a stream to add the result to
+ */
+void benchmarkIntersect(const std::string& kName, const Hittable& kObjects, 
+    const std::vector<ray>& kRays, size_t num_queries, std::ostream& stream) {
+  HitRecord hit_record = HitRecord();
+  size_t num_hits = 0;
+  const std::chrono::steady_clock::time_point kStart = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_queries; ++i) {
+    if (kObjects.intersect(kRays[i % kRays.size()], 0.001, infinity, hit_record)) {
+      ++num_hits;
+    }
+  }
+  const double kSeconds = secondsSince(kStart);
+  stream << "    " << kName << ": " << (kSeconds * 1e9 / num_queries) << " ns/ray (" << num_hits 
+      << " hits)\n";
+}
+
+void benchmarkSphereSet(std::ostream& stream) {
+  const size_t kNumRays = 1 << 12;
+  const size_t kNumSphereTests = 1 << 25;
+  setRandomStream(0, 0, 0);
+
+  stream << "sphere_set width " << kSphereSetWidth << ", " << kRealLaneCount 
+      << " reals per register\n";
+  for (size_t num_spheres : {4, 16, 64, 256}) {
+    // spheres scattered through a cube, and rays from around its center
+    hittable_list list = hittable_list();
+    sphere_set set = sphere_set();
+    for (size_t i = 0; i < num_spheres; ++i) {
+      const point3 kCenter = randomVector(-4, 4);
+      const real kRadius = randomDouble(0.2, 0.8);
+      list.add(std::make_shared<sphere>(kCenter, kRadius, 0));
+      set.add(kCenter, kRadius, 0);
+    }
+    std::vector<ray> rays;
+    for (size_t i = 0; i < kNumRays; ++i) {
+      rays.push_back(ray(randomVector(-1, 1), randomUnitVector()));
+    }
+
+    // both must find the same closest hits
+    size_t num_mismatches = 0;
+    for (const ray& kRay : rays) {
+      HitRecord list_hit = HitRecord();
+      HitRecord set_hit = HitRecord();
+      const bool kListHit = list.wasHit(kRay, 0.001, infinity, list_hit);
+      const bool kSetHit = set.wasHit(kRay, 0.001, infinity, set_hit);
+      if (kListHit != kSetHit || (kListHit && (list_hit.t_ != set_hit.t_ 
+          || list_hit.surface_normal_.x() != set_hit.surface_normal_.x()))) {
+        ++num_mismatches;
+      }
+    }
+
+    stream << "  " << num_spheres << " spheres (" << num_mismatches << " mismatched hits):\n";
+    benchmarkIntersect("hittable_list", list, rays, kNumSphereTests / num_spheres, stream);
+    benchmarkIntersect("sphere_set", set, rays, kNumSphereTests / num_spheres, stream);
+  }
+}
+
+void benchmarkWideBvh(std::ostream& stream) {
+  const size_t kNumRays = 1 << 14;
+  const size_t kNumQueries = 1 << 21;
+  setRandomStream(0, 0, 0);
+
+  stream << "wide_bvh width " << kBvhWidth << ", " << kRealLaneCount << " reals per register\n";
+  for (size_t num_spheres : {1 << 10, 1 << 14, 1 << 17}) {
+    // spheres scattered through a cube that grows with their number, and rays from inside it
+    const real kHalfSize = std::cbrt(static_cast<real>(num_spheres));
+    hittable_list list = hittable_list();
+    for (size_t i = 0; i < num_spheres; ++i) {
+      list.add(std::make_shared<sphere>(randomVector(-kHalfSize, kHalfSize), 
+          randomDouble(0.1, 0.4), 0));
+    }
+    const bvh kBinaryHierarchy = bvh(list);
+    const wide_bvh kWideHierarchy = wide_bvh(kBinaryHierarchy);
+    std::vector<ray> rays;
+    for (size_t i = 0; i < kNumRays; ++i) {
+      rays.push_back(ray(randomVector(-kHalfSize, kHalfSize), randomUnitVector()));
+    }
+
+    // both must find the same closest hits
+    size_t num_mismatches = 0;
+    for (const ray& kRay : rays) {
+      HitRecord binary_hit = HitRecord();
+      HitRecord wide_hit = HitRecord();
+      const bool kBinaryHit = kBinaryHierarchy.wasHit(kRay, 0.001, infinity, binary_hit);
+      const bool kWideHit = kWideHierarchy.wasHit(kRay, 0.001, infinity, wide_hit);
+      if (kBinaryHit != kWideHit || (kBinaryHit && (binary_hit.t_ != wide_hit.t_ 
+          || binary_hit.hit_object_ != wide_hit.hit_object_))) {
+        ++num_mismatches;
+      }
+    }
+
+    stream << "  " << num_spheres << " spheres (" << num_mismatches << " mismatched hits):\n";
+    stream << "    bvh: " << kBinaryHierarchy.nodeCount() << " nodes\n";
+    benchmarkIntersect("bvh", kBinaryHierarchy, rays, kNumQueries, stream);
+    stream << "    wide_bvh: " << kWideHierarchy.nodeCount() << " nodes\n";
+    benchmarkIntersect("wide_bvh", kWideHierarchy, rays, kNumQueries, stream);
+  }
+}
+
+void benchmarkBvhBuild(std::ostream& stream) {
+  const size_t kNumRays = 1 << 14;
+  const size_t kNumQueries = 1 << 20;
+  // the sweep builder sorts every range three times, so it only builds the smaller scenes
+  const size_t kMaxSweepSpheres = 1 << 17;
+  setRandomStream(0, 0, 0);
+
+  // one thread, then doubling up to one thread per hardware thread
+  std::vector<size_t> thread_counts;
+  const size_t kHardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  for (size_t num_threads = 1; num_threads < kHardwareThreads; num_threads *= 2) {
+    thread_counts.push_back(num_threads);
+  }
+  thread_counts.push_back(kHardwareThreads);
+
+  const std::vector<std::pair<std::string, BvhBuildSettings>> kBuilds = {
+      {"sweep SAH", BvhBuildSettings{BvhBuilder::kSweepSah, 0, false}},
+      {"binned SAH", BvhBuildSettings{BvhBuilder::kBinnedSah, 0, false}},
+      {"linear (30-bit)", BvhBuildSettings{BvhBuilder::kLinear, 30, false}},
+      {"linear (63-bit)", BvhBuildSettings{BvhBuilder::kLinear, 63, false}},
+      {"linear (63-bit) + treelets", BvhBuildSettings{BvhBuilder::kLinear, 63, true}}};
+
+  for (size_t num_spheres : {1 << 14, 1 << 17, 1 << 20}) {
+    const real kHalfSize = std::cbrt(static_cast<real>(num_spheres));
+    hittable_list list = hittable_list();
+    for (size_t i = 0; i < num_spheres; ++i) {
+      list.add(std::make_shared<sphere>(randomVector(-kHalfSize, kHalfSize), 
+          randomDouble(0.1, 0.4), 0));
+    }
+    std::vector<ray> rays;
+    for (size_t i = 0; i < kNumRays; ++i) {
+      rays.push_back(ray(randomVector(-kHalfSize, kHalfSize), randomUnitVector()));
+    }
+
+    stream << "  " << num_spheres << " spheres:\n";
+    for (size_t num_threads : thread_counts) {
+      for (const std::pair<std::string, BvhBuildSettings>& kBuild : kBuilds) {
+        const std::string& kName = kBuild.first;
+        const BvhBuildSettings& kBuildSettings = kBuild.second;
+        if (kBuildSettings.builder_ == BvhBuilder::kSweepSah 
+            && (num_threads > 1 || num_spheres > kMaxSweepSpheres)) {
+          continue;
+        }
+        thread_pool pool(num_threads);
+        const std::chrono::steady_clock::time_point kStart = std::chrono::steady_clock::now();
+        const bvh kHierarchy = bvh(list, kBuildSettings, pool);
+        const double kSeconds = secondsSince(kStart);
+        stream << "    " << kName << ", " << num_threads 
+            << (num_threads == 1 ? " thread: " : " threads: ") << kSeconds 
+            << " s build, SAH cost " << kHierarchy.sahCost() << ", " << kHierarchy.nodeCount() 
+            << " nodes\n";
+        benchmarkIntersect("  " + kName, kHierarchy, rays, kNumQueries, stream);
+      }
+    }
+  }
+}
+
+void benchmarkBvhRefit(std::ostream& stream) {
+  const size_t kNumSpheres = 1 << 18;
+  const size_t kNumFrames = 12;
+  const double kMaxSahCostGrowth = 1.25;
+  setRandomStream(0, 0, 0);
+
+  const real kHalfSize = std::cbrt(static_cast<real>(kNumSpheres));
+  hittable_list list = hittable_list();
+  std::vector<std::shared_ptr<sphere>> spheres;
+  std::vector<vec3> velocities;
+  for (size_t i = 0; i < kNumSpheres; ++i) {
+    spheres.push_back(std::make_shared<sphere>(randomVector(-kHalfSize, kHalfSize),
+        randomDouble(0.1, 0.4), 0));
+    velocities.push_back(randomUnitVector() * 0.25);
+    list.add(spheres.back());
+  }
+
+  thread_pool pool(0);
+  const BvhBuildSettings kBuildSettings = BvhBuildSettings{BvhBuilder::kBinnedSah, 63, false};
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  bvh hierarchy = bvh(list, kBuildSettings, pool);
+  stream << "  " << kNumSpheres << " spheres, binned SAH build: " << secondsSince(start) 
+      << " s, SAH cost " << hierarchy.sahCost() << "\n";
+  for (size_t frame = 1; frame <= kNumFrames; ++frame) {
+    for (size_t i = 0; i < kNumSpheres; ++i) {
+      spheres[i]->setCenter(spheres[i]->center() + velocities[i]);
+    }
+    start = std::chrono::steady_clock::now();
+    const bool kRebuilt = hierarchy.refitOrRebuild(kMaxSahCostGrowth, pool);
+    const double kSeconds = secondsSince(start);
+    stream << "    frame " << frame << ": " << kSeconds << " s, SAH cost growth " 
+        << hierarchy.sahCostGrowth() << (kRebuilt ? " (rebuilt)" : " (refit)") << "\n";
+  }
+}
+
+void benchmarkCompressedBvh(std::ostream& stream) {
+  const size_t kNumRays = 1 << 14;
+  const size_t kNumQueries = 1 << 20;
+  setRandomStream(0, 0, 0);
+  thread_pool pool(0);
+  const BvhBuildSettings kBuildSettings = BvhBuildSettings{BvhBuilder::kBinnedSah, 63, false};
+
+  stream << "bvh nodes: " << sizeof(BvhNode) << " bytes, compressed_bvh nodes: " 
+      << sizeof(CompressedBvhNode) << " bytes\n";
+  for (size_t num_spheres : {1 << 14, 1 << 17, 1 << 20}) {
+    // spheres scattered through a cube that grows with their number, and rays from inside it
+    const real kHalfSize = std::cbrt(static_cast<real>(num_spheres));
+    hittable_list list = hittable_list();
+    for (size_t i = 0; i < num_spheres; ++i) {
+      list.add(std::make_shared<sphere>(randomVector(-kHalfSize, kHalfSize), 
+          randomDouble(0.1, 0.4), 0));
+    }
+    const bvh kHierarchy = bvh(list, kBuildSettings, pool);
+    const compressed_bvh kCompressedHierarchy = compressed_bvh(kHierarchy);
+    std::vector<ray> rays;
+    for (size_t i = 0; i < kNumRays; ++i) {
+      rays.push_back(ray(randomVector(-kHalfSize, kHalfSize), randomUnitVector()));
+    }
+
+    // both must find the same closest hits
+    size_t num_mismatches = 0;
+    for (const ray& kRay : rays) {
+      HitRecord hit = HitRecord();
+      HitRecord compressed_hit = HitRecord();
+      const bool kHit = kHierarchy.wasHit(kRay, 0.001, infinity, hit);
+      const bool kCompressedHit = 
+          kCompressedHierarchy.wasHit(kRay, 0.001, infinity, compressed_hit);
+      if (kHit != kCompressedHit || (kHit && hit.t_ != compressed_hit.t_)) {
+        ++num_mismatches;
+      }
+    }
+
+    stream << "  " << num_spheres << " spheres (" << num_spheres * sizeof(sphere) / 1024 
+        << " KiB, " << num_mismatches << " mismatched hits):\n";
+    stream << "    bvh: " << kHierarchy.nodeCount() << " nodes, " 
+        << kHierarchy.nodeCount() * sizeof(BvhNode) / 1024 << " KiB\n";
+    benchmarkIntersect("bvh", kHierarchy, rays, kNumQueries, stream);
+    stream << "    compressed_bvh: " << kCompressedHierarchy.nodeCount() << " nodes, " 
+        << kCompressedHierarchy.nodeBytes() / 1024 << " KiB\n";
+    benchmarkIntersect("compressed_bvh", kCompressedHierarchy, rays, kNumQueries, stream);
+  }
+}
+
+/**
+ * Times the given number of shadow ray queries of the given segments against the given objects,
+ * first as closest hit queries (wasHit) and then as occlusion queries (isOccluded), checks that 
+ * both find the same segments blocked, and adds the time per query of both to the given stream
+ *
+ * @param kName constant reference to the name of the objects to report
+ * @param kObjects constant reference to the objects to query
+ * @param kRays constant reference to the rays from the start to the end of every segment (so 
+ *     every segment spans t values from 0 to 1)
+ * @param num_queries the number of queries of each kind to time
+ * @param stream reference to a stream to add the result to
+ */
+void benchmarkOcclusionQueries(const std::string& kName, const Hittable& kObjects, 
+    const std::vector<ray>& kRays, size_t num_queries, std::ostream& stream) {
+  // the ends of a segment are on surfaces, so they are left out of it
+  const real kMinT = 0.001;
+  const real kMaxT = 0.999;
+  size_t num_mismatches = 0;
+  for (const ray& kRay : kRays) {
+    HitRecord hit_record = HitRecord();
+    if (kObjects.wasHit(kRay, kMinT, kMaxT, hit_record) != kObjects.isOccluded(kRay, kMinT, kMaxT)) {
+      ++num_mismatches;
+    }
+  }
+
+  HitRecord hit_record = HitRecord();
+  size_t num_blocked = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_queries; ++i) {
+    if (kObjects.wasHit(kRays[i % kRays.size()], kMinT, kMaxT, hit_record)) {
+      ++num_blocked;
+    }
+  }
+  const double kClosestHitSeconds = secondsSince(start);
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_queries; ++i) {
+    if (kObjects.isOccluded(kRays[i % kRays.size()], kMinT, kMaxT)) {
+      ++num_blocked;
+    }
+  }
+  const double kOcclusionSeconds = secondsSince(start);
+  stream << "    " << kName << " (" << num_mismatches << " mismatched queries, " 
+      << num_blocked / 2 << " blocked): closest hit " << (kClosestHitSeconds * 1e9 / num_queries) 
+      << " ns/ray, occlusion " << (kOcclusionSeconds * 1e9 / num_queries) << " ns/ray\n";
+}
+
+void benchmarkOcclusion(std::ostream& stream) {
+  const size_t kNumRays = 1 << 14;
+  const size_t kNumQueries = 1 << 20;
+  setRandomStream(0, 0, 0);
+
+  for (size_t num_spheres : {1 << 8, 1 << 17}) {
+    // spheres scattered through a cube that grows with their number, and segments between 
+    // random points inside it
+    const real kHalfSize = std::cbrt(static_cast<real>(num_spheres));
+    hittable_list list = hittable_list();
+    sphere_set set = sphere_set();
+    for (size_t i = 0; i < num_spheres; ++i) {
+      const point3 kCenter = randomVector(-kHalfSize, kHalfSize);
+      const real kRadius = randomDouble(0.1, 0.4);
+      list.add(std::make_shared<sphere>(kCenter, kRadius, 0));
+      set.add(kCenter, kRadius, 0);
+    }
+    std::vector<ray> rays;
+    for (size_t i = 0; i < kNumRays; ++i) {
+      const point3 kStart = randomVector(-kHalfSize, kHalfSize);
+      rays.push_back(ray(kStart, randomVector(-kHalfSize, kHalfSize) - kStart));
+    }
+
+    stream << "  " << num_spheres << " spheres:\n";
+    if (num_spheres <= 1 << 8) {
+      benchmarkOcclusionQueries("hittable_list", list, rays, kNumQueries / 16, stream);
+      benchmarkOcclusionQueries("sphere_set", set, rays, kNumQueries / 16, stream);
+    }
+    const bvh kHierarchy = bvh(list);
+    benchmarkOcclusionQueries("bvh", kHierarchy, rays, kNumQueries, stream);
+    benchmarkOcclusionQueries("wide_bvh", wide_bvh(kHierarchy), rays, kNumQueries, stream);
+    benchmarkOcclusionQueries("compressed_bvh", compressed_bvh(kHierarchy), rays, kNumQueries, 
+        stream);
+  }
+}
+
+/**
+ * Estimates the memory held by a bvh over the given number of spheres (its nodes, its object 
+ * pointers, and the spheres themselves)
+ *
+ * @param kHierarchy constant reference to the bvh
+ * @param num_spheres the number of spheres owned by the bvh
+ * @return a size_t representing the estimated number of bytes
+ */
+size_t sphereBvhBytes(const bvh& kHierarchy, size_t num_spheres) {
+  // every object has a raw pointer, a shared pointer, and a shared pointer control block
+  const size_t kBytesPerObject = sizeof(const Hittable*) + (3 * sizeof(std::shared_ptr<Hittable>));
+  return (kHierarchy.nodeCount() * sizeof(BvhNode)) 
+      + (num_spheres * (sizeof(sphere) + kBytesPerObject));
+}
+
+void benchmarkInstancing(std::ostream& stream) {
+  const size_t kNumClusterSpheres = 64;
+  const size_t kNumRays = 1 << 14;
+  const size_t kNumQueries = 1 << 20;
+  const real kClusterRadius = 2;
+  setRandomStream(0, 0, 0);
+
+  // one cluster of spheres, shared by every instance
+  std::vector<std::pair<point3, real>> cluster;
+  hittable_list cluster_list = hittable_list();
+  for (size_t i = 0; i < kNumClusterSpheres; ++i) {
+    const point3 kCenter = randomPointInUnitSphere() * (kClusterRadius - 0.3);
+    const real kRadius = randomDouble(0.1, 0.3);
+    cluster.push_back(std::make_pair(kCenter, kRadius));
+    cluster_list.add(std::make_shared<sphere>(kCenter, kRadius, 0));
+  }
+  const std::shared_ptr<const bvh> kClusterHierarchy = std::make_shared<bvh>(cluster_list);
+
+  for (size_t num_instances : {1 << 6, 1 << 10, 1 << 13}) {
+    // copies of the cluster rotated, scaled, and moved through a cube that grows with their 
+    // number, once as instances and once as transformed copies of every sphere
+    const real kHalfSize = 2 * kClusterRadius * std::cbrt(static_cast<real>(num_instances));
+    hittable_list instances = hittable_list();
+    hittable_list flattened = hittable_list();
+    for (size_t i = 0; i < num_instances; ++i) {
+      const real kScale = randomDouble(0.5, 1.5);
+      const affine_transform kObjectToWorld = 
+          affine_transform::translation(randomVector(-kHalfSize, kHalfSize)) 
+          * affine_transform::rotation(randomUnitVector(), randomDouble(0, 360)) 
+          * affine_transform::scaling(vec3(kScale, kScale, kScale));
+      instances.add(std::make_shared<instance>(kClusterHierarchy, kObjectToWorld));
+      for (const std::pair<point3, real>& kSphere : cluster) {
+        flattened.add(std::make_shared<sphere>(kObjectToWorld.transformPoint(kSphere.first), 
+            kSphere.second * kScale, 0));
+      }
+    }
+    const bvh kInstanceHierarchy = bvh(instances);
+    const bvh kFlatHierarchy = bvh(flattened);
+    std::vector<ray> rays;
+    for (size_t i = 0; i < kNumRays; ++i) {
+      rays.push_back(ray(randomVector(-kHalfSize, kHalfSize), randomUnitVector()));
+    }
+
+    // both must find the same closest hits, up to the rounding of the transforms
+    size_t num_mismatches = 0;
+    for (const ray& kRay : rays) {
+      HitRecord instance_hit = HitRecord();
+      HitRecord flat_hit = HitRecord();
+      const bool kInstanceHit = kInstanceHierarchy.wasHit(kRay, 0.001, infinity, instance_hit);
+      const bool kFlatHit = kFlatHierarchy.wasHit(kRay, 0.001, infinity, flat_hit);
+      if (kInstanceHit != kFlatHit || (kInstanceHit 
+          && (std::fabs(instance_hit.t_ - flat_hit.t_) > 1e-3 * flat_hit.t_ 
+          || dot(instance_hit.surface_normal_, flat_hit.surface_normal_) < 0.999))) {
+        ++num_mismatches;
+      }
+    }
+
+    const size_t kInstanceBytes = sphereBvhBytes(*kClusterHierarchy, kNumClusterSpheres) 
+        + (kInstanceHierarchy.nodeCount() * sizeof(BvhNode)) 
+        + (num_instances * (sizeof(instance) + sizeof(const Hittable*) 
+        + (3 * sizeof(std::shared_ptr<Hittable>))));
+    const size_t kFlatBytes = sphereBvhBytes(kFlatHierarchy, num_instances * kNumClusterSpheres);
+    stream << "  " << num_instances << " instances of " << kNumClusterSpheres << " spheres (" 
+        << num_mismatches << " mismatched hits):\n";
+    stream << "    instanced: ~" << kInstanceBytes / 1024 << " KiB\n";
+    benchmarkIntersect("instanced", kInstanceHierarchy, rays, kNumQueries, stream);
+    stream << "    flattened: ~" << kFlatBytes / 1024 << " KiB\n";
+    benchmarkIntersect("flattened", kFlatHierarchy, rays, kNumQueries, stream);
+  }
+}
+
+void benchmarkBvhCache(std::ostream& stream) {
+  const size_t kNumSpheres = 1 << 20;
+  const size_t kNumRays = 1 << 14;
+  const size_t kNumQueries = 1 << 20;
+  thread_pool pool(0);
+
+  // the scene is known by its description, whose hash is the key of its cache
+  const real kHalfSize = std::cbrt(static_cast<real>(kNumSpheres));
+  const RandomSpheresDescription kDescription = RandomSpheresDescription{0, kNumSpheres, kHalfSize,
+      0.1, 0.4, 4};
+
+  // cold start: hash the description, generate the scene, build its hierarchy, and cache it
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  const uint64_t kSceneHash = sceneHash(kDescription);
+  const double kHashSeconds = secondsSince(start);
+  start = std::chrono::steady_clock::now();
+  hittable_list list = hittable_list();
+  addRandomSpheresScene(list, kDescription);
+  const double kConstructSeconds = secondsSince(start);
+  start = std::chrono::steady_clock::now();
+  const bvh kHierarchy = 
+      bvh(list, BvhBuildSettings{BvhBuilder::kBinnedSah, 63, false}, pool);
+  const double kBuildSeconds = secondsSince(start);
+  char file_name[64];
+  std::snprintf(file_name, sizeof(file_name), "results/bvhCache_%016llx.bin", 
+      static_cast<unsigned long long>(kSceneHash));
+  start = std::chrono::steady_clock::now();
+  if (!writeBvhCache(file_name, kHierarchy, kSceneHash)) {
+    stream << "  could not write " << file_name << "\n";
+    return;
+  }
+  const double kWriteSeconds = secondsSince(start);
+  stream << "  " << kNumSpheres << " spheres, cold start: " << kHashSeconds
+      << " s scene hash, " << kConstructSeconds << " s scene construction, " << kBuildSeconds
+      << " s binned SAH build, " << kWriteSeconds << " s cache write\n";
+
+  // warm start: hash the description and map the cache with that hash, without generating the
+  // scene
+  mapped_bvh mapped_hierarchy;
+  start = std::chrono::steady_clock::now();
+  const bool kLoaded = mapped_hierarchy.load(file_name, sceneHash(kDescription));
+  const double kLoadSeconds = secondsSince(start);
+  stream << "  warm start: " << kLoadSeconds << " s scene hash and cache load (" 
+      << (kLoaded ? "mapped" : "failed") << ")";
+  // the cache is stale for any other scene, like the one drawn from the next seed
+  RandomSpheresDescription other_description = kDescription;
+  ++other_description.seed_;
+  mapped_bvh stale_hierarchy;
+  stream << ", stale cache " << (stale_hierarchy.load(file_name, sceneHash(other_description)) 
+      ? "accepted" : "rejected") << "\n";
+  if (!kLoaded) {
+    std::remove(file_name);
+    return;
+  }
+
+  std::vector<ray> rays;
+  for (size_t i = 0; i < kNumRays; ++i) {
+    rays.push_back(ray(randomVector(-kHalfSize, kHalfSize), randomUnitVector()));
+  }
+  // the first rays page the file in
+  start = std::chrono::steady_clock::now();
+  size_t num_mismatches = 0;
+  for (const ray& kRay : rays) {
+    HitRecord hit = HitRecord();
+    HitRecord mapped_hit = HitRecord();
+    const bool kHit = kHierarchy.wasHit(kRay, 0.001, infinity, hit);
+    const bool kMappedHit = mapped_hierarchy.wasHit(kRay, 0.001, infinity, mapped_hit);
+    if (kHit != kMappedHit || (kHit && (hit.t_ != mapped_hit.t_ 
+        || hit.surface_normal_.x() != mapped_hit.surface_normal_.x() 
+        || hit.material_id_ != mapped_hit.material_id_))) {
+      ++num_mismatches;
+    }
+  }
+  stream << "  first " << kNumRays << " rays through both: " << secondsSince(start) << " s (" 
+      << num_mismatches << " mismatched hits)\n";
+  benchmarkIntersect("bvh", kHierarchy, rays, kNumQueries, stream);
+  benchmarkIntersect("mapped_bvh", mapped_hierarchy, rays, kNumQueries, stream);
+  std::remove(file_name);
+}
+
+/**
+ * Returns the camera rays (sample 0) of every pixel of an image, grouped into blocks of pixels 
+ * that are each stored row by row
+ *
+ * @param kSettings constant reference to the settings with the size of the image (a multiple of 
+ *     the block size)
+ * @param block_width the width of the blocks of pixels
+ * @param block_height the height of the blocks of pixels
+ * @return a vector of the rays of every block, block after block
+ */
+std::vector<ray> blockCameraRays(const RenderSettings& kSettings, int block_width, 
+    int block_height) {
+  const camera kCamera = camera();
+  std::vector<ray> rays;
+  for (int block_row = 0; block_row < kSettings.image_height_; block_row += block_height) {
+    for (int block_column = 0; block_column < kSettings.image_width_; 
+        block_column += block_width) {
+      for (int row = block_row; row < block_row + block_height; ++row) {
+        for (int j = block_column; j < block_column + block_width; ++j) {
+          rays.push_back(cameraRay(kCamera, kSettings, row, j, 0));
+        }
+      }
+    }
+  }
+  return rays;
+}
+
+/**
+ * Times the closest hit queries of the given rays against the given objects in packets of the 
+ * given number of consecutive rays, checks that they find the same closest hits as single ray 
+ * queries, and adds the time per ray to the given stream
+ *
+ * @param kObjects constant reference to the objects to intersect
+ * @param kRays constant reference to the rays to intersect the objects with (a multiple of the 
+ *     packet size)
+ * @param packet_size the number of rays in every packet
+ * @param num_passes the number of times to intersect every ray
+ * @param stream reference to a stream to add the result to
+ */
+void benchmarkPacketIntersect(const Hittable& kObjects, const std::vector<ray>& kRays, 
+    size_t packet_size, size_t num_passes, std::ostream& stream) {
+  RayPacket packet = RayPacket();
+  size_t num_mismatches = 0;
+  for (size_t first = 0; first < kRays.size(); first += packet_size) {
+    packet.clear();
+    for (size_t i = first; i < first + packet_size; ++i) {
+      packet.add(kRays[i], infinity);
+    }
+    kObjects.intersectPacket(packet, 0.001);
+    for (size_t i = 0; i < packet_size; ++i) {
+      HitRecord hit_record = HitRecord();
+      const bool kWasHit = kObjects.intersect(kRays[first + i], 0.001, infinity, hit_record);
+      if (kWasHit != packet.was_hit_[i] || (kWasHit && (hit_record.t_ != packet.max_t_[i] 
+          || hit_record.hit_object_ != packet.hit_records_[i].hit_object_))) {
+        ++num_mismatches;
+      }
+    }
+  }
+
+  size_t num_hits = 0;
+  const std::chrono::steady_clock::time_point kStart = std::chrono::steady_clock::now();
+  for (size_t pass = 0; pass < num_passes; ++pass) {
+    for (size_t first = 0; first < kRays.size(); first += packet_size) {
+      packet.clear();
+      for (size_t i = first; i < first + packet_size; ++i) {
+        packet.add(kRays[i], infinity);
+      }
+      kObjects.intersectPacket(packet, 0.001);
+      for (size_t i = 0; i < packet_size; ++i) {
+        num_hits += packet.was_hit_[i] ? 1 : 0;
+      }
+    }
+  }
+  const double kSeconds = secondsSince(kStart);
+  stream << "    packets of " << packet_size << ": " 
+      << (kSeconds * 1e9 / (num_passes * kRays.size())) << " ns/ray (" << num_hits / num_passes 
+      << " hits, " << num_mismatches << " mismatched hits)\n";
+}
+
+void benchmarkRayPackets(std::ostream& stream) {
+  const size_t kNumPasses = 16;
+  setRandomStream(0, 0, 0);
+
+  // the camera rays of one sample of an image whose size is a multiple of every block size
+  RenderSettings settings = RenderSettings();
+  settings.image_width_ = 400;
+  settings.image_height_ = 224;
+  settings.samples_per_pixel_ = 16;
+  settings.max_ray_bounces_ = 50;
+  settings.tile_size_ = 16;
+  settings.num_threads_ = 0;
+  const std::vector<ray> kRays = blockCameraRays(settings, 1, 1);
+
+  stream << kRealLaneCount << " reals per register, " << settings.image_width_ << "x" 
+      << settings.image_height_ << " camera rays\n";
+  for (size_t num_spheres : {1 << 10, 1 << 14, 1 << 17}) {
+    // spheres scattered through a cube that grows with their number, in front of the camera
+    const real kHalfSize = std::cbrt(static_cast<real>(num_spheres));
+    hittable_list list = hittable_list();
+    for (size_t i = 0; i < num_spheres; ++i) {
+      list.add(std::make_shared<sphere>(randomVector(-kHalfSize, kHalfSize) 
+          - vec3(0, 0, kHalfSize + 1), randomDouble(0.1, 0.4), 0));
+    }
+    const bvh kHierarchy = bvh(list);
+
+    stream << "  " << num_spheres << " spheres:\n";
+    size_t num_hits = 0;
+    HitRecord hit_record = HitRecord();
+    const std::chrono::steady_clock::time_point kStart = std::chrono::steady_clock::now();
+    for (size_t pass = 0; pass < kNumPasses; ++pass) {
+      for (const ray& kRay : kRays) {
+        num_hits += kHierarchy.intersect(kRay, 0.001, infinity, hit_record) ? 1 : 0;
+      }
+    }
+    const double kSeconds = secondsSince(kStart);
+    stream << "    one ray at a time: " << (kSeconds * 1e9 / (kNumPasses * kRays.size())) 
+        << " ns/ray (" << num_hits / kNumPasses << " hits)\n";
+    benchmarkPacketIntersect(kHierarchy, blockCameraRays(settings, 2, 2), 4, kNumPasses, stream);
+    benchmarkPacketIntersect(kHierarchy, blockCameraRays(settings, 4, 2), 8, kNumPasses, stream);
+    benchmarkPacketIntersect(kHierarchy, blockCameraRays(settings, 4, 4), 16, kNumPasses, stream);
+  }
+
+  hittable_list metal_world = hittable_list();
+  material_table metal_materials = material_table();
+  addMetalSpheresScene(metal_world, metal_materials);
+  hittable_list glass_world = hittable_list();
+  material_table glass_materials = material_table();
+  addGlassSpheresScene(glass_world, glass_materials);
+  const bvh kHierarchies[2] = {bvh(metal_world), bvh(glass_world)};
+  const material_table* kMaterials[2] = {&metal_materials, &glass_materials};
+  const char* kSceneNames[2] = {"metalSpheres", "glassSpheres"};
+  settings.use_russian_roulette_ = true;
+  settings.russian_roulette_min_bounces_ = 5;
+  for (int scene = 0; scene < 2; ++scene) {
+    std::vector<color> framebuffers[2];
+    for (int mode = 0; mode < 2; ++mode) {
+      settings.ray_packet_size_ = mode == 0 ? 0 : 16;
+      const std::chrono::steady_clock::time_point kRenderStart = std::chrono::steady_clock::now();
+      framebuffers[mode] = renderImage(camera(), kHierarchies[scene], *kMaterials[scene], 
+          settings);
+      // the renderer reports its progress on the same line of the terminal, so start a new one
+      stream << "\n  " << kSceneNames[scene] 
+          << (mode == 0 ? ", one camera ray at a time: " : ", packets of 16 camera rays: ") 
+          << secondsSince(kRenderStart) << " s\n";
+    }
+    stream << "  same image: " << (sameFramebuffers(framebuffers[0], framebuffers[1]) ? "yes" : "no")
+        << "\n";
+  }
+}
+
+bool runBenchmark(const std::string& kName, std::ostream& stream) {
+  if (kName == "vec3") {
+    benchmarkVec3(stream);
+    return true;
+  }
+  if (kName == "russianRoulette") {
+    benchmarkRussianRoulette(stream);
+    return true;
+  }
+  if (kName == "wavefront") {
+    benchmarkWavefront(stream);
+    return true;
+  }
+  if (kName == "materialSort") {
+    benchmarkMaterialSort(stream);
+    return true;
+  }
+  if (kName == "materialDispatch") {
+    benchmarkMaterialDispatch(stream);
+    return true;
+  }
+  if (kName == "sphereSet") {
+    benchmarkSphereSet(stream);
+    return true;
+  }
+  if (kName == "wideBvh") {
+    benchmarkWideBvh(stream);
+    return true;
+  }
+  if (kName == "bvhBuild") {
+    benchmarkBvhBuild(stream);
+    return true;
+  }
+  if (kName == "bvhRefit") {
+    benchmarkBvhRefit(stream);
+    return true;
+  }
+  if (kName == "occlusion") {
+    benchmarkOcclusion(stream);
+    return true;
+  }
+  if (kName == "bvhCache") {
+    benchmarkBvhCache(stream);
+    return true;
+  }
+  if (kName == "compressedBvh") {
+    benchmarkCompressedBvh(stream);
+    return true;
+  }
+  if (kName == "instancing") {
+    benchmarkInstancing(stream);
+    return true;
+  }
+  if (kName == "rayPackets") {
+    benchmarkRayPackets(stream);
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+/**
+ * Returns the number of seconds that have passed since the given time
+ *
+ * @param kStart constant reference to the time to measure from
+ * @return a double representing the seconds that have passed since kStart
+ */
+double secondsSince(const std::chrono::steady_clock::time_point& kStart);
+
+/**
+ * Times sphere::wasHit and Material::scatter (the kernels that do most of the vec3
+ * arithmetic) with the vec3 backend the program was built with, and adds the results
+ * to the given stream
+ *
+ * Build once per backend (make SIMD=scalar|sse4) and compare the reports to see
+ * the speedup of the SIMD backend (make SIMD=avx2 keeps the scalar vec3)
+ *
+ * @param stream reference to a stream to add the results to
+ */
+void benchmarkVec3(std::ostream& stream);
+
+/**
+ * Renders the glass spheres scene without Russian roulette and then with Russian roulette 
+ * after several minimum numbers of bounces, and adds the render time, average path length, 
+ * and mean pixel value (which should agree, since Russian roulette is unbiased) of each 
+ * render to the given stream
+ *
+ * @param stream reference to a stream to add the results to
+ */
+void benchmarkRussianRoulette(std::ostream& stream);
+
+/**
+ * Renders the metal spheres and glass spheres scenes one path at a time and then as 
+ * wavefronts (see wavefront.h), and adds the render time and bounce throughput of both 
+ * modes to the given stream
+ *
+ * @param stream reference to a stream to add the results to
+ */
+void benchmarkWavefront(std::ostream& stream);
+
+/**
+ * Renders the metal spheres scene as wavefronts with hits shaded in the order they occur and 
+ * then grouped by material, and adds the render time of both, and the number of hits and 
+ * shading throughput of every material, to the given stream
+ *
+ * @param stream reference to a stream to add the results to
+ */
+void benchmarkMaterialSort(std::ostream& stream);
+
+/**
+ * Renders the metal spheres scene with every hit scattered through the virtual 
+ * Material::scatter and then through the switch of material_table::scatter, and adds the 
+ * render time of both to the given stream
+ *
+ * @param stream reference to a stream to add the results to
+ */
+void benchmarkMaterialDispatch(std::ostream& stream);
+
+/**
+ * Intersects random rays with growing numbers of random spheres stored in a hittable_list and 
+ * in a sphere_set, checks that both find the same closest hits, and adds the time per ray of 
+ * both to the given stream
+ *
+ * Build with different SIMD backends (make SIMD=scalar|sse4|avx2) and sphere_set widths
+ * (make SPHERE_SET_WIDTH=4|8|16) to compare them
+ *
+ * @param stream reference to a stream to add the results to
+ */
+void benchmarkSphereSet(std::ostream& stream);
+
+/**
+ * Intersects random rays with growing numbers of random spheres in a binary bvh and in a 
+ * wide_bvh collapsed from it, checks that both find the same closest hits, and adds the node 
+ * counts and time per ray of both to the given stream
+ *
+ * Build with different SIMD backends (make SIMD=scalar|sse4|avx2) and wide_bvh widths
+ * (make BVH_WIDTH=4|8) to compare them
+ *
+ * @param stream reference to a stream to add the results to
+ */
+void benchmarkWideBvh(std::ostream& stream);
+
+/**
+ * Builds a bvh over growing numbers of random spheres with the sweep SAH, binned SAH, and 
+ * linear (Morton code) builders on growing numbers of threads, and adds the build time, SAH 
+ * cost, and time per ray of every hierarchy to the given stream
+ *
+ * @param stream reference to a stream to add the results to
+ */
+void benchmarkBvhBuild(std::ostream& stream);
+
+/**
+ * Moves random spheres along random straight lines for several frames, refitting their bvh
+ * every frame and rebuilding it once its SAH cost has grown too much, and adds the time and 
+ * SAH cost growth of every frame and the time of a full rebuild to the given stream
+ *
+ * @param stream reference to a stream to add the results to
+ */
+void benchmarkBvhRefit(std::ostream& stream);
+
+/**
+ * Places growing numbers of rotated, scaled, and moved copies of a cluster of spheres under a 
+ * top-level bvh of instances sharing one bottom-level bvh, and then as a single bvh over 
+ * transformed copies of every sphere, checks that both find the same closest hits, and adds 
+ * the estimated memory and time per ray of both to the given stream
+ *
+ * @param stream reference to a stream to add the results to
+ */
+void benchmarkInstancing(std::ostream& stream);
+
+/**
+ * Intersects random rays with growing numbers of random spheres in a bvh and in a 
+ * compressed_bvh (quantized 32-byte nodes) made from it, checks that both find the same closest 
+ * hits, and adds the node memory and time per ray of both to the given stream
+ *
+ * @param stream reference to a stream to add the results to
+ */
+void benchmarkCompressedBvh(std::ostream& stream);
+
+/**
+ * Hashes the description of a scene of a million random spheres, generates the scene, builds 
+ * its bvh, and writes it to a bvh cache file (cold start), then hashes the description again 
+ * and maps the cache with a mapped_bvh (warm start), checks that both hierarchies find the same 
+ * closest hits, and adds the time of every step and the time per ray of both to the given 
+ * stream
+ *
+ * @param stream reference to a stream to add the results to
+ */
+void benchmarkBvhCache(std::ostream& stream);
+
+/**
+ * Traces random segments through random spheres in a hittable_list, a sphere_set, a bvh, a 
+ * wide_bvh, and a compressed_bvh, checks that closest hit and occlusion queries find the same 
+ * segments blocked, and adds the time per query of both to the given stream
+ *
+ * @param stream reference to a stream to add the results to
+ */
+void benchmarkOcclusion(std::ostream& stream);
+
+/**
+ * Intersects the camera rays of an image with growing numbers of random spheres in a bvh one ray 
+ * at a time and then as packets of 4, 8, and 16 rays from blocks of pixels, checks that both 
+ * find the same closest hits, and adds the time per ray of both to the given stream. Then 
+ * renders the metal spheres and glass spheres scenes with every camera ray traced alone and 
+ * with packets of 16, and adds the render time of both and whether they rendered the same image
+ *
+ * @param stream reference to a stream to add the results to
+ */
+void benchmarkRayPackets(std::ostream& stream);
+
+/**
+ * Runs the benchmark with the given name and adds its results to the given stream
+ *
+ * @param kName constant reference to the name of the benchmark to run
+ * @param stream reference to a stream to add the results to
+ * @return true if a benchmark with the given name exists and false otherwise
+ */
+bool runBenchmark(const std::string& kName, std::ostream& stream);
@@ -0,0 +1,1039 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+#include "bvh.h"
+
+// expected cost of testing a ray against the bounding box of a node
+const double kTraversalCost = 1.0;
+// expected cost of testing a ray against a single object
+const double kIntersectionCost = 1.0;
+// leaves holding at most this many objects are created whenever they are cheaper than splitting
+const size_t kMaxObjectsPerLeaf = 4;
+// number of bins the binned SAH builder tries splits between on every axis
+const int kSahBinCount = 16;
+// ranges with more objects than this are binned in chunks and split into subtrees built at once
+const size_t kParallelBuildThreshold = 1 << 12;
+// number of objects bounded or binned by every task of a parallel build
+const size_t kBuildChunkSize = 1 << 12;
+// subtrees with more nodes than this have their two subtrees refit at once
+const size_t kParallelRefitThreshold = 1 << 13;
+// maximum number of leaves of a treelet optimized by the linear builder (its dynamic program
+// takes about 3^kTreeletLeafCount steps)
+const int kTreeletLeafCount = 7;
+
+bvh::bvh(const hittable_list& kObjects) : bvh(kObjects, 0, 0) {}
+
+bvh::bvh(const hittable_list& kObjects, real time0, real time1) : time0_(time0), time1_(time1) {
+  if (kObjects.objects().empty()) {
+    return;
+  }
+
+  std::vector<BuildObject> build_objects = boundObjects(kObjects, time0, time1, nullptr);
+  // a binary tree over n objects has at most 2n - 1 nodes
+  nodes_.reserve((2 * build_objects.size()) - 1);
+  build(build_objects, 0, build_objects.size(), 0);
+  storeObjects(kObjects, build_objects);
+  built_sah_cost_ = sahCost();
+}
+
+bvh::bvh(const hittable_list& kObjects, const BvhBuildSettings& kSettings, thread_pool& pool)
+    : build_settings_(kSettings) {
+  if (kSettings.builder_ == BvhBuilder::kLinear && kSettings.morton_code_bits_ != 30
+      && kSettings.morton_code_bits_ != 63) {
+    throw std::invalid_argument("bvh: Morton codes must have 30 or 63 bits");
+  }
+  if (kObjects.objects().empty()) {
+    return;
+  }
+
+  std::vector<BuildObject> build_objects = boundObjects(kObjects, 0, 0, &pool);
+  if (kSettings.builder_ == BvhBuilder::kSweepSah) {
+    nodes_.reserve((2 * build_objects.size()) - 1);
+    build(build_objects, 0, build_objects.size(), 0);
+  } else if (kSettings.builder_ == BvhBuilder::kLinear) {
+    buildLinear(build_objects, kSettings, pool);
+  } else {
+    // the subtrees are built into reserved slots so they can be built at once, then copied
+    // into nodes_ without the slots that were not used
+    std::vector<BvhNode> sparse_nodes = std::vector<BvhNode>((2 * build_objects.size()) - 1);
+    buildBinned(build_objects, 0, build_objects.size(), 0, 0, sparse_nodes, pool);
+    nodes_.reserve(sparse_nodes.size());
+    compactNodes(sparse_nodes, 0);
+  }
+  storeObjects(kObjects, build_objects);
+  built_sah_cost_ = sahCost();
+}
+
+std::vector<bvh::BuildObject> bvh::boundObjects(const hittable_list& kObjects, real time0,
+    real time1, thread_pool* pool) {
+  const std::vector<std::shared_ptr<Hittable>>& kListObjects = kObjects.objects();
+  std::vector<BuildObject> build_objects = std::vector<BuildObject>(kListObjects.size());
+  // the pool does not pass exceptions on, so a missing box is only thrown about afterwards
+  std::atomic<bool> has_unbounded_object(false);
+  const auto kBoundChunk = [&](size_t chunk) {
+    const size_t kEnd = std::min((chunk + 1) * kBuildChunkSize, build_objects.size());
+    for (size_t i = chunk * kBuildChunkSize; i < kEnd; ++i) {
+      aabb object_box;
+      if (!kListObjects[i]->boundingBox(time0, time1, object_box)) {
+        has_unbounded_object.store(true, std::memory_order_relaxed);
+      }
+      build_objects[i].object_index_ = i;
+      build_objects[i].bounds_ = object_box;
+      build_objects[i].centroid_ = object_box.centroid();
+    }
+  };
+  const size_t kNumChunks = (build_objects.size() + kBuildChunkSize - 1) / kBuildChunkSize;
+  if (pool != nullptr && kNumChunks > 1) {
+    pool->parallelFor(kNumChunks, kBoundChunk);
+  } else {
+    for (size_t chunk = 0; chunk < kNumChunks; ++chunk) {
+      kBoundChunk(chunk);
+    }
+  }
+  if (has_unbounded_object.load()) {
+    throw std::invalid_argument("bvh: every object must have a bounding box");
+  }
+  return build_objects;
+}
+
+void bvh::storeObjects(const hittable_list& kObjects,
+    const std::vector<BuildObject>& kBuildObjects) {
+  // store the objects in leaf order so every leaf refers to a contiguous range
+  const std::vector<std::shared_ptr<Hittable>>& kListObjects = kObjects.objects();
+  objects_.reserve(kBuildObjects.size());
+  for (const BuildObject& kBuildObject : kBuildObjects) {
+    objects_.push_back(kListObjects[kBuildObject.object_index_].get());
+  }
+  owned_objects_ = kListObjects;
+}
+
+uint32_t bvh::build(std::vector<BuildObject>& build_objects, size_t begin, size_t end,
+    size_t depth) {
+  const uint32_t kNodeIndex = static_cast<uint32_t>(nodes_.size());
+  nodes_.push_back(BvhNode());
+
+  aabb bounds = aabb(); // defaults to an empty box
+  aabb centroid_bounds = aabb();
+  for (size_t i = begin; i < end; ++i) {
+    bounds = surroundingBox(bounds, build_objects[i].bounds_);
+    centroid_bounds = surroundingBox(centroid_bounds, build_objects[i].centroid_);
+  }
+  nodes_[kNodeIndex].bounds_ = bounds;
+
+  const size_t kCount = end - begin;
+  const double kArea = bounds.surfaceArea() > 0 ? bounds.surfaceArea() : 1.0;
+  const vec3 kCentroidExtent = centroid_bounds.maximum() - centroid_bounds.minimum();
+
+  // sweep every axis for the split that minimizes the surface area heuristic
+  double best_cost = infinity;
+  int best_axis = -1;
+  size_t best_split = 0;
+  if (kCount > 1 && depth < kMaxSahDepth) {
+    std::vector<double> right_areas = std::vector<double>(kCount);
+    for (int axis = 0; axis < 3; ++axis) {
+      if (kCentroidExtent[axis] <= 0) {
+        continue;
+      }
+      std::sort(build_objects.begin() + begin, build_objects.begin() + end,
+          [axis](const BuildObject& kFirst, const BuildObject& kSecond) {
+            if (kFirst.centroid_[axis] != kSecond.centroid_[axis]) {
+              return kFirst.centroid_[axis] < kSecond.centroid_[axis];
+            }
+            return kFirst.object_index_ < kSecond.object_index_;
+          });
+
+      // right_areas[i] is the area of the box around objects [i, kCount) of the range
+      aabb right_box = aabb();
+      for (size_t i = kCount - 1; i > 0; --i) {
+        right_box = surroundingBox(right_box, build_objects[begin + i].bounds_);
+        right_areas[i] = right_box.surfaceArea();
+      }
+      aabb left_box = aabb();
+      for (size_t i = 1; i < kCount; ++i) {
+        left_box = surroundingBox(left_box, build_objects[begin + i - 1].bounds_);
+        const double kCost = kTraversalCost + (kIntersectionCost * ((left_box.surfaceArea() * i)
+            + (right_areas[i] * (kCount - i))) / kArea);
+        if (kCost < best_cost) {
+          best_cost = kCost;
+          best_axis = axis;
+          best_split = i;
+        }
+      }
+    }
+  }
+
+  const double kLeafCost = kIntersectionCost * kCount;
+  if (kCount == 1 || (kCount <= kMaxObjectsPerLeaf && kLeafCost <= best_cost)) {
+    nodes_[kNodeIndex].offset_ = static_cast<uint32_t>(begin);
+    nodes_[kNodeIndex].object_count_ = static_cast<uint32_t>(kCount);
+    nodes_[kNodeIndex].split_axis_ = 0;
+    return kNodeIndex;
+  }
+
+  if (best_axis < 0) {
+    // no useful SAH split (all centroids coincide or the tree is too deep), so split
+    // the objects in half along the widest axis of their centroids
+    best_axis = 0;
+    if (kCentroidExtent.y() > kCentroidExtent[best_axis]) {
+      best_axis = 1;
+    }
+    if (kCentroidExtent.z() > kCentroidExtent[best_axis]) {
+      best_axis = 2;
+    }
+    best_split = kCount / 2;
+  }
+
+  // put the objects back in order along the chosen axis (the sweep leaves them sorted
+  // along the last axis it tried)
+  const int kSplitAxis = best_axis;
+  std::nth_element(build_objects.begin() + begin, build_objects.begin() + begin + best_split,
+      build_objects.begin() + end, [kSplitAxis](const BuildObject& kFirst, const BuildObject& kSecond) {
+        if (kFirst.centroid_[kSplitAxis] != kSecond.centroid_[kSplitAxis]) {
+          return kFirst.centroid_[kSplitAxis] < kSecond.centroid_[kSplitAxis];
+        }
+        return kFirst.object_index_ < kSecond.object_index_;
+      });
+
+  // left child is built directly after this node, so only the right child index is stored
+  build(build_objects, begin, begin + best_split, depth + 1);
+  const uint32_t kRightChildIndex = build(build_objects, begin + best_split, end, depth + 1);
+  nodes_[kNodeIndex].offset_ = kRightChildIndex;
+  nodes_[kNodeIndex].object_count_ = 0;
+  nodes_[kNodeIndex].split_axis_ = static_cast<uint32_t>(kSplitAxis);
+  return kNodeIndex;
+}
+
+void bvh::buildBinned(std::vector<BuildObject>& build_objects, size_t begin, size_t end,
+    size_t depth, uint32_t node_index, std::vector<BvhNode>& sparse_nodes, thread_pool& pool) {
+  const size_t kCount = end - begin;
+  // large ranges are bounded and binned in chunks on the pool, then the chunks are merged
+  const size_t kNumChunks = kCount > kParallelBuildThreshold
+      ? (kCount + kBuildChunkSize - 1) / kBuildChunkSize : 1;
+
+  const auto kBoundChunk = [&](size_t chunk, aabb& chunk_bounds, aabb& chunk_centroid_bounds) {
+    const size_t kChunkEnd = std::min(begin + ((chunk + 1) * kBuildChunkSize), end);
+    for (size_t i = begin + (chunk * kBuildChunkSize); i < kChunkEnd; ++i) {
+      chunk_bounds = surroundingBox(chunk_bounds, build_objects[i].bounds_);
+      chunk_centroid_bounds = surroundingBox(chunk_centroid_bounds, build_objects[i].centroid_);
+    }
+  };
+  aabb bounds = aabb();
+  aabb centroid_bounds = aabb();
+  if (kNumChunks > 1) {
+    std::vector<aabb> chunk_bounds = std::vector<aabb>(kNumChunks);
+    std::vector<aabb> chunk_centroid_bounds = std::vector<aabb>(kNumChunks);
+    pool.parallelFor(kNumChunks, [&](size_t chunk) {
+      kBoundChunk(chunk, chunk_bounds[chunk], chunk_centroid_bounds[chunk]);
+    });
+    for (size_t chunk = 0; chunk < kNumChunks; ++chunk) {
+      bounds = surroundingBox(bounds, chunk_bounds[chunk]);
+      centroid_bounds = surroundingBox(centroid_bounds, chunk_centroid_bounds[chunk]);
+    }
+  } else {
+    kBoundChunk(0, bounds, centroid_bounds);
+  }
+  BvhNode& node = sparse_nodes[node_index];
+  node.bounds_ = bounds;
+
+  const double kArea = bounds.surfaceArea() > 0 ? bounds.surfaceArea() : 1.0;
+  const point3 kCentroidMinimum = centroid_bounds.minimum();
+  const vec3 kCentroidExtent = centroid_bounds.maximum() - kCentroidMinimum;
+  // small ranges use fewer bins, since evaluating empty bins is most of their build time
+  const int kBinCount = kCount < static_cast<size_t>(kSahBinCount)
+      ? static_cast<int>(kCount) : kSahBinCount;
+  // maps a centroid coordinate along an axis to the index of its bin on that axis
+  const auto kBinIndex = [&](const BuildObject& kObject, int axis) {
+    const real kRelative = (kObject.centroid_[axis] - kCentroidMinimum[axis])
+        / kCentroidExtent[axis];
+    const int kIndex = static_cast<int>(kRelative * kBinCount);
+    return kIndex < kBinCount - 1 ? kIndex : kBinCount - 1;
+  };
+
+  // find the split between bins that minimizes the surface area heuristic
+  double best_cost = infinity;
+  int best_axis = -1;
+  int best_split = 0;
+  if (kCount > 1 && depth < kMaxSahDepth) {
+    // bins[axis * kSahBinCount + i] holds the objects in bin i along the axis
+    SahBin bins[3 * kSahBinCount];
+    for (int axis = 0; axis < 3; ++axis) {
+      for (int bin = 0; bin < kBinCount; ++bin) {
+        bins[(axis * kSahBinCount) + bin] = SahBin{aabb(), 0};
+      }
+    }
+    const auto kBinChunk = [&](size_t chunk, SahBin* chunk_bins) {
+      const size_t kChunkEnd = std::min(begin + ((chunk + 1) * kBuildChunkSize), end);
+      for (size_t i = begin + (chunk * kBuildChunkSize); i < kChunkEnd; ++i) {
+        for (int axis = 0; axis < 3; ++axis) {
+          if (kCentroidExtent[axis] > 0) {
+            SahBin& bin = chunk_bins[(axis * kSahBinCount) + kBinIndex(build_objects[i], axis)];
+            bin.bounds_ = surroundingBox(bin.bounds_, build_objects[i].bounds_);
+            ++bin.object_count_;
+          }
+        }
+      }
+    };
+    if (kNumChunks > 1) {
+      std::vector<SahBin> chunk_bins = std::vector<SahBin>(kNumChunks * 3 * kSahBinCount,
+          SahBin{aabb(), 0});
+      pool.parallelFor(kNumChunks, [&](size_t chunk) {
+        kBinChunk(chunk, &chunk_bins[chunk * 3 * kSahBinCount]);
+      });
+      for (size_t chunk = 0; chunk < kNumChunks; ++chunk) {
+        for (int bin = 0; bin < 3 * kSahBinCount; ++bin) {
+          const SahBin& kChunkBin = chunk_bins[(chunk * 3 * kSahBinCount) + bin];
+          bins[bin].bounds_ = surroundingBox(bins[bin].bounds_, kChunkBin.bounds_);
+          bins[bin].object_count_ += kChunkBin.object_count_;
+        }
+      }
+    } else {
+      kBinChunk(0, bins);
+    }
+
+    for (int axis = 0; axis < 3; ++axis) {
+      if (kCentroidExtent[axis] <= 0) {
+        continue;
+      }
+      const SahBin* kAxisBins = &bins[axis * kSahBinCount];
+
+      // right_areas[i] and right_counts[i] describe the objects in bins [i, kBinCount)
+      double right_areas[kSahBinCount];
+      size_t right_counts[kSahBinCount];
+      aabb right_box = aabb();
+      size_t right_count = 0;
+      for (int bin = kBinCount - 1; bin > 0; --bin) {
+        right_box = surroundingBox(right_box, kAxisBins[bin].bounds_);
+        right_count += kAxisBins[bin].object_count_;
+        right_areas[bin] = right_box.surfaceArea();
+        right_counts[bin] = right_count;
+      }
+      aabb left_box = aabb();
+      size_t left_count = 0;
+      for (int split = 1; split < kBinCount; ++split) {
+        left_box = surroundingBox(left_box, kAxisBins[split - 1].bounds_);
+        left_count += kAxisBins[split - 1].object_count_;
+        if (left_count == 0 || right_counts[split] == 0) {
+          continue;
+        }
+        const double kCost = kTraversalCost + (kIntersectionCost * ((left_box.surfaceArea()
+            * left_count) + (right_areas[split] * right_counts[split])) / kArea);
+        if (kCost < best_cost) {
+          best_cost = kCost;
+          best_axis = axis;
+          best_split = split;
+        }
+      }
+    }
+  }
+
+  const double kLeafCost = kIntersectionCost * kCount;
+  if (kCount == 1 || (kCount <= kMaxObjectsPerLeaf && kLeafCost <= best_cost)) {
+    node.offset_ = static_cast<uint32_t>(begin);
+    node.object_count_ = static_cast<uint32_t>(kCount);
+    node.split_axis_ = 0;
+    return;
+  }
+
+  size_t middle = 0;
+  if (best_axis < 0) {
+    // no useful SAH split (all centroids coincide or the tree is too deep), so split
+    // the objects in half along the widest axis of their centroids
+    best_axis = 0;
+    if (kCentroidExtent.y() > kCentroidExtent[best_axis]) {
+      best_axis = 1;
+    }
+    if (kCentroidExtent.z() > kCentroidExtent[best_axis]) {
+      best_axis = 2;
+    }
+    const int kSplitAxis = best_axis;
+    middle = begin + (kCount / 2);
+    std::nth_element(build_objects.begin() + begin, build_objects.begin() + middle,
+        build_objects.begin() + end,
+        [kSplitAxis](const BuildObject& kFirst, const BuildObject& kSecond) {
+          if (kFirst.centroid_[kSplitAxis] != kSecond.centroid_[kSplitAxis]) {
+            return kFirst.centroid_[kSplitAxis] < kSecond.centroid_[kSplitAxis];
+          }
+          return kFirst.object_index_ < kSecond.object_index_;
+        });
+  } else {
+    const int kSplitAxis = best_axis;
+    const int kSplitBin = best_split;
+    middle = std::partition(build_objects.begin() + begin, build_objects.begin() + end,
+        [&kBinIndex, kSplitAxis, kSplitBin](const BuildObject& kObject) {
+          return kBinIndex(kObject, kSplitAxis) < kSplitBin;
+        }) - build_objects.begin();
+  }
+
+  // the left subtree over m objects takes the 2m - 1 slots after this node
+  const uint32_t kLeftChildIndex = node_index + 1;
+  const uint32_t kRightChildIndex = node_index + static_cast<uint32_t>(2 * (middle - begin));
+  node.offset_ = kRightChildIndex;
+  node.object_count_ = 0;
+  node.split_axis_ = static_cast<uint32_t>(best_axis);
+  if (kCount > kParallelBuildThreshold) {
+    pool.parallelFor(2, [&](size_t child) {
+      if (child == 0) {
+        buildBinned(build_objects, begin, middle, depth + 1, kLeftChildIndex, sparse_nodes, pool);
+      } else {
+        buildBinned(build_objects, middle, end, depth + 1, kRightChildIndex, sparse_nodes, pool);
+      }
+    });
+  } else {
+    buildBinned(build_objects, begin, middle, depth + 1, kLeftChildIndex, sparse_nodes, pool);
+    buildBinned(build_objects, middle, end, depth + 1, kRightChildIndex, sparse_nodes, pool);
+  }
+}
+
+uint32_t bvh::compactNodes(const std::vector<BvhNode>& kSparseNodes, uint32_t sparse_node_index) {
+  const uint32_t kNodeIndex = static_cast<uint32_t>(nodes_.size());
+  nodes_.push_back(kSparseNodes[sparse_node_index]);
+  if (!kSparseNodes[sparse_node_index].isLeaf()) {
+    // the left child is copied directly after this node, as in the sparse layout
+    compactNodes(kSparseNodes, sparse_node_index + 1);
+    nodes_[kNodeIndex].offset_ = compactNodes(kSparseNodes, kSparseNodes[sparse_node_index].offset_);
+  }
+  return kNodeIndex;
+}
+
+/**
+ * Returns the number of leading bits that the given Morton codes have in common
+ *
+ * @param first the first code
+ * @param second the second code
+ * @return an int representing the length of the common prefix of the codes (64 if they are equal)
+ */
+static int commonPrefixLength(uint64_t first, uint64_t second) {
+  return first == second ? 64 : __builtin_clzll(first ^ second);
+}
+
+void bvh::buildLinear(std::vector<BuildObject>& build_objects, const BvhBuildSettings& kSettings,
+    thread_pool& pool) {
+  const size_t kCount = build_objects.size();
+  const size_t kNumChunks = (kCount + kBuildChunkSize - 1) / kBuildChunkSize;
+  const auto kRunChunks = [&](const std::function<void(size_t)>& kChunk) {
+    if (kNumChunks > 1) {
+      pool.parallelFor(kNumChunks, kChunk);
+    } else {
+      kChunk(0);
+    }
+  };
+
+  // quantize the centroids to a grid over their bounds and sort them along the Morton curve
+  std::vector<aabb> chunk_centroid_bounds = std::vector<aabb>(kNumChunks);
+  kRunChunks([&](size_t chunk) {
+    const size_t kEnd = std::min((chunk + 1) * kBuildChunkSize, kCount);
+    for (size_t i = chunk * kBuildChunkSize; i < kEnd; ++i) {
+      chunk_centroid_bounds[chunk] = surroundingBox(chunk_centroid_bounds[chunk],
+          build_objects[i].centroid_);
+    }
+  });
+  aabb centroid_bounds = aabb();
+  for (const aabb& kChunkBounds : chunk_centroid_bounds) {
+    centroid_bounds = surroundingBox(centroid_bounds, kChunkBounds);
+  }
+  std::vector<MortonPrimitive> primitives = std::vector<MortonPrimitive>(kCount);
+  kRunChunks([&](size_t chunk) {
+    const size_t kEnd = std::min((chunk + 1) * kBuildChunkSize, kCount);
+    for (size_t i = chunk * kBuildChunkSize; i < kEnd; ++i) {
+      primitives[i].code_ = mortonCode(build_objects[i].centroid_, centroid_bounds,
+          kSettings.morton_code_bits_);
+      primitives[i].object_index_ = static_cast<uint32_t>(i);
+    }
+  });
+  radixSortMortonPrimitives(primitives, kSettings.morton_code_bits_, pool);
+
+  // leaves go after the kCount - 1 interior nodes
+  std::vector<BuildObject> sorted_objects = std::vector<BuildObject>(kCount);
+  std::vector<LinearNode> linear_nodes = std::vector<LinearNode>((2 * kCount) - 1);
+  kRunChunks([&](size_t chunk) {
+    const size_t kEnd = std::min((chunk + 1) * kBuildChunkSize, kCount);
+    for (size_t i = chunk * kBuildChunkSize; i < kEnd; ++i) {
+      sorted_objects[i] = build_objects[primitives[i].object_index_];
+      LinearNode& leaf = linear_nodes[kCount - 1 + i];
+      leaf.bounds_ = sorted_objects[i].bounds_;
+      leaf.object_index_ = static_cast<uint32_t>(i);
+      leaf.object_count_ = 1;
+      leaf.cost_ = kIntersectionCost * leaf.bounds_.surfaceArea();
+    }
+  });
+
+  if (kCount > 1) {
+    buildRadixTree(primitives, 0, kCount - 1, 0, 0, linear_nodes, pool);
+    if (kSettings.optimize_treelets_) {
+      optimizeTreelets(linear_nodes, 0, pool);
+    }
+  }
+
+  // lay the tree out depth first, which also puts the objects of every leaf next to each other
+  std::vector<BuildObject> leaf_objects;
+  leaf_objects.reserve(kCount);
+  nodes_.reserve(linear_nodes.size());
+  // the root is at 0 whether it is an interior node or the only leaf
+  layOutLinearTree(linear_nodes, 0, 0, sorted_objects, leaf_objects);
+  build_objects.swap(leaf_objects);
+}
+
+void bvh::buildRadixTree(const std::vector<MortonPrimitive>& kPrimitives, size_t first,
+    size_t last, uint32_t node_index, size_t depth, std::vector<LinearNode>& linear_nodes,
+    thread_pool& pool) {
+  const uint64_t kFirstCode = kPrimitives[first].code_;
+  const uint64_t kLastCode = kPrimitives[last].code_;
+  size_t split = first + ((last - first) / 2);
+  if (kFirstCode != kLastCode && depth < kMaxSahDepth) {
+    // binary search for the last object whose code shares more leading bits with the first
+    // code than the last code does
+    const int kRangePrefix = commonPrefixLength(kFirstCode, kLastCode);
+    split = first;
+    size_t step = last - first;
+    do {
+      step = (step + 1) / 2;
+      const size_t kCandidate = split + step;
+      if (kCandidate < last
+          && commonPrefixLength(kFirstCode, kPrimitives[kCandidate].code_) > kRangePrefix) {
+        split = kCandidate;
+      }
+    } while (step > 1);
+  }
+  // otherwise the codes are all equal (or the tree is too deep), so split the range in half
+
+  // a child range's node is its leaf if it has one object and otherwise takes the index of
+  // the end of the range at the split, which no other node takes
+  const uint32_t kLeafOffset = static_cast<uint32_t>(kPrimitives.size() - 1);
+  const uint32_t kLeftIndex = static_cast<uint32_t>(split == first ? kLeafOffset + split : split);
+  const uint32_t kRightIndex = static_cast<uint32_t>(split + 1 == last ? kLeafOffset + last
+      : split + 1);
+  const auto kBuildChild = [&](size_t child) {
+    if (child == 0 && split > first) {
+      buildRadixTree(kPrimitives, first, split, kLeftIndex, depth + 1, linear_nodes, pool);
+    } else if (child == 1 && split + 1 < last) {
+      buildRadixTree(kPrimitives, split + 1, last, kRightIndex, depth + 1, linear_nodes, pool);
+    }
+  };
+  if (last - first >= kParallelBuildThreshold) {
+    pool.parallelFor(2, kBuildChild);
+  } else {
+    kBuildChild(0);
+    kBuildChild(1);
+  }
+
+  LinearNode& node = linear_nodes[node_index];
+  const LinearNode& kLeft = linear_nodes[kLeftIndex];
+  const LinearNode& kRight = linear_nodes[kRightIndex];
+  node.children_[0] = kLeftIndex;
+  node.children_[1] = kRightIndex;
+  node.object_index_ = 0;
+  node.object_count_ = kLeft.object_count_ + kRight.object_count_;
+  node.bounds_ = surroundingBox(kLeft.bounds_, kRight.bounds_);
+  node.cost_ = (kTraversalCost * node.bounds_.surfaceArea()) + kLeft.cost_ + kRight.cost_;
+}
+
+void bvh::optimizeTreelets(std::vector<LinearNode>& linear_nodes, uint32_t node_index,
+    thread_pool& pool) {
+  const LinearNode& kNode = linear_nodes[node_index];
+  if (kNode.object_count_ == 1) {
+    return;
+  }
+  const uint32_t kLeftIndex = kNode.children_[0];
+  const uint32_t kRightIndex = kNode.children_[1];
+  if (kNode.object_count_ > kParallelBuildThreshold) {
+    pool.parallelFor(2, [&](size_t child) {
+      optimizeTreelets(linear_nodes, child == 0 ? kLeftIndex : kRightIndex, pool);
+    });
+  } else {
+    optimizeTreelets(linear_nodes, kLeftIndex, pool);
+    optimizeTreelets(linear_nodes, kRightIndex, pool);
+  }
+  optimizeTreelet(linear_nodes, node_index);
+}
+
+void bvh::optimizeTreelet(std::vector<LinearNode>& linear_nodes, uint32_t root_index) {
+  // grow the treelet by opening its largest leaf that is an interior node of the tree, keeping
+  // the interior nodes that were opened so they can be reused by the new topology
+  uint32_t leaves[kTreeletLeafCount];
+  uint32_t interior_nodes[kTreeletLeafCount - 1];
+  int leaf_count = 0;
+  int interior_count = 0;
+  interior_nodes[interior_count++] = root_index;
+  leaves[leaf_count++] = linear_nodes[root_index].children_[0];
+  leaves[leaf_count++] = linear_nodes[root_index].children_[1];
+  while (leaf_count < kTreeletLeafCount) {
+    int largest_leaf = -1;
+    real largest_area = -1;
+    for (int i = 0; i < leaf_count; ++i) {
+      const LinearNode& kLeaf = linear_nodes[leaves[i]];
+      if (kLeaf.object_count_ > 1 && kLeaf.bounds_.surfaceArea() > largest_area) {
+        largest_area = kLeaf.bounds_.surfaceArea();
+        largest_leaf = i;
+      }
+    }
+    if (largest_leaf < 0) {
+      break;
+    }
+    const uint32_t kOpenedIndex = leaves[largest_leaf];
+    interior_nodes[interior_count++] = kOpenedIndex;
+    leaves[largest_leaf] = linear_nodes[kOpenedIndex].children_[0];
+    leaves[leaf_count++] = linear_nodes[kOpenedIndex].children_[1];
+  }
+  if (leaf_count < 3) {
+    // two leaves only have one topology
+    return;
+  }
+
+  // costs[subset] is the lowest SAH cost of a tree over the subset of the leaves, found by
+  // trying every way of splitting the subset in two (the leaves' subtrees keep their costs)
+  const int kNumSubsets = 1 << leaf_count;
+  aabb subset_bounds[1 << kTreeletLeafCount];
+  double costs[1 << kTreeletLeafCount];
+  int best_partitions[1 << kTreeletLeafCount];
+  uint32_t object_counts[1 << kTreeletLeafCount];
+  subset_bounds[0] = aabb();
+  object_counts[0] = 0;
+  for (int subset = 1; subset < kNumSubsets; ++subset) {
+    const int kLowestBit = subset & -subset;
+    int lowest_leaf = 0;
+    while ((1 << lowest_leaf) != kLowestBit) {
+      ++lowest_leaf;
+    }
+    const LinearNode& kLowestLeaf = linear_nodes[leaves[lowest_leaf]];
+    subset_bounds[subset] = surroundingBox(subset_bounds[subset ^ kLowestBit], kLowestLeaf.bounds_);
+    object_counts[subset] = object_counts[subset ^ kLowestBit] + kLowestLeaf.object_count_;
+    if (subset == kLowestBit) {
+      costs[subset] = kLowestLeaf.cost_;
+      best_partitions[subset] = 0;
+      continue;
+    }
+    // only partitions holding the lowest leaf are tried, since the others are their mirrors
+    double best_cost = infinity;
+    int best_partition = 0;
+    for (int partition = (subset - 1) & subset; partition > 0; partition = (partition - 1) & subset) {
+      if ((partition & kLowestBit) == 0) {
+        continue;
+      }
+      const double kCost = costs[partition] + costs[subset ^ partition];
+      if (kCost < best_cost) {
+        best_cost = kCost;
+        best_partition = partition;
+      }
+    }
+    costs[subset] = (kTraversalCost * subset_bounds[subset].surfaceArea()) + best_cost;
+    best_partitions[subset] = best_partition;
+  }
+  const int kAllLeaves = kNumSubsets - 1;
+  if (costs[kAllLeaves] >= linear_nodes[root_index].cost_) {
+    return;
+  }
+
+  // rebuild the treelet top down from the best partitions, reusing its interior nodes (the
+  // root stays the root, so its parent is unchanged), then update them bottom up
+  int subsets[kTreeletLeafCount - 1];
+  subsets[0] = kAllLeaves;
+  int num_assigned = 1;
+  for (int i = 0; i < num_assigned; ++i) {
+    LinearNode& node = linear_nodes[interior_nodes[i]];
+    const int kPartitions[2] = {best_partitions[subsets[i]], subsets[i] ^ best_partitions[subsets[i]]};
+    for (int child = 0; child < 2; ++child) {
+      const int kPartition = kPartitions[child];
+      if ((kPartition & (kPartition - 1)) == 0) {
+        int leaf = 0;
+        while ((1 << leaf) != kPartition) {
+          ++leaf;
+        }
+        node.children_[child] = leaves[leaf];
+      } else {
+        subsets[num_assigned] = kPartition;
+        node.children_[child] = interior_nodes[num_assigned++];
+      }
+    }
+  }
+  for (int i = num_assigned - 1; i >= 0; --i) {
+    LinearNode& node = linear_nodes[interior_nodes[i]];
+    node.bounds_ = subset_bounds[subsets[i]];
+    node.object_count_ = object_counts[subsets[i]];
+    node.cost_ = costs[subsets[i]];
+  }
+}
+
+size_t bvh::linearTreeHeight(const std::vector<LinearNode>& kLinearNodes, uint32_t node_index) {
+  const LinearNode& kLinearNode = kLinearNodes[node_index];
+  if (kLinearNode.object_count_ == 1) {
+    return 0;
+  }
+  return 1 + std::max(linearTreeHeight(kLinearNodes, kLinearNode.children_[0]),
+      linearTreeHeight(kLinearNodes, kLinearNode.children_[1]));
+}
+
+uint32_t bvh::layOutLinearTree(const std::vector<LinearNode>& kLinearNodes, uint32_t node_index,
+    size_t depth, const std::vector<BuildObject>& kSortedObjects,
+    std::vector<BuildObject>& leaf_objects) {
+  const LinearNode& kLinearNode = kLinearNodes[node_index];
+  if (depth == kMaxSahDepth && linearTreeHeight(kLinearNodes, node_index) > kMaxSahDepth) {
+    // optimized treelets made this subtree too deep for the traversal stacks, so gather its
+    // objects left to right and let build split them (only by medians at this depth)
+    const size_t kBegin = leaf_objects.size();
+    std::vector<uint32_t> pending = std::vector<uint32_t>(1, node_index);
+    while (!pending.empty()) {
+      const LinearNode& kPending = kLinearNodes[pending.back()];
+      pending.pop_back();
+      if (kPending.object_count_ == 1) {
+        leaf_objects.push_back(kSortedObjects[kPending.object_index_]);
+      } else {
+        pending.push_back(kPending.children_[1]);
+        pending.push_back(kPending.children_[0]);
+      }
+    }
+    return build(leaf_objects, kBegin, leaf_objects.size(), depth);
+  }
+
+  const uint32_t kNodeIndex = static_cast<uint32_t>(nodes_.size());
+  nodes_.push_back(BvhNode());
+  nodes_[kNodeIndex].bounds_ = kLinearNode.bounds_;
+
+  const double kLeafCost = kIntersectionCost * kLinearNode.object_count_
+      * kLinearNode.bounds_.surfaceArea();
+  if (kLinearNode.object_count_ == 1
+      || (kLinearNode.object_count_ <= kMaxObjectsPerLeaf && kLeafCost <= kLinearNode.cost_)) {
+    nodes_[kNodeIndex].offset_ = static_cast<uint32_t>(leaf_objects.size());
+    nodes_[kNodeIndex].object_count_ = kLinearNode.object_count_;
+    nodes_[kNodeIndex].split_axis_ = 0;
+    // gather the objects of the subtree (at most kMaxObjectsPerLeaf of them) left to right
+    uint32_t pending[kMaxObjectsPerLeaf];
+    size_t num_pending = 0;
+    pending[num_pending++] = node_index;
+    while (num_pending > 0) {
+      const LinearNode& kPending = kLinearNodes[pending[--num_pending]];
+      if (kPending.object_count_ == 1) {
+        leaf_objects.push_back(kSortedObjects[kPending.object_index_]);
+      } else {
+        pending[num_pending++] = kPending.children_[1];
+        pending[num_pending++] = kPending.children_[0];
+      }
+    }
+    return kNodeIndex;
+  }
+
+  // split along the axis that separates the centers of the children the most, with the child
+  // at the lower coordinates first, so traversal can visit the nearer child first
+  uint32_t left_index = kLinearNode.children_[0];
+  uint32_t right_index = kLinearNode.children_[1];
+  const vec3 kSeparation = kLinearNodes[right_index].bounds_.centroid()
+      - kLinearNodes[left_index].bounds_.centroid();
+  int split_axis = 0;
+  for (int axis = 1; axis < 3; ++axis) {
+    if (std::fabs(kSeparation[axis]) > std::fabs(kSeparation[split_axis])) {
+      split_axis = axis;
+    }
+  }
+  if (kSeparation[split_axis] < 0) {
+    std::swap(left_index, right_index);
+  }
+  nodes_[kNodeIndex].object_count_ = 0;
+  nodes_[kNodeIndex].split_axis_ = static_cast<uint32_t>(split_axis);
+  layOutLinearTree(kLinearNodes, left_index, depth + 1, kSortedObjects, leaf_objects);
+  nodes_[kNodeIndex].offset_ = layOutLinearTree(kLinearNodes, right_index, depth + 1,
+      kSortedObjects, leaf_objects);
+  return kNodeIndex;
+}
+
+bool bvh::intersect(const ray& kRay, real min_t, real max_t, HitRecord& hit_record) const {
+  if (nodes_.empty()) {
+    return false;
+  }
+  return intersectSubtree(kRay, 0, min_t, max_t, hit_record);
+}
+
+bool bvh::intersectSubtree(const ray& kRay, uint32_t root_index, real min_t, real max_t, 
+    HitRecord& hit_record) const {
+  const point3 kOrigin = kRay.origin();
+  const vec3 kDirection = kRay.direction();
+  const vec3 kInverseDirection = inverseDirection(kDirection);
+  uint32_t node_stack[kMaxTraversalStackSize];
+  size_t stack_size = 0;
+  uint32_t node_index = root_index;
+  bool has_hit_anything = false;
+  real closest_t_value = max_t;
+
+  while (true) {
+    const BvhNode& kNode = nodes_[node_index];
+    if (kNode.bounds_.wasHit(kOrigin, kInverseDirection, min_t, closest_t_value)) {
+      if (kNode.isLeaf()) {
+        for (uint32_t i = kNode.offset_; i < kNode.offset_ + kNode.object_count_; ++i) {
+          if (objects_[i]->intersect(kRay, min_t, closest_t_value, hit_record)) {
+            closest_t_value = hit_record.t_;
+            has_hit_anything = true;
+          }
+        }
+      } else {
+        // visit the child nearer to the ray origin first so farther subtrees can be culled
+        // by the closest hit found so far
+        assert(stack_size < kMaxTraversalStackSize);
+        if (kDirection[kNode.split_axis_] < 0) {
+          node_stack[stack_size++] = node_index + 1;
+          node_index = kNode.offset_;
+        } else {
+          node_stack[stack_size++] = kNode.offset_;
+          node_index = node_index + 1;
+        }
+        continue;
+      }
+    }
+    if (stack_size == 0) {
+      break;
+    }
+    node_index = node_stack[--stack_size];
+  }
+  return has_hit_anything;
+}
+
+bool bvh::isOccluded(const ray& kRay, real min_t, real max_t) const {
+  if (nodes_.empty()) {
+    return false;
+  }
+
+  const point3 kOrigin = kRay.origin();
+  const vec3 kDirection = kRay.direction();
+  const vec3 kInverseDirection = inverseDirection(kDirection);
+  uint32_t node_stack[kMaxTraversalStackSize];
+  size_t stack_size = 0;
+  uint32_t node_index = 0;
+
+  while (true) {
+    const BvhNode& kNode = nodes_[node_index];
+    if (kNode.bounds_.wasHit(kOrigin, kInverseDirection, min_t, max_t)) {
+      if (kNode.isLeaf()) {
+        for (uint32_t i = kNode.offset_; i < kNode.offset_ + kNode.object_count_; ++i) {
+          if (objects_[i]->isOccluded(kRay, min_t, max_t)) {
+            return true;
+          }
+        }
+      } else {
+        // the nearer child is still visited first, since occluders near the ray origin end
+        // the search soonest
+        assert(stack_size < kMaxTraversalStackSize);
+        if (kDirection[kNode.split_axis_] < 0) {
+          node_stack[stack_size++] = node_index + 1;
+          node_index = kNode.offset_;
+        } else {
+          node_stack[stack_size++] = kNode.offset_;
+          node_index = node_index + 1;
+        }
+        continue;
+      }
+    }
+    if (stack_size == 0) {
+      break;
+    }
+    node_index = node_stack[--stack_size];
+  }
+  return false;
+}
+
+/**
+ * Tests the given box against the given rays of the given packet, kRealLaneCount rays at a time
+ *
+ * Every lane runs the same comparisons as aabb::wasHit, so a ray hits the box here exactly
+ * when it would on its own
+ *
+ * @param kBox constant reference to the box to test
+ * @param kPacket constant reference to the packet of rays to test against the box
+ * @param ray_mask a uint32_t with bit i set for every ray i of the packet to test
+ * @param min_t real representing the minimum t value for the intersections
+ * @return a uint32_t with bit i set when ray i is in ray_mask and overlaps the box somewhere in
+ *     [min_t, its max_t_]
+ */
+static uint32_t packetBoxHitMask(const aabb& kBox, const RayPacket& kPacket, uint32_t ray_mask,
+    real min_t) {
+  const uint32_t kLaneBits = (1u << kRealLaneCount) - 1;
+  const point3 kMinimum = kBox.minimum();
+  const point3 kMaximum = kBox.maximum();
+  const real* kOrigins[3] = {kPacket.origin_x_, kPacket.origin_y_, kPacket.origin_z_};
+  const real* kInverseDirections[3] = {kPacket.inverse_direction_x_,
+      kPacket.inverse_direction_y_, kPacket.inverse_direction_z_};
+  uint32_t hit_mask = 0;
+  for (size_t first = 0; first < kPacket.size_; first += kRealLaneCount) {
+    // rays that missed the parent box (or are past the end of the packet) miss this one too
+    if (((ray_mask >> first) & kLaneBits) == 0) {
+      continue;
+    }
+    RealLanes near_t = realLanesBroadcast(min_t);
+    RealLanes far_t = realLanesLoad(kPacket.max_t_ + first);
+    for (int axis = 0; axis < 3; ++axis) {
+      const RealLanes kOrigin = realLanesLoad(kOrigins[axis] + first);
+      const RealLanes kInverseDirection = realLanesLoad(kInverseDirections[axis] + first);
+      const RealLanes kT0 = realLanesMultiply(
+          realLanesSubtract(realLanesBroadcast(kMinimum[axis]), kOrigin), kInverseDirection);
+      const RealLanes kT1 = realLanesMultiply(
+          realLanesSubtract(realLanesBroadcast(kMaximum[axis]), kOrigin), kInverseDirection);
+      // near and far planes picked by the sign of the inverse direction, like aabb::wasHit, so a
+      // NaN t value leaves near_t and far_t as they were
+      near_t = realLanesMax(realLanesSelectNegative(kInverseDirection, kT1, kT0), near_t);
+      far_t = realLanesMin(realLanesSelectNegative(kInverseDirection, kT0, kT1), far_t);
+    }
+    hit_mask |= static_cast<uint32_t>(realLanesLessEqualMask(near_t, far_t)) << first;
+  }
+  return hit_mask & ray_mask;
+}
+
+void bvh::intersectPacket(RayPacket& packet, real min_t) const {
+  if (nodes_.empty() || packet.size_ == 0) {
+    return;
+  }
+
+  // every entry of the stack is a node and the rays of the packet that hit its parent
+  uint32_t node_stack[kMaxTraversalStackSize];
+  uint32_t ray_mask_stack[kMaxTraversalStackSize];
+  size_t stack_size = 0;
+  uint32_t node_index = 0;
+  uint32_t ray_mask = static_cast<uint32_t>((uint64_t(1) << packet.size_) - 1);
+
+  while (true) {
+    const BvhNode& kNode = nodes_[node_index];
+    const uint32_t kHitMask = packetBoxHitMask(kNode.bounds_, packet, ray_mask, min_t);
+    if ((kHitMask & (kHitMask - 1)) == 0 && kHitMask != 0) {
+      // the packet has diverged down to a single ray, which is cheaper to trace on its own
+      const int kRayIndex = __builtin_ctz(kHitMask);
+      if (intersectSubtree(packet.rays_[kRayIndex], node_index, min_t, packet.max_t_[kRayIndex],
+          packet.hit_records_[kRayIndex])) {
+        packet.max_t_[kRayIndex] = packet.hit_records_[kRayIndex].t_;
+        packet.was_hit_[kRayIndex] = true;
+      }
+    } else if (kHitMask != 0) {
+      if (kNode.isLeaf()) {
+        for (uint32_t i = kNode.offset_; i < kNode.offset_ + kNode.object_count_; ++i) {
+          for (uint32_t rays_left = kHitMask; rays_left != 0; rays_left &= rays_left - 1) {
+            const int kRayIndex = __builtin_ctz(rays_left);
+            if (objects_[i]->intersect(packet.rays_[kRayIndex], min_t, packet.max_t_[kRayIndex],
+                packet.hit_records_[kRayIndex])) {
+              packet.max_t_[kRayIndex] = packet.hit_records_[kRayIndex].t_;
+              packet.was_hit_[kRayIndex] = true;
+            }
+          }
+        }
+      } else {
+        // the rays of a coherent packet agree on which child is nearer, so ask the first one
+        const ray& kFirstRay = packet.rays_[__builtin_ctz(kHitMask)];
+        assert(stack_size < kMaxTraversalStackSize);
+        ray_mask_stack[stack_size] = kHitMask;
+        ray_mask = kHitMask;
+        if (kFirstRay.direction()[kNode.split_axis_] < 0) {
+          node_stack[stack_size++] = node_index + 1;
+          node_index = kNode.offset_;
+        } else {
+          node_stack[stack_size++] = kNode.offset_;
+          node_index = node_index + 1;
+        }
+        continue;
+      }
+    }
+    if (stack_size == 0) {
+      break;
+    }
+    --stack_size;
+    node_index = node_stack[stack_size];
+    ray_mask = ray_mask_stack[stack_size];
+  }
+}
+
+bool bvh::boundingBox(real time0, real time1, aabb& output_box) const {
+  if (nodes_.empty()) {
+    return false;
+  }
+  output_box = nodes_[0].bounds_;
+  return true;
+}
+
+size_t bvh::nodeCount() const {
+  return nodes_.size();
+}
+
+double bvh::sahCost() const {
+  if (nodes_.empty()) {
+    return 0;
+  }
+  const double kRootArea = nodes_[0].bounds_.surfaceArea() > 0 ? nodes_[0].bounds_.surfaceArea() : 1.0;
+  double cost = 0;
+  for (const BvhNode& kNode : nodes_) {
+    const double kRelativeArea = kNode.bounds_.surfaceArea() / kRootArea;
+    if (kNode.isLeaf()) {
+      cost += kIntersectionCost * kNode.object_count_ * kRelativeArea;
+    } else {
+      cost += kTraversalCost * kRelativeArea;
+    }
+  }
+  return cost;
+}
+
+void bvh::refit(thread_pool& pool) {
+  if (!nodes_.empty()) {
+    refitSubtree(0, static_cast<uint32_t>(nodes_.size()), pool);
+  }
+}
+
+void bvh::refitSubtree(uint32_t node_index, uint32_t end_index, thread_pool& pool) {
+  BvhNode& node = nodes_[node_index];
+  if (node.isLeaf()) {
+    aabb bounds = aabb();
+    for (uint32_t i = node.offset_; i < node.offset_ + node.object_count_; ++i) {
+      aabb object_box;
+      if (objects_[i]->boundingBox(time0_, time1_, object_box)) {
+        bounds = surroundingBox(bounds, object_box);
+      }
+    }
+    node.bounds_ = bounds;
+    return;
+  }
+
+  // the left subtree is [node_index + 1, offset_) and the right subtree is [offset_, end_index)
+  const uint32_t kRightChildIndex = node.offset_;
+  if (end_index - node_index > kParallelRefitThreshold) {
+    pool.parallelFor(2, [&](size_t child) {
+      if (child == 0) {
+        refitSubtree(node_index + 1, kRightChildIndex, pool);
+      } else {
+        refitSubtree(kRightChildIndex, end_index, pool);
+      }
+    });
+  } else {
+    refitSubtree(node_index + 1, kRightChildIndex, pool);
+    refitSubtree(kRightChildIndex, end_index, pool);
+  }
+  node.bounds_ = surroundingBox(nodes_[node_index + 1].bounds_, nodes_[kRightChildIndex].bounds_);
+}
+
+double bvh::sahCostGrowth() const {
+  return built_sah_cost_ > 0 ? sahCost() / built_sah_cost_ : 1.0;
+}
+
+bool bvh::refitOrRebuild(double max_sah_cost_growth, thread_pool& pool) {
+  refit(pool);
+  if (sahCostGrowth() <= max_sah_cost_growth) {
+    return false;
+  }
+
+  hittable_list objects = hittable_list();
+  for (const std::shared_ptr<Hittable>& kObject : owned_objects_) {
+    objects.add(kObject);
+  }
+  if (build_settings_.builder_ == BvhBuilder::kSweepSah) {
+    *this = bvh(objects, time0_, time1_);
+  } else {
+    *this = bvh(objects, build_settings_, pool);
+  }
+  return true;
+}
+
+const std::vector<BvhNode>& bvh::nodes() const {
+  return nodes_;
+}
+
+const std::vector<const Hittable*>& bvh::leafObjects() const {
+  return objects_;
+}
+
+const std::vector<std::shared_ptr<Hittable>>& bvh::objects() const {
+  return owned_objects_;
+}
@@ -0,0 +1,478 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "aabb.h"
+#include "Hittable.h"
+#include "hittable_list.h"
+#include "morton.h"
+#include "real_lanes.h"
+#include "thread_pool.h"
+
+// past this depth the builders fall back to median splits so the tree depth stays bounded
+const size_t kMaxSahDepth = 32;
+
+// deepest level any node of a bvh can be at: kMaxSahDepth levels of SAH splits and then at most
+// 32 levels of median splits, which halve the (fewer than 2^32) objects at every level (linear
+// trees whose optimized treelets go deeper are rebuilt with median splits at kMaxSahDepth)
+const size_t kMaxBvhDepth = kMaxSahDepth + 32;
+
+// maximum number of nodes that can be waiting on the traversal stack (traversal pushes at most
+// one node for every level above the deepest one)
+const size_t kMaxTraversalStackSize = kMaxBvhDepth;
+
+/**
+ * Struct storing a single node of a flattened bounding volume hierarchy
+ *
+ * Nodes are laid out depth first, so the left child of an interior node is always
+ * the node directly after it in the node array
+ */
+struct BvhNode {
+  // aabb bounding everything below this node
+  aabb bounds_;
+
+  // for interior nodes, the index of the right child
+  // for leaf nodes, the index of the first object in the leaf
+  uint32_t offset_;
+
+  // number of objects in the leaf (0 for interior nodes)
+  uint32_t object_count_;
+
+  // axis (0 = x, 1 = y, 2 = z) that the children of an interior node were split along
+  uint32_t split_axis_;
+
+  /**
+   * Returns true if the node is a leaf node
+   *
+   * @return true if the node stores objects and false if it is an interior node
+   */
+  inline bool isLeaf() const {
+    return object_count_ > 0;
+  }
+};
+
+/**
+ * Enum of the algorithms a bvh can be built with
+ */
+enum class BvhBuilder {
+  // tries a split between every pair of neighboring objects along every axis (the best trees,
+  // but the slowest single threaded builds)
+  kSweepSah,
+  // tries a split between every pair of neighboring bins along every axis, binning and
+  // building subtrees on a thread pool (slightly worse trees, much faster builds)
+  kBinnedSah,
+  // sorts the objects along a Morton (Z-order) curve with a parallel radix sort and splits
+  // every range where the highest differing bit of its codes changes (the fastest builds, but
+  // the worst trees unless their treelets are optimized)
+  kLinear
+};
+
+/**
+ * Struct storing the settings that a bvh is built with
+ */
+struct BvhBuildSettings {
+  // algorithm to build the hierarchy with
+  BvhBuilder builder_;
+
+  // number of bits in the Morton codes that kLinear sorts the objects by (30 or 63)
+  int morton_code_bits_;
+
+  // true to give every treelet (subtree of up to kTreeletLeafCount leaves) of a kLinear tree
+  // the topology with the lowest SAH cost, which recovers most of the quality of a SAH build
+  bool optimize_treelets_;
+};
+
+/**
+ * Class representing a bounding volume hierarchy over a set of hittable objects
+ *
+ * The hierarchy is built top down using the surface area heuristic (SAH) and can be
+ * used anywhere a hittable_list is, with a per-ray cost that is logarithmic rather than
+ * linear in the number of objects
+ */
+class bvh : public Hittable {
+  public:
+    /**
+     * Default Constructor (makes an empty hierarchy that is never hit)
+     */
+    bvh() {}
+
+    /**
+     * Constructor that builds a hierarchy over all of the objects in the given list
+     *
+     * @param kObjects constant reference to the list of objects to build the hierarchy over
+     * @throws std::invalid_argument if an object in the list has no bounding box
+     */
+    explicit bvh(const hittable_list& kObjects);
+
+    /**
+     * Constructor that builds a hierarchy over all of the objects in the given list, with
+     * boxes that bound the objects over the given interval of time
+     *
+     * @param kObjects constant reference to the list of objects to build the hierarchy over
+     * @param time0 real representing the start of the time interval the hierarchy covers
+     * @param time1 real representing the end of the time interval the hierarchy covers
+     * @throws std::invalid_argument if an object in the list has no bounding box
+     */
+    bvh(const hittable_list& kObjects, real time0, real time1);
+
+    /**
+     * Constructor that builds a hierarchy over all of the objects in the given list with the
+     * given settings, running the parallel parts of the build on the given pool
+     *
+     * @param kObjects constant reference to the list of objects to build the hierarchy over
+     * @param kSettings constant reference to the settings to build the hierarchy with
+     * @param pool reference to the thread pool to build the hierarchy on
+     * @throws std::invalid_argument if an object in the list has no bounding box or the
+     *     settings ask for Morton codes with other than 30 or 63 bits
+     */
+    bvh(const hittable_list& kObjects, const BvhBuildSettings& kSettings, thread_pool& pool);
+
+    /**
+     * Returns true if any of the objects in the hierarchy are hit by the given ray
+     * Updates the t value and hit object of the hit record with the closest intersection 
+     * (does nothing if no hits)
+     *
+     * @param kRay constant reference to the ray to check if it hits a
+     *     hittable object in the hierarchy
+     * @param min_t real representing the minimum t value for the intersection
+     * @param max_t real representing the maximum t value for the intersection
+     * @param hit_record reference to a hit record to update with the details of the
+     *     intersection of the ray and the closest hit object (not updated if no
+     *     objects in the hierarchy are hit within the acceptable t value range)
+     * @return true if a hittable object in the hierarchy was hit by the given ray in the
+     *     given range of values for t and false otherwise
+     */
+    virtual bool intersect(const ray& kRay, real min_t, real max_t,
+        HitRecord& hit_record) const override;
+
+    /**
+     * Returns true if any of the objects in the hierarchy are hit by the given ray, stopping at
+     * the first object found to be hit
+     *
+     * @param kRay constant reference to the ray to check if it hits a
+     *     hittable object in the hierarchy
+     * @param min_t real representing the minimum t value for the intersection
+     * @param max_t real representing the maximum t value for the intersection
+     * @return true if a hittable object in the hierarchy was hit by the given ray in the
+     *     given range of values for t and false otherwise
+     */
+    virtual bool isOccluded(const ray& kRay, real min_t, real max_t) const override;
+
+    /**
+     * Finds the closest hit of every ray of the given packet with one traversal shared by the
+     * whole packet
+     *
+     * Every node is tested against all of the rays of the packet at once (kRealLaneCount rays per
+     * RealLanes), and is entered if any of them hits its box. Only the rays that hit the box of a
+     * leaf are tested against its objects, and every box test rounds exactly like the single ray
+     * one, so every ray finds the same closest hit as intersect would. The nearer child is
+     * visited first for the first ray that hit the node, which suits coherent packets
+     *
+     * @param packet reference to the packet of rays to check
+     * @param min_t real representing the minimum t value for the intersections
+     */
+    virtual void intersectPacket(RayPacket& packet, real min_t) const override;
+
+    // see hittable docs
+    virtual bool boundingBox(real time0, real time1, aabb& output_box) const override;
+
+    /**
+     * Returns the number of nodes in the hierarchy
+     *
+     * @return a size_t representing the number of nodes in the hierarchy
+     */
+    size_t nodeCount() const;
+
+    /**
+     * Returns the expected cost of tracing a ray through the hierarchy according to the
+     * surface area heuristic (lower is better)
+     *
+     * @return a double representing the SAH cost of the hierarchy
+     */
+    double sahCost() const;
+
+    /**
+     * Refits the box of every node to the current boxes of the objects below it, bottom up,
+     * without changing the topology of the hierarchy, refitting large subtrees on the given
+     * pool (call it after objects of the hierarchy have moved)
+     *
+     * @param pool reference to the thread pool to refit the hierarchy on
+     */
+    void refit(thread_pool& pool);
+
+    /**
+     * Returns how much the SAH cost of the hierarchy has grown since it was last built, which
+     * refitting it around objects that move apart does
+     *
+     * @return a double representing the SAH cost divided by the SAH cost right after the last
+     *     build (1 for an empty hierarchy)
+     */
+    double sahCostGrowth() const;
+
+    /**
+     * Refits the hierarchy, then rebuilds it with the settings it was last built with if its
+     * SAH cost has grown by more than the given factor since that build
+     *
+     * @param max_sah_cost_growth the largest SAH cost growth (see sahCostGrowth) to keep a
+     *     refit hierarchy at
+     * @param pool reference to the thread pool to refit or rebuild the hierarchy on
+     * @return true if the hierarchy was rebuilt and false if it was only refit
+     */
+    bool refitOrRebuild(double max_sah_cost_growth, thread_pool& pool);
+
+    /**
+     * Returns the nodes of the hierarchy
+     *
+     * @return a constant reference to the vector of nodes in depth first order (root at index 0)
+     */
+    const std::vector<BvhNode>& nodes() const;
+
+    /**
+     * Returns the objects of the hierarchy in the order the leaf nodes refer to them
+     *
+     * @return a constant reference to the vector of raw pointers to the objects in leaf order
+     */
+    const std::vector<const Hittable*>& leafObjects() const;
+
+    /**
+     * Returns the objects of the hierarchy in the order of the list it was built from
+     *
+     * @return a constant reference to the vector of shared pointers to the objects
+     */
+    const std::vector<std::shared_ptr<Hittable>>& objects() const;
+
+  private:
+    /**
+     * Struct storing the data about an object that the builder needs
+     */
+    struct BuildObject {
+      // index of the object in the list that the hierarchy is being built from
+      size_t object_index_;
+      // aabb bounding the object
+      aabb bounds_;
+      // center of the bounding box of the object
+      point3 centroid_;
+    };
+
+    /**
+     * Recursively builds the hierarchy over build_objects in [begin, end), appending
+     * the nodes to nodes_ in depth first order
+     *
+     * @param build_objects reference to the vector of objects being built over (reordered
+     *     so that the objects of every leaf are contiguous)
+     * @param begin the index of the first object in the range to build over
+     * @param end one past the index of the last object in the range to build over
+     * @param depth the depth of the subtree's root in the hierarchy
+     * @return the index in nodes_ of the root of the built subtree
+     */
+    uint32_t build(std::vector<BuildObject>& build_objects, size_t begin, size_t end, 
+        size_t depth);
+
+    /**
+     * Struct storing the objects that fall into one bin of the binned SAH builder
+     */
+    struct SahBin {
+      // aabb bounding the objects in the bin
+      aabb bounds_;
+      // number of objects in the bin
+      size_t object_count_;
+    };
+
+    /**
+     * Computes the box and the centroid of the box of every object in the given list over the
+     * given interval of time, in list order
+     *
+     * @param kObjects constant reference to the list of objects to bound
+     * @param time0 real representing the start of the time interval to bound the objects over
+     * @param time1 real representing the end of the time interval to bound the objects over
+     * @param pool pointer to the thread pool to bound the objects on (nullptr bounds them on the
+     *     calling thread)
+     * @return a vector of the BuildObjects of the objects in the list
+     * @throws std::invalid_argument if an object in the list has no bounding box
+     */
+    static std::vector<BuildObject> boundObjects(const hittable_list& kObjects, real time0, 
+        real time1, thread_pool* pool);
+
+    /**
+     * Recursively builds the hierarchy over build_objects in [begin, end) with binned SAH
+     * splits, splitting large ranges across the threads of the given pool
+     *
+     * The subtree over n objects is written to sparse_nodes at [node_index, node_index + 2n - 1)
+     * in depth first order: the left child directly after its parent and the right child 
+     * after the 2m - 1 slots reserved for the left subtree over m objects, so both subtrees can
+     * be built at once. Leaves with several objects leave some slots unused
+     *
+     * @param build_objects reference to the vector of objects being built over (reordered
+     *     so that the objects of every leaf are contiguous)
+     * @param begin the index of the first object in the range to build over
+     * @param end one past the index of the last object in the range to build over
+     * @param depth the depth of the subtree's root in the hierarchy
+     * @param node_index the index in sparse_nodes to write the root of the subtree to
+     * @param sparse_nodes reference to the vector of nodes to write the subtree to
+     * @param pool reference to the thread pool to build large ranges on
+     */
+    void buildBinned(std::vector<BuildObject>& build_objects, size_t begin, size_t end,
+        size_t depth, uint32_t node_index, std::vector<BvhNode>& sparse_nodes, thread_pool& pool);
+
+    /**
+     * Recursively copies the subtree of sparse_nodes with the given root to the end of nodes_,
+     * skipping the unused slots
+     *
+     * @param kSparseNodes constant reference to the nodes written by buildBinned
+     * @param sparse_node_index the index in kSparseNodes of the root of the subtree to copy
+     * @return the index in nodes_ of the root of the copied subtree
+     */
+    uint32_t compactNodes(const std::vector<BvhNode>& kSparseNodes, uint32_t sparse_node_index);
+
+    /**
+     * Struct storing a node of the intermediate tree built by the linear builder
+     *
+     * For n objects, interior nodes are at [0, n - 1) (the root at 0) and the leaf of the i-th
+     * object in Morton order is at n - 1 + i. Children are referred to by index, so treelets
+     * can be restructured in place before the tree is laid out depth first
+     */
+    struct LinearNode {
+      // aabb bounding everything below this node
+      aabb bounds_;
+      // indices of the left and right children (unused for leaves)
+      uint32_t children_[2];
+      // index of the object of a leaf, in Morton order (unused for interior nodes)
+      uint32_t object_index_;
+      // number of objects below this node (1 for leaves and at least 2 for interior nodes)
+      uint32_t object_count_;
+      // SAH cost of the subtree, not yet divided by the surface area of the root
+      double cost_;
+    };
+
+    /**
+     * Builds the hierarchy with the linear builder
+     *
+     * @param build_objects reference to the vector of objects to build over (reordered into the
+     *     order of the leaves)
+     * @param kSettings constant reference to the settings to build the hierarchy with
+     * @param pool reference to the thread pool to build the hierarchy on
+     */
+    void buildLinear(std::vector<BuildObject>& build_objects, const BvhBuildSettings& kSettings,
+        thread_pool& pool);
+
+    /**
+     * Recursively builds the interior nodes of the linear builder's tree over the objects in
+     * Morton order in [first, last], splitting large ranges across the threads of the pool
+     *
+     * @param kPrimitives constant reference to the Morton codes of the objects, in sorted order
+     * @param first the index of the first object in the range
+     * @param last the index of the last object in the range
+     * @param node_index the index of the node of the range (the index of first or of last)
+     * @param depth the depth of the node in the tree
+     * @param linear_nodes reference to the nodes of the tree, with the leaves already filled in
+     * @param pool reference to the thread pool to build large ranges on
+     */
+    static void buildRadixTree(const std::vector<MortonPrimitive>& kPrimitives, size_t first,
+        size_t last, uint32_t node_index, size_t depth, std::vector<LinearNode>& linear_nodes,
+        thread_pool& pool);
+
+    /**
+     * Optimizes the treelet at every interior node of the given subtree, children before
+     * parents, optimizing large subtrees across the threads of the pool
+     *
+     * @param linear_nodes reference to the nodes of the linear builder's tree
+     * @param node_index the index of the root of the subtree to optimize
+     * @param pool reference to the thread pool to optimize large subtrees on
+     */
+    static void optimizeTreelets(std::vector<LinearNode>& linear_nodes, uint32_t node_index,
+        thread_pool& pool);
+
+    /**
+     * Gives the treelet at the given node (the node and the descendants found by repeatedly
+     * opening the largest of up to kTreeletLeafCount leaves) the topology with the lowest SAH
+     * cost, found by dynamic programming over every subset of its leaves
+     *
+     * @param linear_nodes reference to the nodes of the linear builder's tree
+     * @param root_index the index of the root of the treelet
+     */
+    static void optimizeTreelet(std::vector<LinearNode>& linear_nodes, uint32_t root_index);
+
+    /**
+     * Returns the number of levels below the root of the given subtree of the linear builder's
+     * tree
+     *
+     * @param kLinearNodes constant reference to the nodes of the linear builder's tree
+     * @param node_index the index in kLinearNodes of the root of the subtree
+     * @return the depth of the deepest leaf of the subtree, counted from its root (0 for a leaf)
+     */
+    static size_t linearTreeHeight(const std::vector<LinearNode>& kLinearNodes,
+        uint32_t node_index);
+
+    /**
+     * Recursively lays the given subtree of the linear builder's tree out depth first at the
+     * end of nodes_, turning small subtrees into leaves where that lowers their SAH cost
+     *
+     * Subtrees at kMaxSahDepth that are themselves more than kMaxSahDepth deep (which optimizing
+     * treelets can cause) are rebuilt with median splits instead, so the tree stays within
+     * kMaxBvhDepth
+     *
+     * @param kLinearNodes constant reference to the nodes of the linear builder's tree
+     * @param node_index the index in kLinearNodes of the root of the subtree
+     * @param depth the depth of the subtree's root in the hierarchy
+     * @param kSortedObjects constant reference to the objects in Morton order
+     * @param leaf_objects reference to the vector to add the objects of every leaf to
+     * @return the index in nodes_ of the root of the laid out subtree
+     */
+    uint32_t layOutLinearTree(const std::vector<LinearNode>& kLinearNodes, uint32_t node_index,
+        size_t depth, const std::vector<BuildObject>& kSortedObjects,
+        std::vector<BuildObject>& leaf_objects);
+
+    /**
+     * Recursively refits the subtree with the given root, refitting the subtrees of large
+     * subtrees at once on the given pool
+     *
+     * @param node_index the index in nodes_ of the root of the subtree
+     * @param end_index one past the index in nodes_ of the last node of the subtree
+     * @param pool reference to the thread pool to refit large subtrees on
+     */
+    void refitSubtree(uint32_t node_index, uint32_t end_index, thread_pool& pool);
+
+    /**
+     * Finds the closest hit of the given ray with the objects below the given node, with the 
+     * same traversal as intersect (see intersect)
+     *
+     * @param kRay constant reference to the ray to check
+     * @param root_index the index in nodes_ of the root of the subtree to check
+     * @param min_t real representing the minimum t value for the intersection
+     * @param max_t real representing the maximum t value for the intersection
+     * @param hit_record reference to a hit record to update with the closest intersection
+     * @return true if an object below the node was hit in the given range of values for t and 
+     *     false otherwise
+     */
+    bool intersectSubtree(const ray& kRay, uint32_t root_index, real min_t, real max_t, 
+        HitRecord& hit_record) const;
+
+    /**
+     * Stores the objects of the given list in the order of the given build objects
+     *
+     * @param kObjects constant reference to the list the hierarchy was built from
+     * @param kBuildObjects constant reference to the build objects in leaf order
+     */
+    void storeObjects(const hittable_list& kObjects, const std::vector<BuildObject>& kBuildObjects);
+
+    // vector storing the nodes of the hierarchy in depth first order (root at index 0)
+    std::vector<BvhNode> nodes_;
+
+    // vector of raw pointers to the objects of the hierarchy in leaf order, used by traversal
+    std::vector<const Hittable*> objects_;
+
+    // vector of shared pointers that keep the objects of the hierarchy alive
+    std::vector<std::shared_ptr<Hittable>> owned_objects_;
+
+    // settings the hierarchy was last built with, which refitOrRebuild rebuilds it with
+    BvhBuildSettings build_settings_ = BvhBuildSettings{BvhBuilder::kSweepSah, 63, false};
+
+    // interval of time that the boxes of the hierarchy bound the objects over
+    real time0_ = 0;
+    real time1_ = 0;
+
+    // SAH cost of the hierarchy right after it was last built
+    double built_sah_cost_ = 0;
+};
@@ -1,10 +1,10 @@
 #include "camera.h"
 
 camera::camera() {
-  const double kAspectRatio = 16.0 / 9.0;
-  const double kViewportHeight = 2.0;
-  const double kViewportWidth = kAspectRatio * kViewportHeight;
-  const double kFocalLength = 1.0;
+  const real kAspectRatio = 16.0 / 9.0;
+  const real kViewportHeight = 2.0;
+  const real kViewportWidth = kAspectRatio * kViewportHeight;
+  const real kFocalLength = 1.0;
 
   origin_ = point3(); // point3 defaults to be the zero vector
   horizontal_direction_ = vec3(kViewportWidth, 0, 0);
@@ -13,7 +13,7 @@ camera::camera() {
     - vec3(0, 0, kFocalLength);
 }
 
-ray camera::getRay(double horizontal_factor, double vertical_factor) const {
+ray camera::getRay(real horizontal_factor, real vertical_factor) const {
   // direction of ray from the origin to the pixel corresponding to the given vertical and 
   // horizontal shifts in the viewport
   const vec3 kRayDirection = lower_left_corner_ + (horizontal_direction_ * horizontal_factor) 
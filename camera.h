@@ -24,7 +24,7 @@ class camera {
      * @return ray representing the ray from the camera to the pixel in the viewport
      *     corresponding to the given horizontal and vertical shifts from the origin
      */
-    ray getRay(double horizontal_factor, double vertical_factor) const;
+    ray getRay(real horizontal_factor, real vertical_factor) const;
 
   private:
     // point3 representing the location of the camera
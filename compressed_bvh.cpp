@@ -0,0 +1,356 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "compressed_bvh.h"
+
+// largest quantized value of a plane (planes are stored in steps of 1/kQuantizedMaximum of the
+// extent of the parent box)
+const int kQuantizedMaximum = 255;
+
+/**
+ * Struct storing an interior child of a compressed_bvh node that is waiting to be visited
+ */
+struct CompressedBvhStackEntry {
+  // index of the child node
+  uint32_t node_index_;
+  // t value at which the ray enters the box of the child
+  real entry_t_;
+  // decoded minimum and maximum x, y, and z of the box of the child, which its own children
+  // are decoded relative to
+  real minimum_[3];
+  real maximum_[3];
+};
+
+/**
+ * Returns the size of a quantization step of a box with the given minimum and maximum along an
+ * axis
+ *
+ * @param minimum the minimum of the box along the axis
+ * @param maximum the maximum of the box along the axis
+ * @return a real representing 1/kQuantizedMaximum of the extent of the box along the axis
+ */
+static inline real quantizationStep(real minimum, real maximum) {
+  return (maximum - minimum) * (real(1) / kQuantizedMaximum);
+}
+
+/**
+ * Decodes the box of the given child of the given node relative to the given box of the node
+ * (every decoded box in the hierarchy goes through this function, so the boxes the children
+ * were quantized against are exactly the ones traversal decodes)
+ *
+ * @param kNode constant reference to the node
+ * @param slot the child (0 or 1) whose box to decode
+ * @param kMinimum the decoded minimum x, y, and z of the box of the node
+ * @param kMaximum the decoded maximum x, y, and z of the box of the node
+ * @param kSteps the quantization step of the box of the node along every axis
+ * @param child_minimum array to update with the minimum x, y, and z of the box of the child
+ * @param child_maximum array to update with the maximum x, y, and z of the box of the child
+ */
+static inline void decodeChildBounds(const CompressedBvhNode& kNode, int slot,
+    const real kMinimum[3], const real kMaximum[3], const real kSteps[3], real child_minimum[3],
+    real child_maximum[3]) {
+  for (int axis = 0; axis < 3; ++axis) {
+    child_minimum[axis] = kMinimum[axis] + (kNode.child_minimums_[slot][axis] * kSteps[axis]);
+    child_maximum[axis] = kMaximum[axis]
+        - ((kQuantizedMaximum - kNode.child_maximums_[slot][axis]) * kSteps[axis]);
+  }
+}
+
+/**
+ * Quantizes the given minimum plane of a child relative to the given box of its parent,
+ * rounding down so the decoded plane is never above the exact one
+ *
+ * @param exact the exact minimum of the child along the axis
+ * @param minimum the decoded minimum of the parent along the axis
+ * @param maximum the decoded maximum of the parent along the axis
+ * @return the largest quantized value that decodes to at most exact
+ */
+static uint8_t quantizeMinimum(real exact, real minimum, real maximum) {
+  const real kStep = quantizationStep(minimum, maximum);
+  if (!(kStep > 0)) {
+    return 0;
+  }
+  int quantized = static_cast<int>(std::min(std::max(std::floor((exact - minimum) / kStep),
+      real(0)), real(kQuantizedMaximum)));
+  // rounding of the division can land a step too high, which decoding would not contain
+  while (quantized > 0 && minimum + (quantized * kStep) > exact) {
+    --quantized;
+  }
+  return static_cast<uint8_t>(quantized);
+}
+
+/**
+ * Quantizes the given maximum plane of a child relative to the given box of its parent,
+ * rounding up so the decoded plane is never below the exact one
+ *
+ * @param exact the exact maximum of the child along the axis
+ * @param minimum the decoded minimum of the parent along the axis
+ * @param maximum the decoded maximum of the parent along the axis
+ * @return the smallest quantized value that decodes to at least exact
+ */
+static uint8_t quantizeMaximum(real exact, real minimum, real maximum) {
+  const real kStep = quantizationStep(minimum, maximum);
+  if (!(kStep > 0)) {
+    return kQuantizedMaximum;
+  }
+  int quantized = kQuantizedMaximum - static_cast<int>(std::min(std::max(
+      std::floor((maximum - exact) / kStep), real(0)), real(kQuantizedMaximum)));
+  while (quantized < kQuantizedMaximum
+      && maximum - ((kQuantizedMaximum - quantized) * kStep) < exact) {
+    ++quantized;
+  }
+  return static_cast<uint8_t>(quantized);
+}
+
+compressed_bvh::compressed_bvh(const hittable_list& kObjects)
+    : compressed_bvh(bvh(kObjects)) {}
+
+compressed_bvh::compressed_bvh(const bvh& kHierarchy) {
+  const std::vector<BvhNode>& kBinaryNodes = kHierarchy.nodes();
+  if (kBinaryNodes.empty()) {
+    return;
+  }
+
+  // only interior nodes are stored, and a binary tree has one fewer of them than leaves
+  nodes_.reserve(std::max(kBinaryNodes.size() / 2, size_t(1)));
+  bounds_ = kBinaryNodes[0].bounds_;
+  const real kMinimum[3] = {bounds_.minimum().x(), bounds_.minimum().y(), bounds_.minimum().z()};
+  const real kMaximum[3] = {bounds_.maximum().x(), bounds_.maximum().y(), bounds_.maximum().z()};
+  compress(kBinaryNodes, 0, kMinimum, kMaximum);
+
+  // leaf offsets are copied unchanged, so the objects stay in the binary tree's leaf order
+  objects_ = kHierarchy.leafObjects();
+  owned_objects_ = kHierarchy.objects();
+}
+
+uint32_t compressed_bvh::compress(const std::vector<BvhNode>& kBinaryNodes,
+    uint32_t binary_node_index, const real kDecodedMinimum[3], const real kDecodedMaximum[3]) {
+  // the children of the binary node (or the node itself if the whole tree is one leaf)
+  uint32_t children[2];
+  int child_count = 0;
+  const BvhNode& kBinaryNode = kBinaryNodes[binary_node_index];
+  if (kBinaryNode.isLeaf()) {
+    children[child_count++] = binary_node_index;
+  } else {
+    children[child_count++] = binary_node_index + 1;
+    children[child_count++] = kBinaryNode.offset_;
+  }
+
+  const uint32_t kNodeIndex = static_cast<uint32_t>(nodes_.size());
+  nodes_.push_back(CompressedBvhNode());
+  CompressedBvhNode& node = nodes_[kNodeIndex];
+  node.child_count_ = static_cast<uint8_t>(child_count);
+  node.split_axis_ = static_cast<uint8_t>(kBinaryNode.isLeaf() ? 0 : kBinaryNode.split_axis_);
+  real steps[3];
+  for (int axis = 0; axis < 3; ++axis) {
+    steps[axis] = quantizationStep(kDecodedMinimum[axis], kDecodedMaximum[axis]);
+  }
+  for (int slot = 0; slot < child_count; ++slot) {
+    const aabb& kChildBounds = kBinaryNodes[children[slot]].bounds_;
+    for (int axis = 0; axis < 3; ++axis) {
+      node.child_minimums_[slot][axis] = quantizeMinimum(kChildBounds.minimum()[axis],
+          kDecodedMinimum[axis], kDecodedMaximum[axis]);
+      node.child_maximums_[slot][axis] = quantizeMaximum(kChildBounds.maximum()[axis],
+          kDecodedMinimum[axis], kDecodedMaximum[axis]);
+    }
+  }
+
+  for (int slot = 0; slot < child_count; ++slot) {
+    const BvhNode& kChild = kBinaryNodes[children[slot]];
+    // compressing the child can grow nodes_, so node is not used past this point
+    uint32_t offset = kChild.offset_;
+    if (!kChild.isLeaf()) {
+      real child_minimum[3];
+      real child_maximum[3];
+      decodeChildBounds(nodes_[kNodeIndex], slot, kDecodedMinimum, kDecodedMaximum, steps,
+          child_minimum, child_maximum);
+      offset = compress(kBinaryNodes, children[slot], child_minimum, child_maximum);
+    }
+    CompressedBvhNode& parent = nodes_[kNodeIndex];
+    parent.child_offsets_[slot] = offset;
+    parent.child_object_counts_[slot] = kChild.object_count_;
+  }
+  return kNodeIndex;
+}
+
+bool compressed_bvh::intersect(const ray& kRay, real min_t, real max_t,
+    HitRecord& hit_record) const {
+  const point3 kOrigin = kRay.origin();
+  const vec3 kDirection = kRay.direction();
+  const vec3 kInverseDirection = inverseDirection(kDirection);
+  if (nodes_.empty() || !bounds_.wasHit(kOrigin, kInverseDirection, min_t, max_t)) {
+    return false;
+  }
+
+  const real kOrigins[3] = {kOrigin.x(), kOrigin.y(), kOrigin.z()};
+  const real kInverseDirections[3] =
+      {kInverseDirection.x(), kInverseDirection.y(), kInverseDirection.z()};
+  CompressedBvhStackEntry stack[kMaxTraversalStackSize];
+  size_t stack_size = 0;
+  // the node being visited, with the box its children are decoded relative to
+  CompressedBvhStackEntry node = CompressedBvhStackEntry();
+  for (int axis = 0; axis < 3; ++axis) {
+    node.minimum_[axis] = bounds_.minimum()[axis];
+    node.maximum_[axis] = bounds_.maximum()[axis];
+  }
+  bool has_hit_anything = false;
+  real closest_t_value = max_t;
+
+  while (true) {
+    const CompressedBvhNode& kNode = nodes_[node.node_index_];
+    real steps[3];
+    for (int axis = 0; axis < 3; ++axis) {
+      steps[axis] = quantizationStep(node.minimum_[axis], node.maximum_[axis]);
+    }
+    // visit the child nearer to the ray origin first so farther subtrees can be culled by the
+    // closest hit found so far
+    const int kNearSlot = kDirection[kNode.split_axis_] < 0 ? 1 : 0;
+    CompressedBvhStackEntry next_node = CompressedBvhStackEntry();
+    bool has_next_node = false;
+    for (int i = 0; i < kNode.child_count_; ++i) {
+      const int kSlot = kNode.child_count_ == 1 ? 0 : kNearSlot ^ i;
+      real child_minimum[3];
+      real child_maximum[3];
+      decodeChildBounds(kNode, kSlot, node.minimum_, node.maximum_, steps, child_minimum,
+          child_maximum);
+      // the same slab test as aabb::wasHit, keeping the entry t value for the stack
+      real entry_t = min_t;
+      real exit_t = closest_t_value;
+      for (int axis = 0; axis < 3; ++axis) {
+        const real kT0 = (child_minimum[axis] - kOrigins[axis]) * kInverseDirections[axis];
+        const real kT1 = (child_maximum[axis] - kOrigins[axis]) * kInverseDirections[axis];
+        const bool kNegative = kInverseDirections[axis] < 0;
+        const real kNear = kNegative ? kT1 : kT0;
+        const real kFar = kNegative ? kT0 : kT1;
+        entry_t = kNear > entry_t ? kNear : entry_t;
+        exit_t = kFar < exit_t ? kFar : exit_t;
+      }
+      if (!(entry_t <= exit_t)) {
+        continue;
+      }
+
+      const uint32_t kOffset = kNode.child_offsets_[kSlot];
+      const uint32_t kObjectCount = kNode.child_object_counts_[kSlot];
+      if (kObjectCount > 0) {
+        for (uint32_t j = kOffset; j < kOffset + kObjectCount; ++j) {
+          if (objects_[j]->intersect(kRay, min_t, closest_t_value, hit_record)) {
+            closest_t_value = hit_record.t_;
+            has_hit_anything = true;
+          }
+        }
+        continue;
+      }
+      // the nearer interior child is visited next and the farther one waits on the stack
+      assert(!has_next_node || stack_size < kMaxTraversalStackSize);
+      CompressedBvhStackEntry& child = has_next_node ? stack[stack_size++] : next_node;
+      child.node_index_ = kOffset;
+      child.entry_t_ = entry_t;
+      for (int axis = 0; axis < 3; ++axis) {
+        child.minimum_[axis] = child_minimum[axis];
+        child.maximum_[axis] = child_maximum[axis];
+      }
+      has_next_node = true;
+    }
+    if (has_next_node) {
+      node = next_node;
+      continue;
+    }
+
+    // skip waiting children that start past the closest hit found since they were pushed
+    while (stack_size > 0 && stack[stack_size - 1].entry_t_ > closest_t_value) {
+      --stack_size;
+    }
+    if (stack_size == 0) {
+      break;
+    }
+    node = stack[--stack_size];
+  }
+  return has_hit_anything;
+}
+
+bool compressed_bvh::isOccluded(const ray& kRay, real min_t, real max_t) const {
+  const point3 kOrigin = kRay.origin();
+  const vec3 kInverseDirection = inverseDirection(kRay.direction());
+  if (nodes_.empty() || !bounds_.wasHit(kOrigin, kInverseDirection, min_t, max_t)) {
+    return false;
+  }
+
+  const real kOrigins[3] = {kOrigin.x(), kOrigin.y(), kOrigin.z()};
+  const real kInverseDirections[3] =
+      {kInverseDirection.x(), kInverseDirection.y(), kInverseDirection.z()};
+  // without a closest hit to cull by, every hit interior child is pushed in slot order
+  CompressedBvhStackEntry stack[kMaxTraversalStackSize];
+  size_t stack_size = 0;
+  CompressedBvhStackEntry& root = stack[stack_size++];
+  root = CompressedBvhStackEntry();
+  for (int axis = 0; axis < 3; ++axis) {
+    root.minimum_[axis] = bounds_.minimum()[axis];
+    root.maximum_[axis] = bounds_.maximum()[axis];
+  }
+
+  while (stack_size > 0) {
+    const CompressedBvhStackEntry kEntry = stack[--stack_size];
+    const CompressedBvhNode& kNode = nodes_[kEntry.node_index_];
+    real steps[3];
+    for (int axis = 0; axis < 3; ++axis) {
+      steps[axis] = quantizationStep(kEntry.minimum_[axis], kEntry.maximum_[axis]);
+    }
+    for (int slot = 0; slot < kNode.child_count_; ++slot) {
+      real child_minimum[3];
+      real child_maximum[3];
+      decodeChildBounds(kNode, slot, kEntry.minimum_, kEntry.maximum_, steps, child_minimum,
+          child_maximum);
+      real entry_t = min_t;
+      real exit_t = max_t;
+      for (int axis = 0; axis < 3; ++axis) {
+        const real kT0 = (child_minimum[axis] - kOrigins[axis]) * kInverseDirections[axis];
+        const real kT1 = (child_maximum[axis] - kOrigins[axis]) * kInverseDirections[axis];
+        const bool kNegative = kInverseDirections[axis] < 0;
+        const real kNear = kNegative ? kT1 : kT0;
+        const real kFar = kNegative ? kT0 : kT1;
+        entry_t = kNear > entry_t ? kNear : entry_t;
+        exit_t = kFar < exit_t ? kFar : exit_t;
+      }
+      if (!(entry_t <= exit_t)) {
+        continue;
+      }
+
+      const uint32_t kOffset = kNode.child_offsets_[slot];
+      const uint32_t kObjectCount = kNode.child_object_counts_[slot];
+      if (kObjectCount > 0) {
+        for (uint32_t j = kOffset; j < kOffset + kObjectCount; ++j) {
+          if (objects_[j]->isOccluded(kRay, min_t, max_t)) {
+            return true;
+          }
+        }
+        continue;
+      }
+      assert(stack_size < kMaxTraversalStackSize);
+      CompressedBvhStackEntry& child = stack[stack_size++];
+      child.node_index_ = kOffset;
+      child.entry_t_ = entry_t;
+      for (int axis = 0; axis < 3; ++axis) {
+        child.minimum_[axis] = child_minimum[axis];
+        child.maximum_[axis] = child_maximum[axis];
+      }
+    }
+  }
+  return false;
+}
+
+bool compressed_bvh::boundingBox(real time0, real time1, aabb& output_box) const {
+  if (nodes_.empty()) {
+    return false;
+  }
+  output_box = bounds_;
+  return true;
+}
+
+size_t compressed_bvh::nodeCount() const {
+  return nodes_.size();
+}
+
+size_t compressed_bvh::nodeBytes() const {
+  return nodes_.size() * sizeof(CompressedBvhNode);
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "aabb.h"
+#include "bvh.h"
+#include "Hittable.h"
+#include "hittable_list.h"
+
+/**
+ * Struct storing a single node of a compressed bounding volume hierarchy in 32 bytes
+ *
+ * A node stores the boxes of its (up to 2) children quantized to 8 bits per plane relative to
+ * its own box, which the traversal decoded from the node's parent. Minimum planes are stored as
+ * steps of 1/255 of the node's extent up from its minimum, and maximum planes as steps down from
+ * its maximum, so a decoded child box always contains the child's exact box
+ */
+struct CompressedBvhNode {
+  // quantized minimum x, y, and z of the box of every child
+  uint8_t child_minimums_[2][3];
+
+  // quantized maximum x, y, and z of the box of every child
+  uint8_t child_maximums_[2][3];
+
+  // for interior children, the index of the child node
+  // for leaf children, the index of the first object in the leaf
+  uint32_t child_offsets_[2];
+
+  // number of objects in every leaf child (0 for interior children)
+  uint32_t child_object_counts_[2];
+
+  // number of children in use (1 only for the root of a hierarchy that is a single leaf)
+  uint8_t child_count_;
+
+  // axis (0 = x, 1 = y, 2 = z) that the children were split along
+  uint8_t split_axis_;
+};
+
+static_assert(sizeof(CompressedBvhNode) == 32, "CompressedBvhNode must be 32 bytes");
+
+/**
+ * Class representing a bounding volume hierarchy with quantized, 32-byte nodes
+ *
+ * The hierarchy is made from a binary bvh: every interior node of it becomes one compressed
+ * node holding the boxes of its two children, so the nodes take about a quarter of the memory
+ * of the bvh's (half as many nodes, each half the size or less). Traversal decodes the boxes of
+ * the children of every node it visits, trading a few multiplies for memory bandwidth. Decoded
+ * boxes are only ever larger than the exact ones, so it finds the same closest hits as the bvh
+ * it was made from
+ */
+class compressed_bvh : public Hittable {
+  public:
+    /**
+     * Default Constructor (makes an empty hierarchy that is never hit)
+     */
+    compressed_bvh() {}
+
+    /**
+     * Constructor that builds a binary bvh over all of the objects in the given list and
+     * compresses it
+     *
+     * @param kObjects constant reference to the list of objects to build the hierarchy over
+     * @throws std::invalid_argument if an object in the list has no bounding box
+     */
+    explicit compressed_bvh(const hittable_list& kObjects);
+
+    /**
+     * Constructor that compresses the given binary hierarchy
+     *
+     * @param kHierarchy constant reference to the binary hierarchy to compress
+     */
+    explicit compressed_bvh(const bvh& kHierarchy);
+
+    /**
+     * Returns true if any of the objects in the hierarchy are hit by the given ray
+     * Updates the t value and hit object of the hit record with the closest intersection
+     * (does nothing if no hits)
+     *
+     * @param kRay constant reference to the ray to check if it hits a
+     *     hittable object in the hierarchy
+     * @param min_t real representing the minimum t value for the intersection
+     * @param max_t real representing the maximum t value for the intersection
+     * @param hit_record reference to a hit record to update with the details of the
+     *     intersection of the ray and the closest hit object (not updated if no
+     *     objects in the hierarchy are hit within the acceptable t value range)
+     * @return true if a hittable object in the hierarchy was hit by the given ray in the
+     *     given range of values for t and false otherwise
+     */
+    virtual bool intersect(const ray& kRay, real min_t, real max_t,
+        HitRecord& hit_record) const override;
+
+    /**
+     * Returns true if any of the objects in the hierarchy are hit by the given ray, stopping at
+     * the first object found to be hit
+     *
+     * @param kRay constant reference to the ray to check if it hits a
+     *     hittable object in the hierarchy
+     * @param min_t real representing the minimum t value for the intersection
+     * @param max_t real representing the maximum t value for the intersection
+     * @return true if a hittable object in the hierarchy was hit by the given ray in the
+     *     given range of values for t and false otherwise
+     */
+    virtual bool isOccluded(const ray& kRay, real min_t, real max_t) const override;
+
+    // see hittable docs
+    virtual bool boundingBox(real time0, real time1, aabb& output_box) const override;
+
+    /**
+     * Returns the number of nodes in the hierarchy
+     *
+     * @return a size_t representing the number of nodes in the hierarchy
+     */
+    size_t nodeCount() const;
+
+    /**
+     * Returns the number of bytes taken by the nodes of the hierarchy
+     *
+     * @return a size_t representing the number of bytes taken by the nodes
+     */
+    size_t nodeBytes() const;
+
+  private:
+    /**
+     * Recursively compresses the subtree of the given interior binary node, appending its nodes
+     * to nodes_ in depth first order
+     *
+     * @param kBinaryNodes constant reference to the nodes of the binary hierarchy
+     * @param binary_node_index the index in kBinaryNodes of the root of the subtree to compress
+     * @param kDecodedMinimum the minimum x, y, and z of the box that traversal will decode for
+     *     the root of the subtree, which its children are quantized relative to
+     * @param kDecodedMaximum the maximum x, y, and z of that box
+     * @return the index in nodes_ of the root of the compressed subtree
+     */
+    uint32_t compress(const std::vector<BvhNode>& kBinaryNodes, uint32_t binary_node_index,
+        const real kDecodedMinimum[3], const real kDecodedMaximum[3]);
+
+    // vector storing the nodes of the hierarchy in depth first order (root at index 0)
+    std::vector<CompressedBvhNode> nodes_;
+
+    // aabb bounding every object in the hierarchy (the exact box of the root node)
+    aabb bounds_;
+
+    // vector of raw pointers to the objects of the hierarchy in leaf order, used by traversal
+    std::vector<const Hittable*> objects_;
+
+    // vector of shared pointers that keep the objects of the hierarchy alive
+    std::vector<std::shared_ptr<Hittable>> owned_objects_;
+};
@@ -1,17 +1,31 @@
 #include "constants_and_utilities.h"
 
-inline double randomDouble() {
-  static std::uniform_real_distribution<double> random_distribution 
-      = std::uniform_real_distribution<double>(0.0, 1.0);
-  static std::mt19937 random_generator;
-  return random_distribution(random_generator);
+// stream used by randomDouble (one per thread, so threads never share state)
+thread_local RandomStream random_stream = RandomStream{0, 0, 0, 0, 0};
+
+/**
+ * Mixes the bits of the given value so that nearby inputs give unrelated outputs
+ * (the finalizer of SplitMix64)
+ * 
+ * @param value the value to mix
+ * @return a uint64_t with the mixed bits of the given value
+ */
+inline uint64_t mixBits(uint64_t value) {
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+
+void setRandomStream(uint64_t pixel_index, uint32_t sample_index, uint32_t bounce) {
+  random_stream.pixel_index_ = pixel_index;
+  random_stream.sample_index_ = sample_index;
+  random_stream.bounce_ = bounce;
+  random_stream.key_ = mixBits(mixBits(pixel_index) 
+      ^ ((static_cast<uint64_t>(sample_index) << 32) | bounce));
+  random_stream.counter_ = 0;
 }
 
-inline double clamp(double value, double min, double max) {
-  if (value < min) {
-    return min;
-  } else if (value > max) {
-    return max;
-  }
-  return value;
+void nextRandomBounce() {
+  setRandomStream(random_stream.pixel_index_, random_stream.sample_index_, 
+      random_stream.bounce_ + 1);
 }
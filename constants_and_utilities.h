@@ -1,12 +1,20 @@
 #pragma once
 
+#include <cstdint>
 #include <limits>
-#include <random>
+
+// Scalar type used by the math and geometry types (build with -DRAYTRACER_USE_FLOAT, or
+// make PRECISION=float, to render in single precision)
+#ifdef RAYTRACER_USE_FLOAT
+using real = float;
+#else
+using real = double;
+#endif
 
 // Constants
-const double infinity = std::numeric_limits<double>::infinity();
+const real infinity = std::numeric_limits<real>::infinity();
 
-const double pi = 3.1415926535897932385;
+const real pi = 3.1415926535897932385;
 
 // Utility Functions
 
@@ -20,12 +28,73 @@ inline double degrees_to_radians(double degrees) {
   return (degrees / 180) * pi;
 }
 
+/**
+ * Struct storing the stream that randomDouble draws from on a thread
+ */
+struct RandomStream {
+  // index of the pixel the stream belongs to
+  uint64_t pixel_index_;
+  // index of the sample the stream belongs to
+  uint32_t sample_index_;
+  // bounce the stream belongs to
+  uint32_t bounce_;
+  // 64-bit hash of the pixel, sample, and bounce that selects the stream
+  uint64_t key_;
+  // number of values drawn from the stream so far
+  uint64_t counter_;
+};
+
+// stream used by randomDouble (one per thread, so threads never share state)
+extern thread_local RandomStream random_stream;
+
+/**
+ * Returns the random bits at the given position of the stream with the given key
+ * The counter walks a Weyl sequence offset by the key, which is then advanced by one 
+ * step of the PCG linear congruential generator and permuted with PCG's RXS M XS output
+ * function
+ * 
+ * @param key the key of the stream
+ * @param counter the position in the stream
+ * @return a uint64_t storing 64 random bits
+ */
+inline uint64_t hashCounter(uint64_t key, uint64_t counter) {
+  uint64_t state = key + ((counter + 1) * 0x9e3779b97f4a7c15ULL);
+  state = (state * 6364136223846793005ULL) + 1442695040888963407ULL;
+  const uint64_t kWord = ((state >> ((state >> 59) + 5)) ^ state) * 12605985483714917081ULL;
+  return (kWord >> 43) ^ kWord;
+}
+
+/**
+ * Selects the stream of random numbers that randomDouble draws from on the calling thread
+ * 
+ * Random numbers are generated by hashing a counter (PCG-style) instead of advancing shared
+ * generator state, so the n-th number drawn from a stream depends only on the stream's key 
+ * and n. Keying streams on the pixel, sample, and bounce they are used for means any thread 
+ * can reproduce any sample and renders are bit-identical for every thread count
+ * 
+ * @param pixel_index the index of the pixel the numbers are drawn for
+ * @param sample_index the index of the sample (of the pixel) the numbers are drawn for
+ * @param bounce the bounce (0 for the camera ray) the numbers are drawn for
+ */
+void setRandomStream(uint64_t pixel_index, uint32_t sample_index, uint32_t bounce);
+
+/**
+ * Switches the calling thread to the stream of the next bounce of the current pixel and 
+ * sample (see setRandomStream)
+ */
+void nextRandomBounce();
+
 /**
  * Returns random real number in range [0,1)
+ * Draws the next number of the calling thread's current stream (see setRandomStream)
  * 
  * @return double representing a random real in range [0,1)
  */
-inline double randomDouble();
+inline double randomDouble() {
+  // the top 53 bits fill the mantissa of a double evenly spaced in [0, 1)
+  const uint64_t kBits = hashCounter(random_stream.key_, random_stream.counter_++);
+  return static_cast<double>(kBits >> 11) * (1.0 / 9007199254740992.0);
+}
 
 /**
  * Returns random real number in range [min, max)
@@ -49,4 +118,11 @@ inline double randomDouble(double min, double max) {
  *     if < min, reuturns min; if > max returns max; otherwise returns 
  *     the given value
  */
-inline double clamp(double value, double min, double max);
\ No newline at end of file
+inline double clamp(double value, double min, double max) {
+  if (value < min) {
+    return min;
+  } else if (value > max) {
+    return max;
+  }
+  return value;
+}
\ No newline at end of file
@@ -6,25 +6,55 @@ hittable_list::hittable_list(std::shared_ptr<Hittable> object) {
 
 void hittable_list::clear() {
   objects_.clear();
+  object_pointers_.clear();
 }
 
 void hittable_list::add(std::shared_ptr<Hittable> object) {
-  objects_.push_back(object);
+  object_pointers_.push_back(object.get());
+  objects_.push_back(std::move(object));
 }
 
-bool hittable_list::wasHit(const ray& kRay, double min_t, double max_t, 
+bool hittable_list::intersect(const ray& kRay, real min_t, real max_t, 
     HitRecord& hit_record) const {
-  HitRecord temp_hit_record = HitRecord();
   bool has_hit_anything = false;
-  double closest_t_value = max_t;
+  real closest_t_value = max_t;
 
-  for (std::shared_ptr<Hittable> object : objects_) {
-    if (object->wasHit(kRay, min_t, closest_t_value, temp_hit_record)) {
-      closest_t_value = temp_hit_record.t_;
+  // intersect only updates the hit record when a new closest intersection occurs
+  for (const Hittable* object : object_pointers_) {
+    if (object->intersect(kRay, min_t, closest_t_value, hit_record)) {
+      closest_t_value = hit_record.t_;
       has_hit_anything = true;
-      // only update hit record when new closest intersection occurs
-      hit_record = temp_hit_record;
     }
   }
   return has_hit_anything;
 }
+
+bool hittable_list::isOccluded(const ray& kRay, real min_t, real max_t) const {
+  for (const Hittable* object : object_pointers_) {
+    if (object->isOccluded(kRay, min_t, max_t)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool hittable_list::boundingBox(real time0, real time1, aabb& output_box) const {
+  if (objects_.empty()) {
+    return false;
+  }
+
+  aabb surrounding_box = aabb(); // defaults to an empty box
+  aabb object_box;
+  for (const Hittable* kObject : object_pointers_) {
+    if (!kObject->boundingBox(time0, time1, object_box)) {
+      return false;
+    }
+    surrounding_box = surroundingBox(surrounding_box, object_box);
+  }
+  output_box = surrounding_box;
+  return true;
+}
+
+const std::vector<std::shared_ptr<Hittable>>& hittable_list::objects() const {
+  return objects_;
+}
@@ -37,22 +37,60 @@ class hittable_list : public Hittable {
 
     /**
      * Returns true if any of the objects in the list are hit by the given ray
-     * Updates hit record with the closest intersection data (does nothing if no hits)
+     * Updates the t value and hit object of the hit record with the closest intersection 
+     * (does nothing if no hits)
      * 
      * @param kRay constant reference to the ray to check if it hits a 
      *     hittable object in the list
-     * @param min_t double representing the minimum t value for the intersection
-     * @param max_t double representing the maximum t value for the intersection
+     * @param min_t real representing the minimum t value for the intersection
+     * @param max_t real representing the maximum t value for the intersection
      * @param hit_record reference to a hit record to update with the details of the
      *     intersection of the ray and the closest hit object (not updated if no 
      *     objects in the list are hit within the acceptable t value range)
      * @return true if a hittable object in the list was hit by the given ray in the 
      *     given range of values for t and false otherwise
      */
-    virtual bool wasHit(const ray& kRay, double min_t, double max_t, 
+    virtual bool intersect(const ray& kRay, real min_t, real max_t, 
         HitRecord& hit_record) const override;
 
+    /**
+     * Returns true if any of the objects in the list are hit by the given ray, stopping at the
+     * first object found to be hit
+     *
+     * @param kRay constant reference to the ray to check if it hits a
+     *     hittable object in the list
+     * @param min_t real representing the minimum t value for the intersection
+     * @param max_t real representing the maximum t value for the intersection
+     * @return true if a hittable object in the list was hit by the given ray in the
+     *     given range of values for t and false otherwise
+     */
+    virtual bool isOccluded(const ray& kRay, real min_t, real max_t) const override;
+
+    /**
+     * Computes the box bounding every object in the list over the given interval of time
+     * 
+     * @param time0 real representing the start of the time interval the box must cover
+     * @param time1 real representing the end of the time interval the box must cover
+     * @param output_box reference to an aabb to update with the box surrounding all of the 
+     *     objects in the list (not updated if the list is empty or an object has no bounding box)
+     * @return true if the list is non-empty and every object in it has a bounding box and 
+     *     false otherwise
+     */
+    virtual bool boundingBox(real time0, real time1, aabb& output_box) const override;
+
+    /**
+     * Returns the objects stored in the list
+     * 
+     * @return a constant reference to the vector of shared pointers to the hittable objects 
+     *     in the list
+     */
+    const std::vector<std::shared_ptr<Hittable>>& objects() const;
+
   private:
     // vector of shared pointers to hittable objects storing the hittable objects in the list
     std::vector<std::shared_ptr<Hittable>> objects_;
+
+    // vector of raw pointers to the objects in objects_ (in the same order) so that intersect 
+    // iterates over plain pointers and never touches a reference count
+    std::vector<const Hittable*> object_pointers_;
 };
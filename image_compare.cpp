@@ -0,0 +1,107 @@
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include "image_compare.h"
+
+bool readPpmImage(const std::string& kFileName, PpmImage& image) {
+  std::ifstream image_file = std::ifstream(kFileName);
+  if (!image_file.is_open()) {
+    return false;
+  }
+
+  std::string magic_number;
+  int max_color = 0;
+  image_file >> magic_number >> image.width_ >> image.height_ >> max_color;
+  if (!image_file || magic_number != "P3" || image.width_ <= 0 || image.height_ <= 0) {
+    return false;
+  }
+
+  const size_t kNumChannels = static_cast<size_t>(image.width_) * image.height_ * 3;
+  image.channels_ = std::vector<int>(kNumChannels);
+  for (size_t i = 0; i < kNumChannels; ++i) {
+    if (!(image_file >> image.channels_[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+ImageDifference compareImages(const PpmImage& kReference, const PpmImage& kImage) {
+  if (kReference.width_ != kImage.width_ || kReference.height_ != kImage.height_) {
+    throw std::invalid_argument("compareImages: the images must have the same size");
+  }
+
+  ImageDifference difference = ImageDifference();
+  double sum_of_differences = 0;
+  double sum_of_squared_differences = 0;
+  size_t num_pixels_differing = 0;
+  for (size_t i = 0; i < kReference.channels_.size(); i += 3) {
+    bool pixel_differs = false;
+    for (size_t channel = i; channel < i + 3; ++channel) {
+      const int kDifference = std::abs(kReference.channels_[channel] - kImage.channels_[channel]);
+      if (kDifference > difference.max_channel_difference_) {
+        difference.max_channel_difference_ = kDifference;
+      }
+      sum_of_differences += kDifference;
+      sum_of_squared_differences += static_cast<double>(kDifference) * kDifference;
+      pixel_differs = pixel_differs || kDifference > 0;
+    }
+    if (pixel_differs) {
+      ++num_pixels_differing;
+    }
+  }
+
+  const double kNumChannels = static_cast<double>(kReference.channels_.size());
+  difference.mean_channel_difference_ = sum_of_differences / kNumChannels;
+  difference.fraction_of_pixels_differing_ = num_pixels_differing / (kNumChannels / 3);
+  const double kMeanSquaredError = sum_of_squared_differences / kNumChannels;
+  if (kMeanSquaredError == 0) {
+    difference.peak_signal_to_noise_ratio_ = std::numeric_limits<double>::infinity();
+  } else {
+    difference.peak_signal_to_noise_ratio_ = 10 * std::log10((255.0 * 255.0) / kMeanSquaredError);
+  }
+  return difference;
+}
+
+bool isWithinLimits(const ImageDifference& kDifference, const ImageDifferenceLimits& kLimits) {
+  return kDifference.max_channel_difference_ <= kLimits.max_channel_difference_
+      && kDifference.peak_signal_to_noise_ratio_ >= kLimits.min_peak_signal_to_noise_ratio_;
+}
+
+bool comparePpmFiles(const std::string& kReferenceFileName, const std::string& kImageFileName,
+    std::ostream& stream) {
+  // no 8-bit channel can differ by more than 255, and the PSNR is never negative
+  return comparePpmFiles(kReferenceFileName, kImageFileName, ImageDifferenceLimits{255, 0},
+      stream);
+}
+
+bool comparePpmFiles(const std::string& kReferenceFileName, const std::string& kImageFileName,
+    const ImageDifferenceLimits& kLimits, std::ostream& stream) {
+  PpmImage reference = PpmImage();
+  PpmImage image = PpmImage();
+  if (!readPpmImage(kReferenceFileName, reference) || !readPpmImage(kImageFileName, image)) {
+    stream << "could not read " << kReferenceFileName << " and " << kImageFileName << "\n";
+    return false;
+  }
+  if (reference.width_ != image.width_ || reference.height_ != image.height_) {
+    stream << kReferenceFileName << " and " << kImageFileName << " have different sizes\n";
+    return false;
+  }
+
+  const ImageDifference kDifference = compareImages(reference, image);
+  stream << kImageFileName << " vs " << kReferenceFileName << ": max channel difference "
+      << kDifference.max_channel_difference_ << ", mean channel difference "
+      << kDifference.mean_channel_difference_ << ", pixels differing "
+      << (100 * kDifference.fraction_of_pixels_differing_) << "%, PSNR "
+      << kDifference.peak_signal_to_noise_ratio_ << " dB\n";
+  if (!isWithinLimits(kDifference, kLimits)) {
+    stream << kImageFileName << " differs by more than the limits (max channel difference "
+        << kLimits.max_channel_difference_ << ", PSNR "
+        << kLimits.min_peak_signal_to_noise_ratio_ << " dB)\n";
+    return false;
+  }
+  return true;
+}
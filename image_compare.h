@@ -0,0 +1,102 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Struct storing an 8-bit RGB image read from a PPM file
+ */
+struct PpmImage {
+  // int representing the width of the image in pixels
+  int width_;
+
+  // int representing the height of the image in pixels
+  int height_;
+
+  // vector storing the red, green, and blue values of every pixel, row by row from the top
+  std::vector<int> channels_;
+};
+
+/**
+ * Struct storing how much two images differ
+ */
+struct ImageDifference {
+  // largest difference between the same channel of the same pixel in the two images
+  int max_channel_difference_;
+
+  // average absolute difference between the channels of the two images
+  double mean_channel_difference_;
+
+  // fraction of the pixels that differ in any channel
+  double fraction_of_pixels_differing_;
+
+  // peak signal-to-noise ratio of the second image against the first, in dB
+  // (infinity if the images are identical)
+  double peak_signal_to_noise_ratio_;
+};
+
+/**
+ * Struct storing how much two images may differ before a comparison fails
+ */
+struct ImageDifferenceLimits {
+  // largest allowed difference between the same channel of the same pixel in the two images
+  int max_channel_difference_;
+
+  // smallest allowed peak signal-to-noise ratio of the second image against the first, in dB
+  double min_peak_signal_to_noise_ratio_;
+};
+
+/**
+ * Reads the ASCII (P3) PPM image stored in the file with the given name
+ *
+ * @param kFileName constant reference to the name of the file to read
+ * @param image reference to a PpmImage to update with the contents of the file
+ * @return true if the file was read and false if it could not be opened or is not a P3 PPM
+ */
+bool readPpmImage(const std::string& kFileName, PpmImage& image);
+
+/**
+ * Computes how much the given image differs from the given reference image
+ *
+ * @param kReference constant reference to the image to compare against
+ * @param kImage constant reference to the image to compare
+ * @return an ImageDifference describing how much the images differ
+ * @throws std::invalid_argument if the images do not have the same size
+ */
+ImageDifference compareImages(const PpmImage& kReference, const PpmImage& kImage);
+
+/**
+ * Returns true if the given difference between two images is within the given limits
+ *
+ * @param kDifference constant reference to the difference between the images
+ * @param kLimits constant reference to the limits to check the difference against
+ * @return true if neither the max channel difference nor the PSNR is past its limit and false
+ *     otherwise
+ */
+bool isWithinLimits(const ImageDifference& kDifference, const ImageDifferenceLimits& kLimits);
+
+/**
+ * Reads the two given PPM files, compares them, and adds the result to the given stream
+ *
+ * @param kReferenceFileName constant reference to the name of the reference image file
+ * @param kImageFileName constant reference to the name of the image file to compare
+ * @param stream reference to a stream to add the comparison to
+ * @return true if both images were read and have the same size and false otherwise
+ */
+bool comparePpmFiles(const std::string& kReferenceFileName, const std::string& kImageFileName,
+    std::ostream& stream);
+
+/**
+ * Reads the two given PPM files, compares them, and adds the result (and whether it is within
+ * the given limits) to the given stream
+ *
+ * @param kReferenceFileName constant reference to the name of the reference image file
+ * @param kImageFileName constant reference to the name of the image file to compare
+ * @param kLimits constant reference to how much the images may differ
+ * @param stream reference to a stream to add the comparison to
+ * @return true if both images were read, have the same size, and differ by no more than the
+ *     limits and false otherwise
+ */
+bool comparePpmFiles(const std::string& kReferenceFileName, const std::string& kImageFileName,
+    const ImageDifferenceLimits& kLimits, std::ostream& stream);
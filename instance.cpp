@@ -0,0 +1,51 @@
+#include <stdexcept>
+
+#include "instance.h"
+
+instance::instance(std::shared_ptr<const Hittable> object, const affine_transform& kObjectToWorld)
+    : object_(object), object_to_world_(kObjectToWorld),
+    world_to_object_(kObjectToWorld.inverse()) {
+  if (!object_) {
+    throw std::invalid_argument("instance: the instanced object must not be null");
+  }
+}
+
+ray instance::toObjectSpace(const ray& kRay) const {
+  return ray(world_to_object_.transformPoint(kRay.origin()),
+      world_to_object_.transformVector(kRay.direction()));
+}
+
+bool instance::intersect(const ray& kRay, real min_t, real max_t, HitRecord& hit_record) const {
+  if (!object_->intersect(toObjectSpace(kRay), min_t, max_t, hit_record)) {
+    return false;
+  }
+  // the instance finalizes the hit, since the primitive only knows about object space
+  hit_record.instanced_object_ = hit_record.hit_object_;
+  hit_record.hit_object_ = this;
+  return true;
+}
+
+bool instance::isOccluded(const ray& kRay, real min_t, real max_t) const {
+  return object_->isOccluded(toObjectSpace(kRay), min_t, max_t);
+}
+
+void instance::finalizeHit(const ray& kRay, HitRecord& hit_record) const {
+  hit_record.hit_object_ = hit_record.instanced_object_;
+  hit_record.instanced_object_->finalizeHit(toObjectSpace(kRay), hit_record);
+  hit_record.hit_object_ = this;
+
+  // normals are carried out by the inverse transpose, which keeps them perpendicular to the
+  // surface and on the same side of it as the ray (so front_facing_ stays correct)
+  hit_record.point_of_intersection_ = kRay.at(hit_record.t_);
+  hit_record.surface_normal_ =
+      unitVector(world_to_object_.transposeTransformVector(hit_record.surface_normal_));
+}
+
+bool instance::boundingBox(real time0, real time1, aabb& output_box) const {
+  aabb object_box = aabb();
+  if (!object_->boundingBox(time0, time1, object_box)) {
+    return false;
+  }
+  output_box = object_to_world_.transformBox(object_box);
+  return true;
+}
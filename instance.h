@@ -0,0 +1,63 @@
+#pragma once
+
+#include <memory>
+
+#include "affine_transform.h"
+#include "Hittable.h"
+
+/**
+ * Class representing a copy of a hittable object placed in the world by an affine transform
+ *
+ * The object (usually a bvh over a group of primitives) is shared by every instance of it, so
+ * memory grows with the unique geometry rather than with the number of copies. A top-level bvh
+ * over the instances makes a two-level hierarchy: rays are carried into the object space of an
+ * instance at its boundary, traced through the shared object, and its hit is carried back out
+ *
+ * The direction of the object-space ray is not normalized, so t values are the same in both
+ * spaces and hits from different instances compare directly
+ *
+ * NOTE: Instances of instances are not supported (a hit record remembers only one instanced
+ * object)
+ */
+class instance : public Hittable {
+  public:
+    /**
+     * Constructor placing the given object in the world with the given transform
+     *
+     * @param object a shared pointer to the hittable object to place (shared with any other
+     *     instances of it)
+     * @param kObjectToWorld constant reference to the transform from the object's space to
+     *     world space
+     * @throws std::invalid_argument if the object is null or the transform is singular
+     */
+    instance(std::shared_ptr<const Hittable> object, const affine_transform& kObjectToWorld);
+
+    // see hittable docs
+    virtual bool intersect(const ray& kRay, real min_t, real max_t,
+        HitRecord& hit_record) const override;
+
+    // see hittable docs
+    virtual bool isOccluded(const ray& kRay, real min_t, real max_t) const override;
+
+    // see hittable docs
+    virtual void finalizeHit(const ray& kRay, HitRecord& hit_record) const override;
+
+    // see hittable docs
+    virtual bool boundingBox(real time0, real time1, aabb& output_box) const override;
+
+  private:
+    /**
+     * Carries the given world-space ray into the object space of the instance
+     *
+     * @param kRay constant reference to the world-space ray
+     * @return a ray with the same t values in object space
+     */
+    ray toObjectSpace(const ray& kRay) const;
+
+    // object placed by the instance
+    std::shared_ptr<const Hittable> object_;
+    // transform from the object's space to world space
+    affine_transform object_to_world_;
+    // transform from world space to the object's space
+    affine_transform world_to_object_;
+};
@@ -1,169 +1,101 @@
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
+#include "aabb.h"
+#include "affine_transform.h"
+#include "benchmark.h"
+#include "bvh.h"
 #include "camera.h"
-#include "camera.cpp"
+#include "compressed_bvh.h"
 #include "constants_and_utilities.h"
-#include "constants_and_utilities.cpp"
 #include "Hittable.h"
 #include "hittable_list.h"
-#include "hittable_list.cpp"
+#include "image_compare.h"
+#include "instance.h"
+#include "mapped_bvh.h"
 #include "Material.h"
+#include "material_table.h"
+#include "morton.h"
 #include "ray.h"
-#include "ray.cpp"
+#include "renderer.h"
+#include "scenes.h"
 #include "sphere.h"
-#include "sphere.cpp"
+#include "sphere_set.h"
+#include "thread_pool.h"
 #include "vec3.h"
-#include "vec3.cpp"
+#include "wavefront.h"
+#include "wide_bvh.h"
 
 
 
-color rayColor(const ray& kRay, const Hittable& objects, size_t depth) {
-  // find closest hit object (if an object was hit)
-  HitRecord hit_record = HitRecord();
-
-  // return no light after the bounce limit has been exceeded 
-  if (depth <= 0) {
-    return color(0, 0, 0);
-  }
-
-  // ignore hits that are extremely close to 0 to fix shadow acne 
-  const double kMinT = 0.001;
-  const bool kWasHit = objects.wasHit(kRay, kMinT, infinity, hit_record);
-
-  // if an object is hit, scatter the light according to the material of the hit object
-  if (kWasHit) {
-    ray scattered_ray;
-    color attenuation;
-    if (hit_record.material_pointer->scatter(kRay, hit_record, attenuation, scattered_ray)) {
-      return attenuation * rayColor(scattered_ray, objects, depth - 1);
-    } else {
-      return color(0, 0, 0);
-    }
-  }
-
-  // otherwise ray is through background (blue-white gradient) pixel
-  const vec3 kUnitVector = unitVector(kRay.direction());
-  // midpoint of unit y component and 1.0 (ensures 0 <= t <= 1)
-  const double t = 0.5 * (kUnitVector.y() + 1.0);
-  // starting color for the lerp
-  const color kWhite = color(1, 1, 1);
-  // ending color for the lerp
-  const color kLightBlue = color(0.5, 0.7, 1.0);
-  // lerp white and light blue based on t
-  return (kWhite * (1.0 - t)) + (kLightBlue * t);
-}
-
-void metalSpheres(std::string file_name) {
+void metalSpheres(std::string file_name, bool use_wavefront) {
   std::ofstream image_file = std::ofstream(file_name, std::ios::ate);
   if (image_file.is_open()){
-    // P3 means that the colors are in ASCII
-    image_file << "P3\n";
     // Specifies image width and height
     const double kAspectRatio = 16.0 / 9.0;
     const int kImageWidth = 400;
     const int kImageHeight = static_cast<int>(kImageWidth / kAspectRatio);
-    image_file << kImageWidth << " " << kImageHeight << "\n";
 
     // Create World with 4 spheres
     hittable_list world = hittable_list();
-    const std::shared_ptr<Lambertian> kMaterialGround = std::make_shared<Lambertian>(color(0.8, 0.8, 0.0));
-    const std::shared_ptr<Lambertian> kMaterialCenterDiffuseSphere = std::make_shared<Lambertian>(color(0.7, 0.3, 0.3));
-    // metal sphere with relatively clear reflection
-    const std::shared_ptr<Metal> kMaterialLeftMetalSphere = std::make_shared<Metal>(color(0.8, 0.8, 0.8), 0.3);
-    // metal sphere with very fuzzy reflection
-    const std::shared_ptr<Metal> kMaterialRightMetalSphere = std::make_shared<Metal>(color(0.8, 0.6, 0.2), 1.0);
-    
-    world.add(std::make_shared<sphere>(point3(0, -100.5, -1), 100, kMaterialGround));
-    world.add(std::make_shared<sphere>(point3(0.0, 0.0, -1.0), 0.5, kMaterialCenterDiffuseSphere));
-    world.add(std::make_shared<sphere>(point3(-1.0, 0.0, -1.0), 0.5, kMaterialLeftMetalSphere));
-    world.add(std::make_shared<sphere>(point3(1.0, 0.0, -1.0), 0.5, kMaterialRightMetalSphere));
+    material_table materials = material_table();
+    addMetalSpheresScene(world, materials);
+    // acceleration structure over the world used for all ray queries
+    const bvh kWorldHierarchy = bvh(world);
 
     // add a camera to the scene
     const camera kCameraOne = camera();
 
-    // Specifies the max color for the RGB triplets
-    const int kMaxColor = 255;
-    image_file << kMaxColor << "\n";
-    // Specifies number of color samples to take per pixel
-    const int kNumSamplesPerPixel = 100;
-
-    // Write RGB triplets to the file
-    // pixels are written out in rows from top to bottom that go left to right
-    for (int i = kImageHeight - 1; i >= 0; --i) {
-      std::cerr << "\rScanlines remaining: " << i << ' ' << std::flush;
-      for (int j = 0; j < kImageWidth; ++j) {
-        // antialiasing sampling
-        color pixel_color = color(); // defaults to zero vector
-        for (int k = 0; k < kNumSamplesPerPixel; ++k) {
-          const double kHorizontalFactor = (j + randomDouble()) / (kImageWidth - 1);
-          const double kVerticalFactor = (i + randomDouble()) / (kImageHeight - 1);
-          const ray kRay = kCameraOne.getRay(kHorizontalFactor, kVerticalFactor);
-          const size_t kMaxNumRayBounces = 50;
-          pixel_color += rayColor(kRay, world, kMaxNumRayBounces);
-        }
-        // add pixel to the ppm file 
-        writeColor(image_file, pixel_color, kNumSamplesPerPixel);
-      }
-    }
+    // render the scene in parallel tiles and write it to the file
+    RenderSettings settings = RenderSettings();
+    settings.image_width_ = kImageWidth;
+    settings.image_height_ = kImageHeight;
+    settings.samples_per_pixel_ = 100;
+    settings.max_ray_bounces_ = 50;
+    settings.tile_size_ = 16;
+    settings.num_threads_ = 0; // one thread per hardware thread
+    settings.use_wavefront_ = use_wavefront;
+    settings.sort_by_material_ = true;
+    const std::vector<color> kFramebuffer = renderImage(kCameraOne, kWorldHierarchy, materials, settings);
+    writePpmImage(image_file, kFramebuffer, settings);
   }
   image_file.close();
   std::cerr << "\nDone.\n";
 }
 
-void glassSpheres(std::string file_name) {
+void glassSpheres(std::string file_name, bool use_wavefront) {
   std::ofstream image_file = std::ofstream(file_name, std::ios::ate);
   if (image_file.is_open()){
-    // P3 means that the colors are in ASCII
-    image_file << "P3\n";
     // Specifies image width and height
     const double kAspectRatio = 16.0 / 9.0;
     const int kImageWidth = 400;
     const int kImageHeight = static_cast<int>(kImageWidth / kAspectRatio);
-    image_file << kImageWidth << " " << kImageHeight << "\n";
 
     // Create World with 4 spheres
     hittable_list world = hittable_list();
-    const std::shared_ptr<Lambertian> kMaterialGround = std::make_shared<Lambertian>(color(0.8, 0.8, 0.0));
-    //  2 glass spheres
-    const std::shared_ptr<Dielectric> kMaterialCenterGlassSphere = std::make_shared<Dielectric>(1.5);
-    const std::shared_ptr<Dielectric> kMaterialLeftGlassSphere = std::make_shared<Dielectric>(1.5);
-    // metal sphere with very fuzzy reflection
-    const std::shared_ptr<Metal> kMaterialRightMetalSphere = std::make_shared<Metal>(color(0.8, 0.6, 0.2), 1.0);
-    
-    world.add(std::make_shared<sphere>(point3(0, -100.5, -1), 100, kMaterialGround));
-    world.add(std::make_shared<sphere>(point3(0.0, 0.0, -1.0), 0.5, kMaterialCenterGlassSphere));
-    world.add(std::make_shared<sphere>(point3(-1.0, 0.0, -1.0), 0.5, kMaterialLeftGlassSphere));
-    world.add(std::make_shared<sphere>(point3(1.0, 0.0, -1.0), 0.5, kMaterialRightMetalSphere));
+    material_table materials = material_table();
+    addGlassSpheresScene(world, materials);
+    // acceleration structure over the world used for all ray queries
+    const bvh kWorldHierarchy = bvh(world);
 
     // add a camera to the scene
     const camera kCameraOne = camera();
 
-    // Specifies the max color for the RGB triplets
-    const int kMaxColor = 255;
-    image_file << kMaxColor << "\n";
-    // Specifies number of color samples to take per pixel
-    const int kNumSamplesPerPixel = 100;
-
-    // Write RGB triplets to the file
-    // pixels are written out in rows from top to bottom that go left to right
-    for (int i = kImageHeight - 1; i >= 0; --i) {
-      std::cerr << "\rScanlines remaining: " << i << ' ' << std::flush;
-      for (int j = 0; j < kImageWidth; ++j) {
-        // antialiasing sampling
-        color pixel_color = color(); // defaults to zero vector
-        for (int k = 0; k < kNumSamplesPerPixel; ++k) {
-          const double kHorizontalFactor = (j + randomDouble()) / (kImageWidth - 1);
-          const double kVerticalFactor = (i + randomDouble()) / (kImageHeight - 1);
-          const ray kRay = kCameraOne.getRay(kHorizontalFactor, kVerticalFactor);
-          const size_t kMaxNumRayBounces = 50;
-          pixel_color += rayColor(kRay, world, kMaxNumRayBounces);
-        }
-        // add pixel to the ppm file 
-        writeColor(image_file, pixel_color, kNumSamplesPerPixel);
-      }
-    }
+    // render the scene in parallel tiles and write it to the file
+    RenderSettings settings = RenderSettings();
+    settings.image_width_ = kImageWidth;
+    settings.image_height_ = kImageHeight;
+    settings.samples_per_pixel_ = 100;
+    settings.max_ray_bounces_ = 50;
+    settings.tile_size_ = 16;
+    settings.num_threads_ = 0; // one thread per hardware thread
+    settings.use_wavefront_ = use_wavefront;
+    settings.sort_by_material_ = true;
+    const std::vector<color> kFramebuffer = renderImage(kCameraOne, kWorldHierarchy, materials, settings);
+    writePpmImage(image_file, kFramebuffer, settings);
   }
   image_file.close();
   std::cerr << "\nDone.\n";
@@ -203,9 +135,50 @@ void outputBasicImageToFile(std::string file_name) {
   std::cerr << "\nDone.\n";
 }
 
-int main() {
-  outputBasicImageToFile("results/basicImage.ppm");
-  metalSpheres("results/metalSpheres.ppm");
-  glassSpheres("results/alwaysRefractingGlassSpheres.ppm");
+int main(int argc, char* argv[]) {
+  // ./raytracer --benchmark <name> runs a benchmark instead of rendering the scenes
+  if (argc == 3 && std::string(argv[1]) == "--benchmark") {
+    if (!runBenchmark(argv[2], std::cout)) {
+      std::cerr << "Unknown benchmark: " << argv[2] << "\n";
+      return 1;
+    }
+    return 0;
+  }
+  // ./raytracer --compare <reference.ppm> <image.ppm> reports how much two renders differ, and
+  // fails if they differ by more than <max channel difference> or <min PSNR> when those are given
+  if (argc == 4 && std::string(argv[1]) == "--compare") {
+    return comparePpmFiles(argv[2], argv[3], std::cout) ? 0 : 1;
+  }
+  if (argc == 6 && std::string(argv[1]) == "--compare") {
+    ImageDifferenceLimits limits = ImageDifferenceLimits();
+    try {
+      // the limits must be numbers with nothing after them
+      size_t num_characters_parsed = 0;
+      limits.max_channel_difference_ = std::stoi(argv[4], &num_characters_parsed);
+      if (argv[4][num_characters_parsed] != '\0') {
+        throw std::invalid_argument(argv[4]);
+      }
+      limits.min_peak_signal_to_noise_ratio_ = std::stod(argv[5], &num_characters_parsed);
+      if (argv[5][num_characters_parsed] != '\0') {
+        throw std::invalid_argument(argv[5]);
+      }
+    } catch (const std::logic_error&) {
+      // std::invalid_argument if a limit is not a number, std::out_of_range if it is too large
+      std::cerr << "Usage: ./raytracer --compare <reference.ppm> <image.ppm> "
+          << "[<max channel difference> <min PSNR>]\n";
+      return 1;
+    }
+    return comparePpmFiles(argv[2], argv[3], limits, std::cout) ? 0 : 1;
+  }
+
+  // ./raytracer --wavefront renders the scenes as wavefronts instead of one path at a time
+  const bool kUseWavefront = argc == 2 && std::string(argv[1]) == "--wavefront";
+  // ./raytracer --output <directory> renders the scenes into <directory> instead of results
+  const std::string kOutputDirectory = (argc == 3 && std::string(argv[1]) == "--output") 
+      ? argv[2] : "results";
+
+  outputBasicImageToFile(kOutputDirectory + "/basicImage.ppm");
+  metalSpheres(kOutputDirectory + "/metalSpheres.ppm", kUseWavefront);
+  glassSpheres(kOutputDirectory + "/alwaysRefractingGlassSpheres.ppm", kUseWavefront);
   return 0;
 }
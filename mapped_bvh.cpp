@@ -0,0 +1,355 @@
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped_bvh.h"
+#include "sphere.h"
+
+// 64-bit FNV-1a prime
+const uint64_t kFnvPrime = 0x100000001b3ull;
+// magic bytes at the start of every bvh cache file
+const char kBvhCacheMagic[8] = {'R', 'T', 'B', 'V', 'H', 0, 0, 0};
+// alignment of the arrays in a bvh cache file (a cache line, which covers every real and vec3
+// backend)
+const uint64_t kBvhCacheAlignment = 64;
+
+// the arrays are used in place, so they must be plain bytes
+static_assert(std::is_trivially_copyable<BvhNode>::value, "BvhNode must be trivially copyable");
+static_assert(alignof(BvhNode) <= kBvhCacheAlignment && alignof(CachedSphere) <= kBvhCacheAlignment,
+    "bvh cache arrays must fit the alignment of the file");
+
+/**
+ * Rounds the given offset up to the next multiple of kBvhCacheAlignment
+ *
+ * @param offset the offset to round up
+ * @return a uint64_t storing the aligned offset
+ */
+static uint64_t alignCacheOffset(uint64_t offset) {
+  return (offset + kBvhCacheAlignment - 1) / kBvhCacheAlignment * kBvhCacheAlignment;
+}
+
+uint64_t fnv1aHash(const void* kData, size_t size, uint64_t hash) {
+  const unsigned char* kBytes = static_cast<const unsigned char*>(kData);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ kBytes[i]) * kFnvPrime;
+  }
+  return hash;
+}
+
+uint64_t sceneHash(const RandomSpheresDescription& kDescription) {
+  // fields are hashed one at a time so padding bytes never reach the hash
+  uint64_t hash = kFnvOffsetBasis;
+  hash = fnv1aHash(&kDescription.seed_, sizeof(kDescription.seed_), hash);
+  hash = fnv1aHash(&kDescription.sphere_count_, sizeof(kDescription.sphere_count_), hash);
+  hash = fnv1aHash(&kDescription.half_size_, sizeof(kDescription.half_size_), hash);
+  hash = fnv1aHash(&kDescription.min_radius_, sizeof(kDescription.min_radius_), hash);
+  hash = fnv1aHash(&kDescription.max_radius_, sizeof(kDescription.max_radius_), hash);
+  return fnv1aHash(&kDescription.material_count_, sizeof(kDescription.material_count_), hash);
+}
+
+bool writeBvhCache(const std::string& kFileName, const bvh& kHierarchy, uint64_t scene_hash) {
+  const std::vector<BvhNode>& kNodes = kHierarchy.nodes();
+  const std::vector<const Hittable*>& kObjects = kHierarchy.leafObjects();
+  std::vector<CachedSphere> spheres = std::vector<CachedSphere>(kObjects.size());
+  for (size_t i = 0; i < kObjects.size(); ++i) {
+    const sphere* kSphere = dynamic_cast<const sphere*>(kObjects[i]);
+    if (kSphere == nullptr) {
+      throw std::invalid_argument("writeBvhCache: every object in the hierarchy must be a sphere");
+    }
+    // zeroed first so the padding written to the file is deterministic
+    std::memset(&spheres[i], 0, sizeof(CachedSphere));
+    const point3 kCenter = kSphere->center();
+    spheres[i].center_[0] = kCenter.x();
+    spheres[i].center_[1] = kCenter.y();
+    spheres[i].center_[2] = kCenter.z();
+    spheres[i].radius_ = kSphere->radius();
+    spheres[i].material_id_ = kSphere->materialId();
+  }
+
+  BvhCacheHeader header = BvhCacheHeader();
+  std::memcpy(header.magic_, kBvhCacheMagic, sizeof(kBvhCacheMagic));
+  header.version_ = kBvhCacheVersion;
+  header.real_size_ = sizeof(real);
+  header.node_size_ = sizeof(BvhNode);
+  header.sphere_size_ = sizeof(CachedSphere);
+  header.scene_hash_ = scene_hash;
+  header.node_count_ = kNodes.size();
+  header.sphere_count_ = spheres.size();
+  header.nodes_offset_ = alignCacheOffset(sizeof(BvhCacheHeader));
+  header.spheres_offset_ =
+      alignCacheOffset(header.nodes_offset_ + (kNodes.size() * sizeof(BvhNode)));
+
+  // written to a temporary file and renamed into place, so a reader never maps a partial cache
+  const std::string kTemporaryFileName = kFileName + ".tmp";
+  std::ofstream cache_file = std::ofstream(kTemporaryFileName, std::ios::binary);
+  if (!cache_file.is_open()) {
+    return false;
+  }
+  const char kPadding[kBvhCacheAlignment] = {};
+  cache_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  cache_file.write(kPadding, header.nodes_offset_ - sizeof(header));
+  cache_file.write(reinterpret_cast<const char*>(kNodes.data()), kNodes.size() * sizeof(BvhNode));
+  cache_file.write(kPadding,
+      header.spheres_offset_ - header.nodes_offset_ - (kNodes.size() * sizeof(BvhNode)));
+  cache_file.write(reinterpret_cast<const char*>(spheres.data()),
+      spheres.size() * sizeof(CachedSphere));
+  cache_file.close();
+  if (!cache_file) {
+    std::remove(kTemporaryFileName.c_str());
+    return false;
+  }
+  return std::rename(kTemporaryFileName.c_str(), kFileName.c_str()) == 0;
+}
+
+/**
+ * Returns true if the given nodes form a hierarchy that traversal can walk safely: laid out
+ * depth first, no deeper than kMaxBvhDepth, with valid split axes, and with every leaf inside
+ * the spheres
+ *
+ * Walks the tree in the same order as it is stored, so a corrupt child offset (past the end, or
+ * back to a node already visited) shows up as a node out of order and the walk visits every node
+ * at most once
+ *
+ * @param kNodes pointer to the nodes of the hierarchy
+ * @param node_count the number of nodes
+ * @param sphere_count the number of spheres the leaves index into
+ * @return true if the hierarchy is well formed and false otherwise
+ */
+static bool isValidHierarchy(const BvhNode* kNodes, uint64_t node_count, uint64_t sphere_count) {
+  if (node_count == 0) {
+    return true;
+  }
+  // every entry of the stack is a right child and its depth
+  uint64_t node_stack[kMaxTraversalStackSize];
+  size_t depth_stack[kMaxTraversalStackSize];
+  size_t stack_size = 0;
+  uint64_t node_index = 0;
+  size_t depth = 0;
+  uint64_t num_visited = 0;
+  while (true) {
+    if (node_index != num_visited || num_visited == node_count) {
+      return false;
+    }
+    ++num_visited;
+    const BvhNode& kNode = kNodes[node_index];
+    if (kNode.isLeaf()) {
+      // computed in 64 bits so a corrupt offset cannot wrap around
+      if (static_cast<uint64_t>(kNode.offset_) + kNode.object_count_ > sphere_count) {
+        return false;
+      }
+      if (stack_size == 0) {
+        break;
+      }
+      --stack_size;
+      node_index = node_stack[stack_size];
+      depth = depth_stack[stack_size];
+      continue;
+    }
+    // an interior node's children are one level deeper, and it pushes one of them
+    if (depth >= kMaxBvhDepth || kNode.split_axis_ > 2) {
+      return false;
+    }
+    node_stack[stack_size] = kNode.offset_;
+    depth_stack[stack_size] = depth + 1;
+    ++stack_size;
+    ++node_index;
+    ++depth;
+  }
+  return num_visited == node_count;
+}
+
+mapped_bvh::mapped_bvh() : mapping_(nullptr), mapping_size_(0), nodes_(nullptr),
+    node_count_(0), spheres_(nullptr) {}
+
+mapped_bvh::~mapped_bvh() {
+  unmap();
+}
+
+void mapped_bvh::unmap() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+  }
+  mapping_ = nullptr;
+  mapping_size_ = 0;
+  nodes_ = nullptr;
+  node_count_ = 0;
+  spheres_ = nullptr;
+}
+
+bool mapped_bvh::load(const std::string& kFileName, uint64_t scene_hash) {
+  unmap();
+  const int kFileDescriptor = open(kFileName.c_str(), O_RDONLY);
+  if (kFileDescriptor < 0) {
+    return false;
+  }
+  struct stat file_status;
+  if (fstat(kFileDescriptor, &file_status) != 0
+      || static_cast<uint64_t>(file_status.st_size) < sizeof(BvhCacheHeader)) {
+    close(kFileDescriptor);
+    return false;
+  }
+  const size_t kFileSize = static_cast<size_t>(file_status.st_size);
+  // the mapping stays valid after the file is closed
+  void* mapping = mmap(nullptr, kFileSize, PROT_READ, MAP_PRIVATE, kFileDescriptor, 0);
+  close(kFileDescriptor);
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+  mapping_ = mapping;
+  mapping_size_ = kFileSize;
+
+  const char* kBytes = static_cast<const char*>(mapping_);
+  BvhCacheHeader header = BvhCacheHeader();
+  std::memcpy(&header, kBytes, sizeof(header));
+  const bool kIsCurrent = std::memcmp(header.magic_, kBvhCacheMagic, sizeof(kBvhCacheMagic)) == 0
+      && header.version_ == kBvhCacheVersion && header.real_size_ == sizeof(real)
+      && header.node_size_ == sizeof(BvhNode) && header.sphere_size_ == sizeof(CachedSphere)
+      && header.scene_hash_ == scene_hash;
+  // the arrays must be aligned and lie inside the file (counts are checked by division so a
+  // corrupt count cannot overflow)
+  const bool kIsComplete = kIsCurrent
+      && header.nodes_offset_ % kBvhCacheAlignment == 0
+      && header.spheres_offset_ % kBvhCacheAlignment == 0
+      && header.nodes_offset_ <= kFileSize && header.spheres_offset_ <= kFileSize
+      && header.node_count_ <= (kFileSize - header.nodes_offset_) / sizeof(BvhNode)
+      && header.sphere_count_ <= (kFileSize - header.spheres_offset_) / sizeof(CachedSphere);
+  // and the nodes must form a tree that traversal cannot follow out of the arrays
+  const bool kIsValid = kIsComplete
+      && isValidHierarchy(reinterpret_cast<const BvhNode*>(kBytes + header.nodes_offset_),
+      header.node_count_, header.sphere_count_);
+  if (!kIsValid) {
+    unmap();
+    return false;
+  }
+  nodes_ = reinterpret_cast<const BvhNode*>(kBytes + header.nodes_offset_);
+  node_count_ = static_cast<size_t>(header.node_count_);
+  spheres_ = reinterpret_cast<const CachedSphere*>(kBytes + header.spheres_offset_);
+  return true;
+}
+
+bool mapped_bvh::intersect(const ray& kRay, real min_t, real max_t, HitRecord& hit_record) const {
+  if (node_count_ == 0) {
+    return false;
+  }
+
+  const point3 kOrigin = kRay.origin();
+  const vec3 kDirection = kRay.direction();
+  const vec3 kInverseDirection = inverseDirection(kDirection);
+  uint32_t node_stack[kMaxTraversalStackSize];
+  size_t stack_size = 0;
+  uint32_t node_index = 0;
+  bool has_hit_anything = false;
+  real closest_t_value = max_t;
+
+  while (true) {
+    const BvhNode& kNode = nodes_[node_index];
+    if (kNode.bounds_.wasHit(kOrigin, kInverseDirection, min_t, closest_t_value)) {
+      if (kNode.isLeaf()) {
+        for (uint32_t i = kNode.offset_; i < kNode.offset_ + kNode.object_count_; ++i) {
+          const CachedSphere& kSphere = spheres_[i];
+          const point3 kCenter = point3(kSphere.center_[0], kSphere.center_[1],
+              kSphere.center_[2]);
+          real root = 0;
+          if (!closestSphereRoot(kCenter, kSphere.radius_, kRay, min_t, closest_t_value, root)) {
+            continue;
+          }
+          closest_t_value = root;
+          hit_record.t_ = root;
+          hit_record.hit_object_ = this;
+          hit_record.primitive_index_ = i;
+          hit_record.material_id_ = kSphere.material_id_;
+          has_hit_anything = true;
+        }
+      } else {
+        // visit the child nearer to the ray origin first so farther subtrees can be culled
+        // by the closest hit found so far
+        assert(stack_size < kMaxTraversalStackSize);
+        if (kDirection[kNode.split_axis_] < 0) {
+          node_stack[stack_size++] = node_index + 1;
+          node_index = kNode.offset_;
+        } else {
+          node_stack[stack_size++] = kNode.offset_;
+          node_index = node_index + 1;
+        }
+        continue;
+      }
+    }
+    if (stack_size == 0) {
+      break;
+    }
+    node_index = node_stack[--stack_size];
+  }
+  return has_hit_anything;
+}
+
+void mapped_bvh::finalizeHit(const ray& kRay, HitRecord& hit_record) const {
+  const CachedSphere& kSphere = spheres_[hit_record.primitive_index_];
+  const point3 kCenter = point3(kSphere.center_[0], kSphere.center_[1], kSphere.center_[2]);
+  finalizeSphereHit(kCenter, kRay, hit_record);
+}
+
+bool mapped_bvh::isOccluded(const ray& kRay, real min_t, real max_t) const {
+  if (node_count_ == 0) {
+    return false;
+  }
+
+  const point3 kOrigin = kRay.origin();
+  const vec3 kDirection = kRay.direction();
+  const vec3 kInverseDirection = inverseDirection(kDirection);
+  uint32_t node_stack[kMaxTraversalStackSize];
+  size_t stack_size = 0;
+  uint32_t node_index = 0;
+
+  while (true) {
+    const BvhNode& kNode = nodes_[node_index];
+    if (kNode.bounds_.wasHit(kOrigin, kInverseDirection, min_t, max_t)) {
+      if (kNode.isLeaf()) {
+        for (uint32_t i = kNode.offset_; i < kNode.offset_ + kNode.object_count_; ++i) {
+          const CachedSphere& kSphere = spheres_[i];
+          const point3 kCenter = point3(kSphere.center_[0], kSphere.center_[1],
+              kSphere.center_[2]);
+          real root = 0;
+          if (closestSphereRoot(kCenter, kSphere.radius_, kRay, min_t, max_t, root)) {
+            return true;
+          }
+        }
+      } else {
+        assert(stack_size < kMaxTraversalStackSize);
+        if (kDirection[kNode.split_axis_] < 0) {
+          node_stack[stack_size++] = node_index + 1;
+          node_index = kNode.offset_;
+        } else {
+          node_stack[stack_size++] = kNode.offset_;
+          node_index = node_index + 1;
+        }
+        continue;
+      }
+    }
+    if (stack_size == 0) {
+      break;
+    }
+    node_index = node_stack[--stack_size];
+  }
+  return false;
+}
+
+bool mapped_bvh::boundingBox(real time0, real time1, aabb& output_box) const {
+  if (node_count_ == 0) {
+    return false;
+  }
+  output_box = nodes_[0].bounds_;
+  return true;
+}
+
+size_t mapped_bvh::nodeCount() const {
+  return node_count_;
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "aabb.h"
+#include "bvh.h"
+#include "Hittable.h"
+#include "hittable_list.h"
+#include "scenes.h"
+
+// version of the cache file format (bump it whenever the layout of the header, BvhNode, or
+// CachedSphere changes, so stale caches are rebuilt instead of misread)
+const uint32_t kBvhCacheVersion = 1;
+
+// starting value of a 64-bit FNV-1a hash
+const uint64_t kFnvOffsetBasis = 0xcbf29ce484222325ull;
+
+/**
+ * Struct storing a sphere in a bvh cache file
+ */
+struct CachedSphere {
+  // x, y, and z of the center of the sphere
+  real center_[3];
+
+  // radius of the sphere
+  real radius_;
+
+  // material ID (in the scene's material_table) of the material of the sphere
+  uint32_t material_id_;
+};
+
+/**
+ * Struct storing the header at the start of a bvh cache file
+ *
+ * The nodes (a BvhNode array, laid out exactly as in bvh::nodes) and the spheres (a CachedSphere
+ * array in leaf order) follow at the given offsets, which are aligned for both types so the
+ * file can be used in place once it is mapped into memory
+ */
+struct BvhCacheHeader {
+  // "RTBVH" followed by zeros
+  char magic_[8];
+
+  // kBvhCacheVersion when the file was written
+  uint32_t version_;
+
+  // sizeof(real), sizeof(BvhNode), and sizeof(CachedSphere) when the file was written, since
+  // builds with a different precision or vec3 backend lay the arrays out differently
+  uint32_t real_size_;
+  uint32_t node_size_;
+  uint32_t sphere_size_;
+
+  // hash of the description of the scene the hierarchy was built over (see sceneHash)
+  uint64_t scene_hash_;
+
+  // number of nodes and spheres in the file
+  uint64_t node_count_;
+  uint64_t sphere_count_;
+
+  // offsets in bytes of the nodes and spheres from the start of the file
+  uint64_t nodes_offset_;
+  uint64_t spheres_offset_;
+};
+
+/**
+ * Adds the given bytes to a 64-bit FNV-1a hash
+ *
+ * @param kData pointer to the bytes to hash
+ * @param size the number of bytes to hash
+ * @param hash the hash of the bytes before these (kFnvOffsetBasis for the first bytes)
+ * @return a uint64_t storing the hash of all the bytes so far
+ */
+uint64_t fnv1aHash(const void* kData, size_t size, uint64_t hash);
+
+/**
+ * Computes the hash of the given description of a random spheres scene (every field, in
+ * order), which keys the cache of a hierarchy built over the scene
+ *
+ * Only the description is hashed, so the key of a cache is known before the scene is generated
+ *
+ * @param kDescription constant reference to the description of the scene
+ * @return a uint64_t storing the FNV-1a hash of the description
+ */
+uint64_t sceneHash(const RandomSpheresDescription& kDescription);
+
+/**
+ * Writes the given hierarchy of spheres, with the spheres themselves, to a bvh cache file that
+ * a mapped_bvh can load
+ *
+ * @param kFileName constant reference to the name of the file to write
+ * @param kHierarchy constant reference to the hierarchy to write
+ * @param scene_hash the hash of the description of the scene the hierarchy was built over
+ * @return true if the file was written and false if it could not be
+ * @throws std::invalid_argument if an object in the hierarchy is not a sphere
+ */
+bool writeBvhCache(const std::string& kFileName, const bvh& kHierarchy, uint64_t scene_hash);
+
+/**
+ * Class representing a bounding volume hierarchy of spheres read straight from a memory mapped
+ * bvh cache file
+ *
+ * Loading maps the file and checks its header and every node, without copying or building
+ * anything. The cache is keyed on the hash of the scene's description, so a warm start skips
+ * both generating the scene and building its hierarchy. Traversal is the same as bvh's, so it
+ * finds the same closest hits as the hierarchy that was written
+ *
+ * NOTE: Only geometry is cached; the material_table the material IDs refer to is still built
+ * by the caller
+ */
+class mapped_bvh : public Hittable {
+  public:
+    /**
+     * Default Constructor (makes an empty hierarchy that is never hit)
+     */
+    mapped_bvh();
+
+    /**
+     * Destructor that unmaps the file
+     */
+    virtual ~mapped_bvh();
+
+    // the mapping is owned by exactly one hierarchy
+    mapped_bvh(const mapped_bvh&) = delete;
+    mapped_bvh& operator=(const mapped_bvh&) = delete;
+
+    /**
+     * Maps the given bvh cache file, replacing anything mapped before
+     *
+     * @param kFileName constant reference to the name of the file to map
+     * @param scene_hash the hash of the description of the scene the cache must have been built
+     *     over
+     * @return true if the file was mapped and false if it is missing, truncated, from another
+     *     version or build configuration, built over a different scene, or has nodes that do not
+     *     form a valid hierarchy (the hierarchy is left empty)
+     */
+    bool load(const std::string& kFileName, uint64_t scene_hash);
+
+    // see hittable docs
+    virtual bool intersect(const ray& kRay, real min_t, real max_t,
+        HitRecord& hit_record) const override;
+
+    // see hittable docs
+    virtual bool isOccluded(const ray& kRay, real min_t, real max_t) const override;
+
+    // see hittable docs
+    virtual void finalizeHit(const ray& kRay, HitRecord& hit_record) const override;
+
+    // see hittable docs
+    virtual bool boundingBox(real time0, real time1, aabb& output_box) const override;
+
+    /**
+     * Returns the number of nodes in the hierarchy
+     *
+     * @return a size_t representing the number of nodes in the hierarchy
+     */
+    size_t nodeCount() const;
+
+  private:
+    /**
+     * Unmaps the file, leaving the hierarchy empty
+     */
+    void unmap();
+
+    // start and size in bytes of the mapping of the file (nullptr and 0 if nothing is mapped)
+    void* mapping_;
+    size_t mapping_size_;
+
+    // nodes of the hierarchy in depth first order (root at index 0), inside the mapping
+    const BvhNode* nodes_;
+    size_t node_count_;
+
+    // spheres of the hierarchy in leaf order, inside the mapping
+    const CachedSphere* spheres_;
+};
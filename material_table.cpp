@@ -0,0 +1,57 @@
+#include <algorithm>
+
+#include "material_table.h"
+
+uint32_t material_table::add(std::shared_ptr<Material> material) {
+  const uint32_t kMaterialId = static_cast<uint32_t>(materials_.size());
+  const Material& kMaterial = *material;
+  const std::type_index kType = std::type_index(typeid(kMaterial));
+  const size_t kTypeIndex = std::find(types_.begin(), types_.end(), kType) - types_.begin();
+  if (kTypeIndex == types_.size()) {
+    types_.push_back(kType);
+  }
+  type_indices_.push_back(static_cast<uint32_t>(kTypeIndex));
+
+  // only the exact built in classes are packed, since derived classes may override scatter
+  PackedMaterial packed_material = PackedMaterial();
+  packed_material.kind_ = MaterialKind::kCustom;
+  packed_material.custom_material_ = material.get();
+  if (kType == std::type_index(typeid(Lambertian))) {
+    packed_material.kind_ = MaterialKind::kLambertian;
+    packed_material.albedo_ = static_cast<const Lambertian&>(kMaterial).albedo();
+  } else if (kType == std::type_index(typeid(Metal))) {
+    packed_material.kind_ = MaterialKind::kMetal;
+    packed_material.albedo_ = static_cast<const Metal&>(kMaterial).albedo();
+    packed_material.parameter_ = static_cast<const Metal&>(kMaterial).fuzziness();
+  } else if (kType == std::type_index(typeid(Dielectric))) {
+    packed_material.kind_ = MaterialKind::kDielectric;
+    packed_material.parameter_ = static_cast<const Dielectric&>(kMaterial).indexOfRefraction();
+  }
+  packed_materials_.push_back(packed_material);
+  material_pointers_.push_back(material.get());
+  materials_.push_back(std::move(material));
+
+  // the new material goes after every material of its type (which all have smaller IDs)
+  const std::vector<uint32_t>::iterator kPosition = std::upper_bound(materials_by_type_.begin(), 
+      materials_by_type_.end(), kMaterialId, [this](uint32_t first, uint32_t second) {
+        return type_indices_[first] < type_indices_[second];
+      });
+  materials_by_type_.insert(kPosition, kMaterialId);
+  return kMaterialId;
+}
+
+size_t material_table::size() const {
+  return materials_.size();
+}
+
+uint32_t material_table::typeIndex(uint32_t material_id) const {
+  return type_indices_[material_id];
+}
+
+size_t material_table::typeCount() const {
+  return types_.size();
+}
+
+const std::vector<uint32_t>& material_table::materialsByType() const {
+  return materials_by_type_;
+}
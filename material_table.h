@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <typeindex>
+#include <vector>
+
+#include "Material.h"
+
+/**
+ * Enum listing the kinds of materials that material_table scatters without virtual calls
+ */
+enum class MaterialKind : uint32_t {
+  kLambertian,
+  kMetal,
+  kDielectric,
+  // any other Material, scattered through its virtual scatter
+  kCustom
+};
+
+/**
+ * Struct storing a material as a tag and the parameters of the tagged kind of material, so the 
+ * built in materials can be scattered with a switch that the compiler can inline
+ */
+struct PackedMaterial {
+  // kind of the material
+  MaterialKind kind_;
+
+  // albedo of a Lambertian or Metal material
+  color albedo_;
+
+  // fuzziness of a Metal material, or index of refraction of a Dielectric material
+  real parameter_;
+
+  // the material itself, for kCustom materials
+  const Material* custom_material_;
+};
+
+/**
+ * Class storing the materials of a scene, each identified by a 32-bit material ID
+ *
+ * Hittable objects refer to their material by ID, so hit records stay small and trivially
+ * copyable, and the table owns the materials for as long as the scene is rendered
+ *
+ * Materials of the built in classes (exactly Lambertian, Metal, or Dielectric) are also stored 
+ * as PackedMaterials, which scatter calls through a switch instead of a virtual call. Any other
+ * Material (including classes derived from the built in ones) is still scattered through its 
+ * virtual scatter, so user materials only need to derive from Material
+ */
+class material_table {
+  public:
+    /**
+     * Default Constructor (makes an empty table)
+     */
+    material_table() {}
+
+    /**
+     * Adds the given material to the table
+     *
+     * @param material a shared pointer to the material to add
+     * @return the material ID of the added material
+     */
+    uint32_t add(std::shared_ptr<Material> material);
+
+    /**
+     * Returns the material with the given material ID
+     *
+     * @param material_id the material ID of the material to get (must have been returned by add)
+     * @return a constant reference to the material with the given material ID
+     */
+    inline const Material& get(uint32_t material_id) const {
+      return *material_pointers_[material_id];
+    }
+
+    /**
+     * Scatters or absorbs the given ray off of the material with the given material ID (see 
+     * Material::scatter), dispatching on the kind of the material with a switch
+     *
+     * @param material_id the material ID of the material to scatter off of
+     * @param kRay a constant reference to a ray to be scattered 
+     * @param kHitRecord a constant reference to a HitRecord storing where the ray hit the material
+     * @param attenuation a reference to a color to be updated with how much the given ray is attenuated
+     * @param scattered_ray a reference to a ray to be updated with the scattered ray
+     * @return a bool that is true if the ray was scattered and false if the ray was absorbed
+     */
+    inline bool scatter(uint32_t material_id, const ray& kRay, const HitRecord& kHitRecord, 
+        color& attenuation, ray& scattered_ray) const {
+      const PackedMaterial& kMaterial = packed_materials_[material_id];
+      switch (kMaterial.kind_) {
+        case MaterialKind::kLambertian:
+          return scatterLambertian(kMaterial.albedo_, kRay, kHitRecord, attenuation, scattered_ray);
+        case MaterialKind::kMetal:
+          return scatterMetal(kMaterial.albedo_, kMaterial.parameter_, kRay, kHitRecord, 
+              attenuation, scattered_ray);
+        case MaterialKind::kDielectric:
+          return scatterDielectric(kMaterial.parameter_, kRay, kHitRecord, attenuation, 
+              scattered_ray);
+        default:
+          return kMaterial.custom_material_->scatter(kRay, kHitRecord, attenuation, scattered_ray);
+      }
+    }
+
+    /**
+     * Returns the packed form of the material with the given material ID
+     *
+     * @param material_id the material ID of the material to get
+     * @return a constant reference to the PackedMaterial of the material
+     */
+    inline const PackedMaterial& packed(uint32_t material_id) const {
+      return packed_materials_[material_id];
+    }
+
+    /**
+     * Returns the number of materials in the table
+     *
+     * @return a size_t representing the number of materials in the table
+     */
+    size_t size() const;
+
+    /**
+     * Returns the index of the type (class) of the material with the given material ID
+     *
+     * Types are numbered in the order their first material was added to the table
+     *
+     * @param material_id the material ID of the material to get the type of
+     * @return the index of the type of the material
+     */
+    uint32_t typeIndex(uint32_t material_id) const;
+
+    /**
+     * Returns the number of different types (classes) of materials in the table
+     *
+     * @return a size_t representing the number of types of materials in the table
+     */
+    size_t typeCount() const;
+
+    /**
+     * Returns the material IDs of every material in the table, grouped by type and then 
+     * ordered by ID, which is the order materials are shaded in when hits are sorted
+     *
+     * @return a constant reference to the vector of material IDs ordered by type
+     */
+    const std::vector<uint32_t>& materialsByType() const;
+
+  private:
+    // vector of shared pointers that keep the materials alive, indexed by material ID
+    std::vector<std::shared_ptr<Material>> materials_;
+
+    // vector of raw pointers to the materials, indexed by material ID, used by get
+    std::vector<const Material*> material_pointers_;
+
+    // vector of the packed forms of the materials, indexed by material ID, used by scatter
+    std::vector<PackedMaterial> packed_materials_;
+
+    // vector of the index of the type of every material, indexed by material ID
+    std::vector<uint32_t> type_indices_;
+
+    // vector of the types of the materials in the table, indexed by type index
+    std::vector<std::type_index> types_;
+
+    // vector of every material ID grouped by type and then ordered by ID
+    std::vector<uint32_t> materials_by_type_;
+};
@@ -0,0 +1,96 @@
+#include <algorithm>
+
+#include "morton.h"
+
+// number of bits of the codes sorted by every pass of the radix sort
+const int kRadixBits = 8;
+// number of distinct digits in every pass of the radix sort
+const size_t kRadixSize = size_t(1) << kRadixBits;
+// number of primitives counted and scattered by every task of the radix sort
+const size_t kRadixChunkSize = 1 << 16;
+
+/**
+ * Spreads the lowest 21 bits of the given value out so that two zero bits follow every bit
+ *
+ * @param value the value whose bits to spread
+ * @return a uint64_t with bit i of value moved to bit 3i
+ */
+static uint64_t spreadBits(uint64_t value) {
+  value &= 0x1fffff;
+  value = (value | (value << 32)) & 0x1f00000000ffff;
+  value = (value | (value << 16)) & 0x1f0000ff0000ff;
+  value = (value | (value << 8)) & 0x100f00f00f00f00f;
+  value = (value | (value << 4)) & 0x10c30c30c30c30c3;
+  value = (value | (value << 2)) & 0x1249249249249249;
+  return value;
+}
+
+uint64_t mortonCode(const point3& kPoint, const aabb& kBounds, int code_bits) {
+  const int kBitsPerAxis = code_bits / 3;
+  const real kGridSize = static_cast<real>(uint64_t(1) << kBitsPerAxis);
+  const point3 kMinimum = kBounds.minimum();
+  const vec3 kExtent = kBounds.maximum() - kMinimum;
+  uint64_t code = 0;
+  for (int axis = 0; axis < 3; ++axis) {
+    // points on the maximum face of the box go in the last cell rather than past it
+    real cell = 0;
+    if (kExtent[axis] > 0) {
+      cell = std::min((kPoint[axis] - kMinimum[axis]) / kExtent[axis] * kGridSize, kGridSize - 1);
+    }
+    code |= spreadBits(static_cast<uint64_t>(std::max(cell, real(0)))) << (2 - axis);
+  }
+  return code;
+}
+
+void radixSortMortonPrimitives(std::vector<MortonPrimitive>& primitives, int code_bits,
+    thread_pool& pool) {
+  if (primitives.empty()) {
+    return;
+  }
+  const size_t kNumChunks = (primitives.size() + kRadixChunkSize - 1) / kRadixChunkSize;
+  std::vector<MortonPrimitive> sorted = std::vector<MortonPrimitive>(primitives.size());
+  // chunk_offsets[chunk * kRadixSize + digit] is where the chunk writes its next primitive with
+  // that digit
+  std::vector<size_t> chunk_offsets = std::vector<size_t>(kNumChunks * kRadixSize);
+
+  for (int shift = 0; shift < code_bits; shift += kRadixBits) {
+    const auto kCountChunk = [&](size_t chunk) {
+      size_t* counts = &chunk_offsets[chunk * kRadixSize];
+      std::fill(counts, counts + kRadixSize, 0);
+      const size_t kEnd = std::min((chunk + 1) * kRadixChunkSize, primitives.size());
+      for (size_t i = chunk * kRadixChunkSize; i < kEnd; ++i) {
+        ++counts[(primitives[i].code_ >> shift) & (kRadixSize - 1)];
+      }
+    };
+    if (kNumChunks > 1) {
+      pool.parallelFor(kNumChunks, kCountChunk);
+    } else {
+      kCountChunk(0);
+    }
+
+    // a digit's primitives go after every smaller digit's, and within a digit the chunks go in
+    // order, which keeps every pass stable
+    size_t offset = 0;
+    for (size_t digit = 0; digit < kRadixSize; ++digit) {
+      for (size_t chunk = 0; chunk < kNumChunks; ++chunk) {
+        const size_t kCount = chunk_offsets[(chunk * kRadixSize) + digit];
+        chunk_offsets[(chunk * kRadixSize) + digit] = offset;
+        offset += kCount;
+      }
+    }
+
+    const auto kScatterChunk = [&](size_t chunk) {
+      size_t* offsets = &chunk_offsets[chunk * kRadixSize];
+      const size_t kEnd = std::min((chunk + 1) * kRadixChunkSize, primitives.size());
+      for (size_t i = chunk * kRadixChunkSize; i < kEnd; ++i) {
+        sorted[offsets[(primitives[i].code_ >> shift) & (kRadixSize - 1)]++] = primitives[i];
+      }
+    };
+    if (kNumChunks > 1) {
+      pool.parallelFor(kNumChunks, kScatterChunk);
+    } else {
+      kScatterChunk(0);
+    }
+    primitives.swap(sorted);
+  }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "aabb.h"
+#include "thread_pool.h"
+#include "vec3.h"
+
+/**
+ * Struct storing the Morton code of an object and the index of the object
+ */
+struct MortonPrimitive {
+  // position of the object along the Morton (Z-order) curve
+  uint64_t code_;
+
+  // index of the object in the list the codes were computed for
+  uint32_t object_index_;
+};
+
+/**
+ * Computes the Morton code of the given point, which interleaves the bits of its x, y, and z
+ * coordinates quantized to a grid over the given box
+ *
+ * @param kPoint constant reference to the point to compute the code of
+ * @param kBounds constant reference to the box to quantize the point within
+ * @param code_bits the number of bits in the code (30 for 10 bits per axis or 63 for 21 bits
+ *     per axis)
+ * @return a uint64_t storing the Morton code of the point in its lowest code_bits bits
+ */
+uint64_t mortonCode(const point3& kPoint, const aabb& kBounds, int code_bits);
+
+/**
+ * Stably sorts the given primitives by their Morton codes with a least significant digit radix
+ * sort, counting and scattering every pass in chunks on the given pool
+ *
+ * @param primitives reference to the vector of primitives to sort
+ * @param code_bits the number of low bits of the codes to sort by (higher bits are ignored)
+ * @param pool reference to the thread pool to sort on
+ */
+void radixSortMortonPrimitives(std::vector<MortonPrimitive>& primitives, int code_bits,
+    thread_pool& pool);
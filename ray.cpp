@@ -11,6 +11,6 @@ vec3 ray::direction() const {
   return direction_;
 }
 
-point3 ray::at(double t) const {
+point3 ray::at(real t) const {
   return origin_ + (direction_ * t);
 }
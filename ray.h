@@ -39,10 +39,10 @@ class ray {
     /**
      * Calculates the position along the ray at the given t value
      * 
-     * @param t a double representing the t value to get the position at
+     * @param t a real representing the t value to get the position at
      * @return a point3 representing the position along the ray at the given t value
      */ 
-    point3 at(double t) const;
+    point3 at(real t) const;
 
   private:
     // point3 storing the ray's origin
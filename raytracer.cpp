@@ -0,0 +1,50 @@
+// Unity build of every module of the raytracer: the raytracer (main.cpp) and the tests 
+// (tests/*.cpp) link against this one translation unit, so the compiler sees all of the code 
+// at once, as if it were a single file
+
+#include "aabb.h"
+#include "aabb.cpp"
+#include "affine_transform.h"
+#include "affine_transform.cpp"
+#include "benchmark.h"
+#include "benchmark.cpp"
+#include "bvh.h"
+#include "bvh.cpp"
+#include "camera.h"
+#include "camera.cpp"
+#include "compressed_bvh.h"
+#include "compressed_bvh.cpp"
+#include "constants_and_utilities.h"
+#include "constants_and_utilities.cpp"
+#include "Hittable.h"
+#include "hittable_list.h"
+#include "hittable_list.cpp"
+#include "image_compare.h"
+#include "image_compare.cpp"
+#include "instance.h"
+#include "instance.cpp"
+#include "mapped_bvh.h"
+#include "mapped_bvh.cpp"
+#include "Material.h"
+#include "material_table.h"
+#include "material_table.cpp"
+#include "morton.h"
+#include "morton.cpp"
+#include "ray.h"
+#include "ray.cpp"
+#include "renderer.h"
+#include "renderer.cpp"
+#include "scenes.h"
+#include "scenes.cpp"
+#include "sphere.h"
+#include "sphere.cpp"
+#include "sphere_set.h"
+#include "sphere_set.cpp"
+#include "thread_pool.h"
+#include "thread_pool.cpp"
+#include "vec3.h"
+#include "vec3.cpp"
+#include "wavefront.h"
+#include "wavefront.cpp"
+#include "wide_bvh.h"
+#include "wide_bvh.cpp"
@@ -0,0 +1,404 @@
+#pragma once
+
+/**
+ * Compile-time selectable backends for arithmetic on several independent reals at once
+ *
+ * Where vec3_simd.h keeps the x, y, and z of one vector in a register, RealLanes keeps the same
+ * quantity for several different objects in a register (one object per lane), which is what
+ * structure of arrays (SoA) primitives like sphere_set need. The backend follows the same
+ * build options as vec3_simd.h (though AVX2 builds keep the scalar vec3):
+ *   RAYTRACER_SIMD_AVX2   4 doubles or 8 floats per register
+ *   RAYTRACER_SIMD_SSE4   2 doubles or 4 floats per register
+ *   neither               1 real per "register" (plain scalar code)
+ *
+ * Every backend provides the same interface:
+ *   RealLanes                          the register form of kRealLaneCount reals
+ *   realLanesBroadcast                 copies one real into every lane
+ *   realLanesLoad / realLanesStore     move kRealLaneCount reals between memory (which does not
+ *                                      have to be aligned) and a register
+ *   realLanesAdd / realLanesSubtract / realLanesMultiply / realLanesDivide   lane-wise arithmetic
+ *   realLanesSqrt                      lane-wise square root (NaN for negative lanes)
+ *   realLanesNegate                    flips the sign of every lane
+ *   realLanesMin / realLanesMax        lane-wise first < second ? first : second (and >), so a
+ *                                      NaN in the first lanes gives the second lanes
+ *   realLanesLessEqualMask             bit i of the result is set when lane i of the first is
+ *                                      <= lane i of the second
+ *   realLanesSelectInRange             keeps the lanes that are in [min, max] (NaN lanes never
+ *                                      are) and replaces the others with a fallback
+ *   realLanesSelectNegative            takes the lanes of one register where the sign bit of a
+ *                                      selector is set and the lanes of another elsewhere
+ *
+ * Every operation rounds exactly like the same scalar operation, so SoA code built on RealLanes
+ * gives bit-identical results to the scalar code it replaces
+ */
+
+#if defined(RAYTRACER_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(RAYTRACER_SIMD_SSE4)
+#include <smmintrin.h>
+#endif
+
+#include <cmath>
+
+#include "constants_and_utilities.h"
+
+#if defined(RAYTRACER_SIMD_AVX2) && defined(RAYTRACER_USE_FLOAT)
+
+// number of reals in a RealLanes
+const int kRealLaneCount = 8;
+
+/**
+ * Struct storing 8 floats in a 256 bit register
+ */
+struct RealLanes {
+  __m256 values_;
+};
+
+inline RealLanes realLanesBroadcast(float value) {
+  return RealLanes{_mm256_set1_ps(value)};
+}
+
+inline RealLanes realLanesLoad(const float* kData) {
+  return RealLanes{_mm256_loadu_ps(kData)};
+}
+
+inline void realLanesStore(float* data, RealLanes lanes) {
+  _mm256_storeu_ps(data, lanes.values_);
+}
+
+inline RealLanes realLanesAdd(RealLanes first, RealLanes second) {
+  return RealLanes{_mm256_add_ps(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesSubtract(RealLanes first, RealLanes second) {
+  return RealLanes{_mm256_sub_ps(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesMultiply(RealLanes first, RealLanes second) {
+  return RealLanes{_mm256_mul_ps(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesDivide(RealLanes first, RealLanes second) {
+  return RealLanes{_mm256_div_ps(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesSqrt(RealLanes lanes) {
+  return RealLanes{_mm256_sqrt_ps(lanes.values_)};
+}
+
+inline RealLanes realLanesNegate(RealLanes lanes) {
+  return RealLanes{_mm256_xor_ps(lanes.values_, _mm256_set1_ps(-0.0f))};
+}
+
+inline RealLanes realLanesMin(RealLanes first, RealLanes second) {
+  return RealLanes{_mm256_min_ps(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesMax(RealLanes first, RealLanes second) {
+  return RealLanes{_mm256_max_ps(first.values_, second.values_)};
+}
+
+inline int realLanesLessEqualMask(RealLanes first, RealLanes second) {
+  return _mm256_movemask_ps(_mm256_cmp_ps(first.values_, second.values_, _CMP_LE_OQ));
+}
+
+inline RealLanes realLanesSelectInRange(RealLanes values, RealLanes min, RealLanes max,
+    RealLanes fallback) {
+  const __m256 kInRange = _mm256_and_ps(_mm256_cmp_ps(values.values_, min.values_, _CMP_GE_OQ),
+      _mm256_cmp_ps(values.values_, max.values_, _CMP_LE_OQ));
+  return RealLanes{_mm256_blendv_ps(fallback.values_, values.values_, kInRange)};
+}
+
+inline RealLanes realLanesSelectNegative(RealLanes selector, RealLanes if_negative,
+    RealLanes otherwise) {
+  return RealLanes{_mm256_blendv_ps(otherwise.values_, if_negative.values_, selector.values_)};
+}
+
+#elif defined(RAYTRACER_SIMD_AVX2)
+
+// number of reals in a RealLanes
+const int kRealLaneCount = 4;
+
+/**
+ * Struct storing 4 doubles in a 256 bit register
+ */
+struct RealLanes {
+  __m256d values_;
+};
+
+inline RealLanes realLanesBroadcast(double value) {
+  return RealLanes{_mm256_set1_pd(value)};
+}
+
+inline RealLanes realLanesLoad(const double* kData) {
+  return RealLanes{_mm256_loadu_pd(kData)};
+}
+
+inline void realLanesStore(double* data, RealLanes lanes) {
+  _mm256_storeu_pd(data, lanes.values_);
+}
+
+inline RealLanes realLanesAdd(RealLanes first, RealLanes second) {
+  return RealLanes{_mm256_add_pd(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesSubtract(RealLanes first, RealLanes second) {
+  return RealLanes{_mm256_sub_pd(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesMultiply(RealLanes first, RealLanes second) {
+  return RealLanes{_mm256_mul_pd(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesDivide(RealLanes first, RealLanes second) {
+  return RealLanes{_mm256_div_pd(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesSqrt(RealLanes lanes) {
+  return RealLanes{_mm256_sqrt_pd(lanes.values_)};
+}
+
+inline RealLanes realLanesNegate(RealLanes lanes) {
+  return RealLanes{_mm256_xor_pd(lanes.values_, _mm256_set1_pd(-0.0))};
+}
+
+inline RealLanes realLanesMin(RealLanes first, RealLanes second) {
+  return RealLanes{_mm256_min_pd(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesMax(RealLanes first, RealLanes second) {
+  return RealLanes{_mm256_max_pd(first.values_, second.values_)};
+}
+
+inline int realLanesLessEqualMask(RealLanes first, RealLanes second) {
+  return _mm256_movemask_pd(_mm256_cmp_pd(first.values_, second.values_, _CMP_LE_OQ));
+}
+
+inline RealLanes realLanesSelectInRange(RealLanes values, RealLanes min, RealLanes max,
+    RealLanes fallback) {
+  const __m256d kInRange = _mm256_and_pd(_mm256_cmp_pd(values.values_, min.values_, _CMP_GE_OQ),
+      _mm256_cmp_pd(values.values_, max.values_, _CMP_LE_OQ));
+  return RealLanes{_mm256_blendv_pd(fallback.values_, values.values_, kInRange)};
+}
+
+inline RealLanes realLanesSelectNegative(RealLanes selector, RealLanes if_negative,
+    RealLanes otherwise) {
+  return RealLanes{_mm256_blendv_pd(otherwise.values_, if_negative.values_, selector.values_)};
+}
+
+#elif defined(RAYTRACER_SIMD_SSE4) && defined(RAYTRACER_USE_FLOAT)
+
+// number of reals in a RealLanes
+const int kRealLaneCount = 4;
+
+/**
+ * Struct storing 4 floats in a 128 bit register
+ */
+struct RealLanes {
+  __m128 values_;
+};
+
+inline RealLanes realLanesBroadcast(float value) {
+  return RealLanes{_mm_set1_ps(value)};
+}
+
+inline RealLanes realLanesLoad(const float* kData) {
+  return RealLanes{_mm_loadu_ps(kData)};
+}
+
+inline void realLanesStore(float* data, RealLanes lanes) {
+  _mm_storeu_ps(data, lanes.values_);
+}
+
+inline RealLanes realLanesAdd(RealLanes first, RealLanes second) {
+  return RealLanes{_mm_add_ps(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesSubtract(RealLanes first, RealLanes second) {
+  return RealLanes{_mm_sub_ps(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesMultiply(RealLanes first, RealLanes second) {
+  return RealLanes{_mm_mul_ps(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesDivide(RealLanes first, RealLanes second) {
+  return RealLanes{_mm_div_ps(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesSqrt(RealLanes lanes) {
+  return RealLanes{_mm_sqrt_ps(lanes.values_)};
+}
+
+inline RealLanes realLanesNegate(RealLanes lanes) {
+  return RealLanes{_mm_xor_ps(lanes.values_, _mm_set1_ps(-0.0f))};
+}
+
+inline RealLanes realLanesMin(RealLanes first, RealLanes second) {
+  return RealLanes{_mm_min_ps(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesMax(RealLanes first, RealLanes second) {
+  return RealLanes{_mm_max_ps(first.values_, second.values_)};
+}
+
+inline int realLanesLessEqualMask(RealLanes first, RealLanes second) {
+  return _mm_movemask_ps(_mm_cmple_ps(first.values_, second.values_));
+}
+
+inline RealLanes realLanesSelectInRange(RealLanes values, RealLanes min, RealLanes max,
+    RealLanes fallback) {
+  const __m128 kInRange = _mm_and_ps(_mm_cmpge_ps(values.values_, min.values_),
+      _mm_cmple_ps(values.values_, max.values_));
+  return RealLanes{_mm_blendv_ps(fallback.values_, values.values_, kInRange)};
+}
+
+inline RealLanes realLanesSelectNegative(RealLanes selector, RealLanes if_negative,
+    RealLanes otherwise) {
+  return RealLanes{_mm_blendv_ps(otherwise.values_, if_negative.values_, selector.values_)};
+}
+
+#elif defined(RAYTRACER_SIMD_SSE4)
+
+// number of reals in a RealLanes
+const int kRealLaneCount = 2;
+
+/**
+ * Struct storing 2 doubles in a 128 bit register
+ */
+struct RealLanes {
+  __m128d values_;
+};
+
+inline RealLanes realLanesBroadcast(double value) {
+  return RealLanes{_mm_set1_pd(value)};
+}
+
+inline RealLanes realLanesLoad(const double* kData) {
+  return RealLanes{_mm_loadu_pd(kData)};
+}
+
+inline void realLanesStore(double* data, RealLanes lanes) {
+  _mm_storeu_pd(data, lanes.values_);
+}
+
+inline RealLanes realLanesAdd(RealLanes first, RealLanes second) {
+  return RealLanes{_mm_add_pd(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesSubtract(RealLanes first, RealLanes second) {
+  return RealLanes{_mm_sub_pd(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesMultiply(RealLanes first, RealLanes second) {
+  return RealLanes{_mm_mul_pd(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesDivide(RealLanes first, RealLanes second) {
+  return RealLanes{_mm_div_pd(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesSqrt(RealLanes lanes) {
+  return RealLanes{_mm_sqrt_pd(lanes.values_)};
+}
+
+inline RealLanes realLanesNegate(RealLanes lanes) {
+  return RealLanes{_mm_xor_pd(lanes.values_, _mm_set1_pd(-0.0))};
+}
+
+inline RealLanes realLanesMin(RealLanes first, RealLanes second) {
+  return RealLanes{_mm_min_pd(first.values_, second.values_)};
+}
+
+inline RealLanes realLanesMax(RealLanes first, RealLanes second) {
+  return RealLanes{_mm_max_pd(first.values_, second.values_)};
+}
+
+inline int realLanesLessEqualMask(RealLanes first, RealLanes second) {
+  return _mm_movemask_pd(_mm_cmple_pd(first.values_, second.values_));
+}
+
+inline RealLanes realLanesSelectInRange(RealLanes values, RealLanes min, RealLanes max,
+    RealLanes fallback) {
+  const __m128d kInRange = _mm_and_pd(_mm_cmpge_pd(values.values_, min.values_),
+      _mm_cmple_pd(values.values_, max.values_));
+  return RealLanes{_mm_blendv_pd(fallback.values_, values.values_, kInRange)};
+}
+
+inline RealLanes realLanesSelectNegative(RealLanes selector, RealLanes if_negative,
+    RealLanes otherwise) {
+  return RealLanes{_mm_blendv_pd(otherwise.values_, if_negative.values_, selector.values_)};
+}
+
+#else
+
+// number of reals in a RealLanes
+const int kRealLaneCount = 1;
+
+/**
+ * Struct storing a single real (the scalar backend)
+ */
+struct RealLanes {
+  real value_;
+};
+
+inline RealLanes realLanesBroadcast(real value) {
+  return RealLanes{value};
+}
+
+inline RealLanes realLanesLoad(const real* kData) {
+  return RealLanes{kData[0]};
+}
+
+inline void realLanesStore(real* data, RealLanes lanes) {
+  data[0] = lanes.value_;
+}
+
+inline RealLanes realLanesAdd(RealLanes first, RealLanes second) {
+  return RealLanes{first.value_ + second.value_};
+}
+
+inline RealLanes realLanesSubtract(RealLanes first, RealLanes second) {
+  return RealLanes{first.value_ - second.value_};
+}
+
+inline RealLanes realLanesMultiply(RealLanes first, RealLanes second) {
+  return RealLanes{first.value_ * second.value_};
+}
+
+inline RealLanes realLanesDivide(RealLanes first, RealLanes second) {
+  return RealLanes{first.value_ / second.value_};
+}
+
+inline RealLanes realLanesSqrt(RealLanes lanes) {
+  return RealLanes{std::sqrt(lanes.value_)};
+}
+
+inline RealLanes realLanesNegate(RealLanes lanes) {
+  return RealLanes{-lanes.value_};
+}
+
+inline RealLanes realLanesMin(RealLanes first, RealLanes second) {
+  return RealLanes{first.value_ < second.value_ ? first.value_ : second.value_};
+}
+
+inline RealLanes realLanesMax(RealLanes first, RealLanes second) {
+  return RealLanes{first.value_ > second.value_ ? first.value_ : second.value_};
+}
+
+inline int realLanesLessEqualMask(RealLanes first, RealLanes second) {
+  return first.value_ <= second.value_ ? 1 : 0;
+}
+
+inline RealLanes realLanesSelectInRange(RealLanes values, RealLanes min, RealLanes max,
+    RealLanes fallback) {
+  const bool kInRange = values.value_ >= min.value_ && values.value_ <= max.value_;
+  return RealLanes{kInRange ? values.value_ : fallback.value_};
+}
+
+inline RealLanes realLanesSelectNegative(RealLanes selector, RealLanes if_negative,
+    RealLanes otherwise) {
+  return RealLanes{std::signbit(selector.value_) ? if_negative.value_ : otherwise.value_};
+}
+
+#endif
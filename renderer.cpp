@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+#include "renderer.h"
+#include "thread_pool.h"
+#include "wavefront.h"
+
+void RenderStatistics::add(const RenderStatistics& kOther) {
+  num_paths_ += kOther.num_paths_;
+  num_bounces_ += kOther.num_bounces_;
+  if (material_shade_counts_.size() < kOther.material_shade_counts_.size()) {
+    material_shade_counts_.resize(kOther.material_shade_counts_.size());
+    material_shade_seconds_.resize(kOther.material_shade_counts_.size());
+  }
+  for (size_t i = 0; i < kOther.material_shade_counts_.size(); ++i) {
+    material_shade_counts_[i] += kOther.material_shade_counts_[i];
+    material_shade_seconds_[i] += kOther.material_shade_seconds_[i];
+  }
+}
+
+PathState startPath(const ray& kRay, size_t max_bounces) {
+  PathState path = PathState();
+  path.ray_ = kRay;
+  path.throughput_ = color(1, 1, 1);
+  path.radiance_ = color(0, 0, 0);
+  path.bounces_remaining_ = max_bounces;
+  path.bounces_ = 0;
+  return path;
+}
+
+bool advancePath(PathState& path, const Hittable& kObjects, const material_table& kMaterials,
+    const RenderSettings& kSettings) {
+  // gather no more light after the bounce limit has been exceeded
+  if (path.bounces_remaining_ == 0) {
+    return false;
+  }
+  --path.bounces_remaining_;
+  ++path.bounces_;
+
+  // every bounce of a path draws from its own random stream
+  nextRandomBounce();
+
+  // find closest hit object (if an object was hit)
+  // ignore hits that are extremely close to 0 to fix shadow acne
+  const real kMinT = 0.001;
+  HitRecord hit_record = HitRecord();
+  const bool kWasHit = kObjects.wasHit(path.ray_, kMinT, infinity, hit_record);
+  return shadeBounce(path, kWasHit, hit_record, kMaterials, kSettings);
+}
+
+bool shadeBounce(PathState& path, bool was_hit, const HitRecord& kHitRecord, 
+    const material_table& kMaterials, const RenderSettings& kSettings) {
+  if (!was_hit) {
+    // the path ends in the background
+    path.radiance_ += path.throughput_ * backgroundColor(path.ray_);
+    return false;
+  }
+
+  // if an object is hit, scatter the light according to the material of the hit object
+  // (an absorbed path gathers no more light)
+  ray scattered_ray;
+  color attenuation;
+  if (!scatterHit(kMaterials, kHitRecord.material_id_, kSettings, path.ray_, kHitRecord, 
+      attenuation, scattered_ray)) {
+    return false;
+  }
+  path.throughput_ = path.throughput_ * attenuation;
+  path.ray_ = scattered_ray;
+  return survivesRussianRoulette(path.throughput_, path.bounces_, kSettings);
+}
+
+bool survivesRussianRoulette(color& throughput, size_t bounces, const RenderSettings& kSettings) {
+  if (!kSettings.use_russian_roulette_ || bounces < kSettings.russian_roulette_min_bounces_) {
+    return true;
+  }
+  // end dim paths at random, and boost the survivors to make up for the light of the ended paths
+  const real kSurvivalProbability = std::min<real>(1, std::max(throughput.x(), 
+      std::max(throughput.y(), throughput.z())));
+  if (randomDouble() >= kSurvivalProbability) {
+    return false;
+  }
+  throughput = throughput / kSurvivalProbability;
+  return true;
+}
+
+color backgroundColor(const ray& kRay) {
+  const vec3 kUnitVector = unitVector(kRay.direction());
+  // midpoint of unit y component and 1.0 (ensures 0 <= t <= 1)
+  const real t = 0.5 * (kUnitVector.y() + 1.0);
+  // starting color for the lerp
+  const color kWhite = color(1, 1, 1);
+  // ending color for the lerp
+  const color kLightBlue = color(0.5, 0.7, 1.0);
+  // lerp white and light blue based on t
+  return (kWhite * (1.0 - t)) + (kLightBlue * t);
+}
+
+ray cameraRay(const camera& kCamera, const RenderSettings& kSettings, int row, int column,
+    uint32_t sample_index) {
+  const int kWidth = kSettings.image_width_;
+  const int kHeight = kSettings.image_height_;
+  // rows are stored top to bottom, while i counts up from the bottom of the viewport
+  const int i = kHeight - 1 - row;
+  // the camera ray of every sample draws from bounce 0 of the sample's stream
+  setRandomStream((static_cast<size_t>(row) * kWidth) + column, sample_index, 0);
+  const real kHorizontalFactor = (column + randomDouble()) / (kWidth - 1);
+  const real kVerticalFactor = (i + randomDouble()) / (kHeight - 1);
+  return kCamera.getRay(kHorizontalFactor, kVerticalFactor);
+}
+
+void renderTile(const camera& kCamera, const Hittable& kObjects, const material_table& kMaterials,
+    const RenderSettings& kSettings, const ImageTile& kTile, std::vector<color>& framebuffer,
+    RenderStatistics& statistics) {
+  for (int row = kTile.first_row_; row < kTile.end_row_; ++row) {
+    for (int j = kTile.first_column_; j < kTile.end_column_; ++j) {
+      // antialiasing sampling
+      color pixel_color = color(); // defaults to zero vector
+      for (int k = 0; k < kSettings.samples_per_pixel_; ++k) {
+        const ray kRay = cameraRay(kCamera, kSettings, row, j, static_cast<uint32_t>(k));
+        PathState path = startPath(kRay, kSettings.max_ray_bounces_);
+        while (advancePath(path, kObjects, kMaterials, kSettings)) {}
+        pixel_color += path.radiance_;
+        ++statistics.num_paths_;
+        statistics.num_bounces_ += path.bounces_;
+      }
+      framebuffer[(static_cast<size_t>(row) * kSettings.image_width_) + j] = pixel_color;
+    }
+  }
+}
+
+void renderTilePackets(const camera& kCamera, const Hittable& kObjects, 
+    const material_table& kMaterials, const RenderSettings& kSettings, const ImageTile& kTile, 
+    std::vector<color>& framebuffer, RenderStatistics& statistics) {
+  // width and height of the blocks of pixels whose camera rays are traced as one packet
+  const int kBlockWidth = kSettings.ray_packet_size_ == 4 ? 2 : 4;
+  const int kBlockHeight = kSettings.ray_packet_size_ / kBlockWidth;
+  // ignore hits that are extremely close to 0 to fix shadow acne
+  const real kMinT = 0.001;
+
+  RayPacket packet = RayPacket();
+  int pixel_rows[kMaxRayPacketSize];
+  int pixel_columns[kMaxRayPacketSize];
+  color pixel_colors[kMaxRayPacketSize];
+  for (int block_row = kTile.first_row_; block_row < kTile.end_row_; block_row += kBlockHeight) {
+    for (int block_column = kTile.first_column_; block_column < kTile.end_column_; 
+        block_column += kBlockWidth) {
+      // blocks at the edges of the tile are cut down to the pixels inside it
+      size_t num_pixels = 0;
+      for (int row = block_row; row < std::min(block_row + kBlockHeight, kTile.end_row_); ++row) {
+        for (int j = block_column; j < std::min(block_column + kBlockWidth, kTile.end_column_); 
+            ++j) {
+          pixel_rows[num_pixels] = row;
+          pixel_columns[num_pixels] = j;
+          pixel_colors[num_pixels] = color(); // defaults to zero vector
+          ++num_pixels;
+        }
+      }
+
+      for (int k = 0; k < kSettings.samples_per_pixel_; ++k) {
+        packet.clear();
+        for (size_t p = 0; p < num_pixels; ++p) {
+          packet.add(cameraRay(kCamera, kSettings, pixel_rows[p], pixel_columns[p], 
+              static_cast<uint32_t>(k)), infinity);
+        }
+        if (kSettings.max_ray_bounces_ > 0) {
+          kObjects.intersectPacket(packet, kMinT);
+        }
+
+        for (size_t p = 0; p < num_pixels; ++p) {
+          PathState path = startPath(packet.rays_[p], kSettings.max_ray_bounces_);
+          if (path.bounces_remaining_ > 0) {
+            // the packet took the first bounce of the path, which draws from the same stream as 
+            // when the path is traced alone (see advancePath)
+            --path.bounces_remaining_;
+            ++path.bounces_;
+            setRandomStream((static_cast<size_t>(pixel_rows[p]) * kSettings.image_width_) 
+                + pixel_columns[p], static_cast<uint32_t>(k), 1);
+            HitRecord& hit_record = packet.hit_records_[p];
+            if (packet.was_hit_[p]) {
+              hit_record.hit_object_->finalizeHit(path.ray_, hit_record);
+            }
+            // scattered rays diverge, so the rest of the path is traced alone
+            if (shadeBounce(path, packet.was_hit_[p], hit_record, kMaterials, kSettings)) {
+              while (advancePath(path, kObjects, kMaterials, kSettings)) {}
+            }
+          }
+          pixel_colors[p] += path.radiance_;
+          ++statistics.num_paths_;
+          statistics.num_bounces_ += path.bounces_;
+        }
+      }
+
+      for (size_t p = 0; p < num_pixels; ++p) {
+        framebuffer[(static_cast<size_t>(pixel_rows[p]) * kSettings.image_width_) 
+            + pixel_columns[p]] = pixel_colors[p];
+      }
+    }
+  }
+}
+
+std::vector<color> renderImage(const camera& kCamera, const Hittable& kObjects,
+    const material_table& kMaterials, const RenderSettings& kSettings) {
+  RenderStatistics statistics = RenderStatistics();
+  return renderImage(kCamera, kObjects, kMaterials, kSettings, statistics);
+}
+
+std::vector<color> renderImage(const camera& kCamera, const Hittable& kObjects,
+    const material_table& kMaterials, const RenderSettings& kSettings, 
+    RenderStatistics& statistics) {
+  const int kPacketSize = kSettings.ray_packet_size_;
+  if (kPacketSize != 0 && kPacketSize != 1 && kPacketSize != 4 && kPacketSize != 8 
+      && kPacketSize != 16) {
+    throw std::invalid_argument("renderImage: the ray packet size must be 0, 1, 4, 8, or 16");
+  }
+  const int kWidth = kSettings.image_width_;
+  const int kHeight = kSettings.image_height_;
+  const int kTileSize = kSettings.tile_size_;
+  const int kTilesPerRow = (kWidth + kTileSize - 1) / kTileSize;
+  const int kTilesPerColumn = (kHeight + kTileSize - 1) / kTileSize;
+  const size_t kNumTiles = static_cast<size_t>(kTilesPerRow) * kTilesPerColumn;
+
+  // every tile writes only its own pixels, so the framebuffer needs no locking
+  std::vector<color> framebuffer = std::vector<color>(static_cast<size_t>(kWidth) * kHeight);
+  std::mutex progress_mutex;
+  size_t tiles_remaining = kNumTiles;
+  statistics = RenderStatistics();
+
+  thread_pool pool(kSettings.num_threads_);
+  pool.parallelFor(kNumTiles, [&](size_t tile_index) {
+    ImageTile tile = ImageTile();
+    tile.first_row_ = static_cast<int>(tile_index / kTilesPerRow) * kTileSize;
+    tile.first_column_ = static_cast<int>(tile_index % kTilesPerRow) * kTileSize;
+    tile.end_row_ = std::min(tile.first_row_ + kTileSize, kHeight);
+    tile.end_column_ = std::min(tile.first_column_ + kTileSize, kWidth);
+
+    RenderStatistics tile_statistics = RenderStatistics();
+    if (kSettings.use_wavefront_) {
+      renderTileWavefront(kCamera, kObjects, kMaterials, kSettings, tile, framebuffer, 
+          tile_statistics);
+    } else if (kPacketSize > 1) {
+      renderTilePackets(kCamera, kObjects, kMaterials, kSettings, tile, framebuffer, 
+          tile_statistics);
+    } else {
+      renderTile(kCamera, kObjects, kMaterials, kSettings, tile, framebuffer, tile_statistics);
+    }
+
+    std::lock_guard<std::mutex> lock(progress_mutex);
+    statistics.add(tile_statistics);
+    --tiles_remaining;
+    std::cerr << "\rTiles remaining: " << tiles_remaining << ' ' << std::flush;
+  });
+  return framebuffer;
+}
+
+void writePpmImage(std::ostream& stream, const std::vector<color>& kFramebuffer,
+    const RenderSettings& kSettings) {
+  // P3 means that the colors are in ASCII
+  stream << "P3\n";
+  // Specifies image width and height
+  stream << kSettings.image_width_ << " " << kSettings.image_height_ << "\n";
+  // Specifies the max color for the RGB triplets
+  const int kMaxColor = 255;
+  stream << kMaxColor << "\n";
+
+  // pixels are written out in rows from top to bottom that go left to right
+  for (const color& kPixelColor : kFramebuffer) {
+    writeColor(stream, kPixelColor, kSettings.samples_per_pixel_);
+  }
+}
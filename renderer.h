@@ -0,0 +1,314 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+
+#include "camera.h"
+#include "Hittable.h"
+#include "material_table.h"
+#include "ray.h"
+#include "vec3.h"
+
+/**
+ * Struct storing the settings used to render an image
+ */
+struct RenderSettings {
+  // int representing the width of the image in pixels
+  int image_width_;
+
+  // int representing the height of the image in pixels
+  int image_height_;
+
+  // int representing the number of color samples taken per pixel
+  int samples_per_pixel_;
+
+  // size_t representing the maximum number of times a ray may bounce
+  size_t max_ray_bounces_;
+
+  // int representing the width and height of the square tiles the image is split into
+  int tile_size_;
+
+  // size_t representing the number of threads to render with (0 uses one per hardware thread)
+  size_t num_threads_;
+
+  // bool that is true if paths may be ended early by Russian roulette
+  bool use_russian_roulette_;
+
+  // size_t representing the number of bounces every path takes before Russian roulette may end it
+  size_t russian_roulette_min_bounces_;
+
+  // bool that is true if tiles are traced as a wavefront (see wavefront.h) instead of one path 
+  // at a time
+  bool use_wavefront_;
+
+  // bool that is true if the wavefront groups hits by material before shading them
+  bool sort_by_material_;
+
+  // bool that is true if hits are scattered through the virtual Material::scatter instead of 
+  // the switch of material_table::scatter (for comparing the two)
+  bool use_virtual_materials_;
+
+  // int representing the number of camera rays traced together as a packet (4 for 2x2 blocks 
+  // of pixels, 8 for 4x2 blocks, or 16 for 4x4 blocks), or 0 or 1 to trace every camera ray on 
+  // its own (ignored by the wavefront)
+  int ray_packet_size_;
+};
+
+/**
+ * Struct storing the rows and columns of a rectangular tile of an image
+ */
+struct ImageTile {
+  // int representing the first row of the tile (rows count down from the top of the image)
+  int first_row_;
+
+  // int representing one past the last row of the tile
+  int end_row_;
+
+  // int representing the first column of the tile
+  int first_column_;
+
+  // int representing one past the last column of the tile
+  int end_column_;
+};
+
+/**
+ * Struct storing counts gathered while rendering an image
+ */
+struct RenderStatistics {
+  // size_t representing the number of paths traced (one per sample)
+  size_t num_paths_;
+
+  // size_t representing the total number of bounces (closest hit queries) of every path traced
+  size_t num_bounces_;
+
+  // number of hits shaded with every material, indexed by material ID (only counted by the 
+  // wavefront)
+  std::vector<size_t> material_shade_counts_;
+
+  // seconds spent shading hits with every material, indexed by material ID (only timed by the 
+  // wavefront when it groups hits by material)
+  std::vector<double> material_shade_seconds_;
+
+  /**
+   * Adds the counts of the given statistics to these statistics
+   *
+   * @param kOther constant reference to the statistics to add
+   */
+  void add(const RenderStatistics& kOther);
+
+  /**
+   * Returns the average number of bounces of the paths traced
+   *
+   * @return a double representing the average path length (0 if no paths were traced)
+   */
+  inline double averagePathLength() const {
+    return num_paths_ == 0 ? 0 : static_cast<double>(num_bounces_) / num_paths_;
+  }
+};
+
+/**
+ * Struct storing the state of a path being traced one bounce at a time
+ *
+ * A path carries the ray it continues along, the product of the attenuations of every
+ * surface it has scattered off of (its throughput), and the light it has gathered so far, so
+ * it can be advanced in a loop, paused between bounces, or traced in batches with other paths
+ */
+struct PathState {
+  // ray that the path continues along
+  ray ray_;
+
+  // color representing the product of the attenuations of the surfaces scattered off of so far
+  color throughput_;
+
+  // color representing the light gathered along the path so far
+  color radiance_;
+
+  // size_t representing the number of bounces the path has left before it stops gathering light
+  size_t bounces_remaining_;
+
+  // size_t representing the number of bounces the path has taken so far
+  size_t bounces_;
+};
+
+/**
+ * Returns the state of a new path starting along the given ray
+ *
+ * @param kRay constant reference to the ray the path starts along
+ * @param max_bounces the number of bounces the path may take before it stops gathering light
+ * @return a PathState with full throughput and no gathered light
+ */
+PathState startPath(const ray& kRay, size_t max_bounces);
+
+/**
+ * Traces the given path for one bounce: finds where its ray hits the given objects, then either
+ * scatters the path off of the hit object (see survivesRussianRoulette) or adds the background 
+ * light to the path
+ *
+ * @param path reference to the state of the path to advance
+ * @param kObjects constant reference to the hittable objects the path can hit
+ * @param kMaterials constant reference to the table of the materials of the objects
+ * @param kSettings constant reference to the settings to trace with (for Russian roulette)
+ * @return true if the path scattered and needs to be advanced again and false if it has ended
+ */
+bool advancePath(PathState& path, const Hittable& kObjects, const material_table& kMaterials,
+    const RenderSettings& kSettings);
+
+/**
+ * Finishes the current bounce of the given path, whose ray has already been intersected with the
+ * objects: either scatters the path off of the given hit (see survivesRussianRoulette) or adds 
+ * the background light to the path
+ *
+ * @param path reference to the state of the path to advance
+ * @param was_hit true if the ray of the path hit an object and false if it missed every object
+ * @param kHitRecord constant reference to the finalized closest hit of the ray (ignored if 
+ *     was_hit is false)
+ * @param kMaterials constant reference to the table of the materials of the objects
+ * @param kSettings constant reference to the settings to trace with (for Russian roulette)
+ * @return true if the path scattered and needs to be advanced again and false if it has ended
+ */
+bool shadeBounce(PathState& path, bool was_hit, const HitRecord& kHitRecord, 
+    const material_table& kMaterials, const RenderSettings& kSettings);
+
+/**
+ * Scatters or absorbs the given ray off of the material with the given material ID, through 
+ * material_table::scatter or, if the settings ask for it, the virtual Material::scatter
+ *
+ * @param kMaterials constant reference to the table of the materials of the scene
+ * @param material_id the material ID of the material to scatter off of
+ * @param kSettings constant reference to the settings to render with
+ * @param kRay a constant reference to a ray to be scattered 
+ * @param kHitRecord a constant reference to a HitRecord storing where the ray hit the material
+ * @param attenuation a reference to a color to be updated with how much the given ray is attenuated
+ * @param scattered_ray a reference to a ray to be updated with the scattered ray
+ * @return a bool that is true if the ray was scattered and false if the ray was absorbed
+ */
+inline bool scatterHit(const material_table& kMaterials, uint32_t material_id, 
+    const RenderSettings& kSettings, const ray& kRay, const HitRecord& kHitRecord, 
+    color& attenuation, ray& scattered_ray) {
+  if (kSettings.use_virtual_materials_) {
+    return kMaterials.get(material_id).scatter(kRay, kHitRecord, attenuation, scattered_ray);
+  }
+  return kMaterials.scatter(material_id, kRay, kHitRecord, attenuation, scattered_ray);
+}
+
+/**
+ * Ends the path with the given throughput at random if Russian roulette is on and the path has 
+ * taken at least the minimum number of bounces
+ *
+ * A path survives with a probability equal to its largest throughput component, and the 
+ * throughput of a surviving path is divided by that probability so the image stays unbiased
+ * Since only the throughput decides, a path that loses no light (like one refracting through 
+ * glass with an albedo of 1) always survives, so roulette cannot shorten the paths of the glass 
+ * scenes and the scenes leave it off (it stays available through RenderSettings)
+ *
+ * @param throughput reference to the throughput of the path (boosted if the path survives)
+ * @param bounces the number of bounces the path has taken
+ * @param kSettings constant reference to the settings to trace with
+ * @return true if the path survives and false if it has been ended
+ */
+bool survivesRussianRoulette(color& throughput, size_t bounces, const RenderSettings& kSettings);
+
+/**
+ * Returns the color of the background (a blue-white gradient) seen along the given ray
+ *
+ * @param kRay constant reference to the ray that missed every object
+ * @return a color representing the light coming from the background along the ray
+ */
+color backgroundColor(const ray& kRay);
+
+/**
+ * Returns the camera ray of the given sample of the given pixel, jittered within the pixel
+ *
+ * Selects bounce 0 of the random stream of the sample, which the jitter is drawn from
+ *
+ * @param kCamera constant reference to the camera to get the ray from
+ * @param kSettings constant reference to the settings to render with (for the image size)
+ * @param row the row of the pixel (rows count down from the top of the image)
+ * @param column the column of the pixel
+ * @param sample_index the index of the sample of the pixel
+ * @return the ray from the camera through a random point of the pixel
+ */
+ray cameraRay(const camera& kCamera, const RenderSettings& kSettings, int row, int column,
+    uint32_t sample_index);
+
+/**
+ * Renders the pixels of the given tile one path at a time
+ *
+ * @param kCamera constant reference to the camera to render from
+ * @param kObjects constant reference to the hittable objects to render
+ * @param kMaterials constant reference to the table of the materials of the objects
+ * @param kSettings constant reference to the settings to render with
+ * @param kTile constant reference to the tile of the image to render
+ * @param framebuffer reference to the framebuffer to store the pixels of the tile in
+ * @param statistics reference to a RenderStatistics to add the counts of the tile to
+ */
+void renderTile(const camera& kCamera, const Hittable& kObjects, const material_table& kMaterials,
+    const RenderSettings& kSettings, const ImageTile& kTile, std::vector<color>& framebuffer,
+    RenderStatistics& statistics);
+
+/**
+ * Renders the pixels of the given tile with the camera rays of blocks of pixels traced as 
+ * packets (see RayPacket), which share the node visits of their first bounce
+ *
+ * Every sample of a block of kSettings.ray_packet_size_ pixels is traced as one packet of camera
+ * rays. Scattered rays point in different directions, so after the first bounce every path goes 
+ * on alone with advancePath. Every ray finds the same closest hit and draws from the same random 
+ * streams as when it is traced alone, so the tile is exactly the same as with renderTile
+ *
+ * @param kCamera constant reference to the camera to render from
+ * @param kObjects constant reference to the hittable objects to render
+ * @param kMaterials constant reference to the table of the materials of the objects
+ * @param kSettings constant reference to the settings to render with
+ * @param kTile constant reference to the tile of the image to render
+ * @param framebuffer reference to the framebuffer to store the pixels of the tile in
+ * @param statistics reference to a RenderStatistics to add the counts of the tile to
+ */
+void renderTilePackets(const camera& kCamera, const Hittable& kObjects, 
+    const material_table& kMaterials, const RenderSettings& kSettings, const ImageTile& kTile, 
+    std::vector<color>& framebuffer, RenderStatistics& statistics);
+
+/**
+ * Renders the given objects as seen from the given camera
+ *
+ * The image is split into square tiles that are rendered in parallel on a work-stealing
+ * thread pool. Every sample draws from random streams keyed on its pixel, sample index, and
+ * bounce, so the image does not depend on the number of threads or on which thread renders 
+ * which tile, nor on whether the tiles are traced as a wavefront
+ *
+ * @param kCamera constant reference to the camera to render from
+ * @param kObjects constant reference to the hittable objects to render
+ * @param kMaterials constant reference to the table of the materials of the objects
+ * @param kSettings constant reference to the settings to render with
+ * @return a vector of colors storing the sum of the samples taken for every pixel, with
+ *     rows stored from the top of the image to the bottom and pixels stored left to right
+ * @throws std::invalid_argument if the ray packet size of the settings is not 0, 1, 4, 8, or 16
+ */
+std::vector<color> renderImage(const camera& kCamera, const Hittable& kObjects,
+    const material_table& kMaterials, const RenderSettings& kSettings);
+
+/**
+ * Renders the given objects as seen from the given camera (see above), and records how many 
+ * paths and bounces were traced
+ *
+ * @param kCamera constant reference to the camera to render from
+ * @param kObjects constant reference to the hittable objects to render
+ * @param kMaterials constant reference to the table of the materials of the objects
+ * @param kSettings constant reference to the settings to render with
+ * @param statistics reference to a RenderStatistics to update with the counts of the render
+ * @return a vector of colors storing the sum of the samples taken for every pixel, with
+ *     rows stored from the top of the image to the bottom and pixels stored left to right
+ * @throws std::invalid_argument if the ray packet size of the settings is not 0, 1, 4, 8, or 16
+ */
+std::vector<color> renderImage(const camera& kCamera, const Hittable& kObjects,
+    const material_table& kMaterials, const RenderSettings& kSettings, 
+    RenderStatistics& statistics);
+
+/**
+ * Adds the given framebuffer to the given stream as an ASCII (P3) PPM image
+ *
+ * @param stream reference to a stream to add the image to
+ * @param kFramebuffer constant reference to the framebuffer returned by renderImage
+ * @param kSettings constant reference to the settings the framebuffer was rendered with
+ */
+void writePpmImage(std::ostream& stream, const std::vector<color>& kFramebuffer,
+    const RenderSettings& kSettings);
@@ -0,0 +1,48 @@
+#include <memory>
+#include <stdexcept>
+
+#include "Material.h"
+#include "scenes.h"
+#include "sphere.h"
+
+void addMetalSpheresScene(hittable_list& world, material_table& materials) {
+  const uint32_t kMaterialGround = materials.add(std::make_shared<Lambertian>(color(0.8, 0.8, 0.0)));
+  const uint32_t kMaterialCenterDiffuseSphere = materials.add(std::make_shared<Lambertian>(color(0.7, 0.3, 0.3)));
+  // metal sphere with relatively clear reflection
+  const uint32_t kMaterialLeftMetalSphere = materials.add(std::make_shared<Metal>(color(0.8, 0.8, 0.8), 0.3));
+  // metal sphere with very fuzzy reflection
+  const uint32_t kMaterialRightMetalSphere = materials.add(std::make_shared<Metal>(color(0.8, 0.6, 0.2), 1.0));
+
+  world.add(std::make_shared<sphere>(point3(0, -100.5, -1), 100, kMaterialGround));
+  world.add(std::make_shared<sphere>(point3(0.0, 0.0, -1.0), 0.5, kMaterialCenterDiffuseSphere));
+  world.add(std::make_shared<sphere>(point3(-1.0, 0.0, -1.0), 0.5, kMaterialLeftMetalSphere));
+  world.add(std::make_shared<sphere>(point3(1.0, 0.0, -1.0), 0.5, kMaterialRightMetalSphere));
+}
+
+void addGlassSpheresScene(hittable_list& world, material_table& materials) {
+  const uint32_t kMaterialGround = materials.add(std::make_shared<Lambertian>(color(0.8, 0.8, 0.0)));
+  //  2 glass spheres
+  const uint32_t kMaterialCenterGlassSphere = materials.add(std::make_shared<Dielectric>(1.5));
+  const uint32_t kMaterialLeftGlassSphere = materials.add(std::make_shared<Dielectric>(1.5));
+  // metal sphere with very fuzzy reflection
+  const uint32_t kMaterialRightMetalSphere = materials.add(std::make_shared<Metal>(color(0.8, 0.6, 0.2), 1.0));
+
+  world.add(std::make_shared<sphere>(point3(0, -100.5, -1), 100, kMaterialGround));
+  world.add(std::make_shared<sphere>(point3(0.0, 0.0, -1.0), 0.5, kMaterialCenterGlassSphere));
+  world.add(std::make_shared<sphere>(point3(-1.0, 0.0, -1.0), 0.5, kMaterialLeftGlassSphere));
+  world.add(std::make_shared<sphere>(point3(1.0, 0.0, -1.0), 0.5, kMaterialRightMetalSphere));
+}
+
+void addRandomSpheresScene(hittable_list& world, const RandomSpheresDescription& kDescription) {
+  if (kDescription.material_count_ == 0) {
+    throw std::invalid_argument("addRandomSpheresScene: the scene needs at least one material");
+  }
+  setRandomStream(kDescription.seed_, 0, 0);
+  for (uint64_t i = 0; i < kDescription.sphere_count_; ++i) {
+    // drawn in separate statements so the order the numbers are drawn in is fixed
+    const point3 kCenter = randomVector(-kDescription.half_size_, kDescription.half_size_);
+    const real kRadius = randomDouble(kDescription.min_radius_, kDescription.max_radius_);
+    world.add(std::make_shared<sphere>(kCenter, kRadius,
+        static_cast<uint32_t>(i % kDescription.material_count_)));
+  }
+}
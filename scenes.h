@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+#include "constants_and_utilities.h"
+#include "hittable_list.h"
+#include "material_table.h"
+
+/**
+ * Adds the objects and materials of the metal spheres scene (a diffuse sphere between a 
+ * clear and a fuzzy metal sphere, on a diffuse ground sphere) to the given world
+ *
+ * @param world reference to the list to add the objects of the scene to
+ * @param materials reference to the table to add the materials of the scene to
+ */
+void addMetalSpheresScene(hittable_list& world, material_table& materials);
+
+/**
+ * Adds the objects and materials of the glass spheres scene (two glass spheres and a fuzzy 
+ * metal sphere, on a diffuse ground sphere) to the given world
+ *
+ * @param world reference to the list to add the objects of the scene to
+ * @param materials reference to the table to add the materials of the scene to
+ */
+void addGlassSpheresScene(hittable_list& world, material_table& materials);
+
+/**
+ * Struct describing a scene of random spheres scattered through a cube
+ *
+ * The spheres are drawn from the random stream keyed on the seed, so a description always
+ * generates the same scene and can stand in for it (like as the key of a bvh cache)
+ */
+struct RandomSpheresDescription {
+  // key of the random stream the spheres are drawn from
+  uint64_t seed_;
+
+  // number of spheres in the scene
+  uint64_t sphere_count_;
+
+  // half of the width of the cube the centers of the spheres are in
+  real half_size_;
+
+  // range the radii of the spheres are drawn from
+  real min_radius_;
+  real max_radius_;
+
+  // number of materials the spheres cycle through (sphere i gets material ID i % material_count_)
+  uint32_t material_count_;
+};
+
+/**
+ * Adds the spheres of the given random spheres scene to the given world
+ *
+ * NOTE: Switches the calling thread to the random stream of the scene (see setRandomStream), and
+ * leaves adding the materials the IDs refer to to the caller
+ *
+ * @param world reference to the list to add the spheres of the scene to
+ * @param kDescription constant reference to the description of the scene
+ * @throws std::invalid_argument if the description has a material count of 0
+ */
+void addRandomSpheresScene(hittable_list& world, const RandomSpheresDescription& kDescription);
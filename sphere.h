@@ -1,7 +1,67 @@
 #pragma once
 
+#include <cmath>
+
 #include "Hittable.h"
 
+/**
+ * Finds the closest root of a ray's intersection with a sphere within the acceptable t range
+ * (sphere, and every structure storing spheres in its own layout, finds its hits with this, so
+ * their t values match bit for bit)
+ *
+ * @param center point3 representing the center of the sphere
+ * @param radius real representing the radius of the sphere
+ * @param kRay constant reference to the ray to intersect with the sphere
+ * @param min_t the lowest acceptable t value
+ * @param max_t the highest acceptable t value
+ * @param root real set to the closest root within the range if there is one
+ * @return true if the ray hits the sphere within the range, false otherwise
+ */
+inline bool closestSphereRoot(point3 center, real radius, const ray& kRay, real min_t, 
+    real max_t, real& root) {
+  const vec3 kRayDirection = kRay.direction();
+  const vec3 kDifference = kRay.origin() - center;
+  // a, b, and c values in the quadratic equation given by the expanded vector form of a sphere
+  // using P = ray equation
+  const real kA = dot(kRayDirection, kRayDirection);
+  const real kHalfB = dot(kRayDirection, kDifference);
+  const real kC = dot(kDifference, kDifference) - (radius * radius);
+
+  const real kDiscriminant = (kHalfB * kHalfB) - (kA * kC);
+  // if discriminant < 0, there are no real solutions to the quadratic therefore the 
+  // sphere could not have been hit
+  if (kDiscriminant < 0) {
+    return false;
+  }
+  // we are looking for the closest point of intersection so we subtract the 
+  // discriminant
+  const real kSqrtDiscriminant = std::sqrt(kDiscriminant);
+  root = (-kHalfB - kSqrtDiscriminant) / kA;
+  if (root < min_t || root > max_t) {
+    // test the other root if the closest root is out of the acceptable t range
+    root = (-kHalfB + kSqrtDiscriminant) / kA;
+    // if both roots are out of the acceptable t range, the sphere was not hit
+    if (root < min_t || root > max_t) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Fills in the point of intersection and the surface normal of a hit with a sphere, whose t
+ * value is already in the hit record
+ *
+ * @param center point3 representing the center of the sphere that was hit
+ * @param kRay constant reference to the ray that hit the sphere
+ * @param hit_record reference to the hit record to fill in
+ */
+inline void finalizeSphereHit(point3 center, const ray& kRay, HitRecord& hit_record) {
+  hit_record.point_of_intersection_ = kRay.at(hit_record.t_);
+  const vec3 kOutwardNormal = unitVector(hit_record.point_of_intersection_ - center);
+  hit_record.setFaceNormal(kRay, kOutwardNormal);
+}
+
 class sphere : public Hittable {
   public:
     /**
@@ -17,20 +77,59 @@ class sphere : public Hittable {
      * radius to the given radius
      * 
      * @param center point3 representing the center of the sphere to create
-     * @param radius double representing the radius of the sphere to create
-     * @param material_ptr a shared pointer to the class of the material of the sphere 
+     * @param radius real representing the radius of the sphere to create
+     * @param material_id the material ID (in the scene's material_table) of the material of 
+     *     the sphere
+     */
+    sphere(point3 center, real radius, uint32_t material_id);
+
+    /**
+     * Returns the center of the sphere
+     *
+     * @return a point3 representing the center of the sphere
+     */
+    point3 center() const;
+
+    /**
+     * Returns the radius of the sphere
+     *
+     * @return a real representing the radius of the sphere
+     */
+    real radius() const;
+
+    /**
+     * Returns the material ID of the sphere
+     *
+     * @return the material ID (in the scene's material_table) of the material of the sphere
+     */
+    uint32_t materialId() const;
+
+    /**
+     * Moves the sphere to the given center (hierarchies containing the sphere must be refit or
+     * rebuilt before they are traced again)
+     *
+     * @param center point3 representing the new center of the sphere
      */
-    sphere(point3 center, double radius, std::shared_ptr<Material> material_ptr);
+    void setCenter(point3 center);
 
     // see hittable docs
-    virtual bool wasHit(const ray& kRay, double min_t, double max_t, 
+    virtual bool intersect(const ray& kRay, real min_t, real max_t, 
         HitRecord& hit_record) const override;
 
+    // see hittable docs
+    virtual bool isOccluded(const ray& kRay, real min_t, real max_t) const override;
+
+    // see hittable docs
+    virtual void finalizeHit(const ray& kRay, HitRecord& hit_record) const override;
+
+    // see hittable docs
+    virtual bool boundingBox(real time0, real time1, aabb& output_box) const override;
+
   private:
     // point3 representing the center of the sphere
     point3 center_;
-    // double representing the radius of the sphere
-    double radius_;
-    // shared pointer to the class of the material of the sphere
-    std::shared_ptr<Material> material_ptr_;
+    // real representing the radius of the sphere
+    real radius_;
+    // material ID (in the scene's material_table) of the material of the sphere
+    uint32_t material_id_;
 };
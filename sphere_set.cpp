@@ -0,0 +1,142 @@
+#include <limits>
+
+#include "sphere_set.h"
+
+void sphere_set::add(point3 center, real radius, uint32_t material_id) {
+  // fill the next padding slot, adding a block of padding spheres when there is none left
+  if (size_ == center_x_.size()) {
+    const size_t kPaddedSize = size_ + kSphereSetWidth;
+    center_x_.resize(kPaddedSize, 0);
+    center_y_.resize(kPaddedSize, 0);
+    center_z_.resize(kPaddedSize, 0);
+    radius_.resize(kPaddedSize, 0);
+    radius_squared_.resize(kPaddedSize, std::numeric_limits<real>::quiet_NaN());
+    material_ids_.resize(kPaddedSize, 0);
+  }
+  center_x_[size_] = center.x();
+  center_y_[size_] = center.y();
+  center_z_[size_] = center.z();
+  radius_[size_] = radius;
+  radius_squared_[size_] = radius * radius;
+  material_ids_[size_] = material_id;
+  ++size_;
+}
+
+size_t sphere_set::size() const {
+  return size_;
+}
+
+inline SphereSetRay sphere_set::broadcastRay(const ray& kRay, real min_t, real max_t) {
+  const point3 kOrigin = kRay.origin();
+  const vec3 kRayDirection = kRay.direction();
+  SphereSetRay broadcast_ray = SphereSetRay();
+  broadcast_ray.origin_x_ = realLanesBroadcast(kOrigin.x());
+  broadcast_ray.origin_y_ = realLanesBroadcast(kOrigin.y());
+  broadcast_ray.origin_z_ = realLanesBroadcast(kOrigin.z());
+  broadcast_ray.direction_x_ = realLanesBroadcast(kRayDirection.x());
+  broadcast_ray.direction_y_ = realLanesBroadcast(kRayDirection.y());
+  broadcast_ray.direction_z_ = realLanesBroadcast(kRayDirection.z());
+  broadcast_ray.a_ = realLanesBroadcast(dot(kRayDirection, kRayDirection));
+  broadcast_ray.min_t_ = realLanesBroadcast(min_t);
+  broadcast_ray.max_t_ = realLanesBroadcast(max_t);
+  broadcast_ray.no_hit_ = realLanesBroadcast(std::numeric_limits<real>::quiet_NaN());
+  return broadcast_ray;
+}
+
+inline RealLanes sphere_set::closestRoots(const SphereSetRay& kRay, size_t i) const {
+  // the same quadratic as sphere::intersect, with every operation in the same order so the 
+  // roots are bit-identical
+  const RealLanes kDifferenceX = realLanesSubtract(kRay.origin_x_, realLanesLoad(&center_x_[i]));
+  const RealLanes kDifferenceY = realLanesSubtract(kRay.origin_y_, realLanesLoad(&center_y_[i]));
+  const RealLanes kDifferenceZ = realLanesSubtract(kRay.origin_z_, realLanesLoad(&center_z_[i]));
+  const RealLanes kHalfB = realLanesAdd(realLanesAdd(
+      realLanesMultiply(kRay.direction_x_, kDifferenceX), 
+      realLanesMultiply(kRay.direction_y_, kDifferenceY)), 
+      realLanesMultiply(kRay.direction_z_, kDifferenceZ));
+  const RealLanes kC = realLanesSubtract(realLanesAdd(realLanesAdd(
+      realLanesMultiply(kDifferenceX, kDifferenceX), 
+      realLanesMultiply(kDifferenceY, kDifferenceY)), 
+      realLanesMultiply(kDifferenceZ, kDifferenceZ)), realLanesLoad(&radius_squared_[i]));
+  // a negative discriminant gives NaN roots, which are never in range
+  const RealLanes kSqrtDiscriminant = realLanesSqrt(realLanesSubtract(
+      realLanesMultiply(kHalfB, kHalfB), realLanesMultiply(kRay.a_, kC)));
+  const RealLanes kNegativeHalfB = realLanesNegate(kHalfB);
+  const RealLanes kNearRoot = realLanesDivide(
+      realLanesSubtract(kNegativeHalfB, kSqrtDiscriminant), kRay.a_);
+  const RealLanes kFarRoot = realLanesDivide(
+      realLanesAdd(kNegativeHalfB, kSqrtDiscriminant), kRay.a_);
+  // the closest root within the acceptable t range, like sphere::intersect
+  return realLanesSelectInRange(kNearRoot, kRay.min_t_, kRay.max_t_, 
+      realLanesSelectInRange(kFarRoot, kRay.min_t_, kRay.max_t_, kRay.no_hit_));
+}
+
+bool sphere_set::intersect(const ray& kRay, real min_t, real max_t, 
+    HitRecord& hit_record) const {
+  const SphereSetRay kBroadcastRay = broadcastRay(kRay, min_t, max_t);
+  bool has_hit_anything = false;
+  real closest_t_value = max_t;
+  size_t closest_index = 0;
+  real block_t_values[kSphereSetWidth];
+  for (size_t block = 0; block < center_x_.size(); block += kSphereSetWidth) {
+    for (int lane = 0; lane < kSphereSetWidth; lane += kRealLaneCount) {
+      realLanesStore(&block_t_values[lane], closestRoots(kBroadcastRay, block + lane));
+    }
+
+    // like hittable_list, a later sphere with the same t value replaces an earlier one
+    for (int lane = 0; lane < kSphereSetWidth; ++lane) {
+      if (block_t_values[lane] <= closest_t_value) {
+        closest_t_value = block_t_values[lane];
+        closest_index = block + lane;
+        has_hit_anything = true;
+      }
+    }
+  }
+
+  if (has_hit_anything) {
+    // the rest of the hit record is filled in by finalizeHit if this stays the closest hit
+    hit_record.t_ = closest_t_value;
+    hit_record.hit_object_ = this;
+    hit_record.primitive_index_ = static_cast<uint32_t>(closest_index);
+    hit_record.material_id_ = material_ids_[closest_index];
+  }
+  return has_hit_anything;
+}
+
+bool sphere_set::isOccluded(const ray& kRay, real min_t, real max_t) const {
+  const SphereSetRay kBroadcastRay = broadcastRay(kRay, min_t, max_t);
+  for (size_t block = 0; block < center_x_.size(); block += kSphereSetWidth) {
+    int hit_mask = 0;
+    for (int lane = 0; lane < kSphereSetWidth; lane += kRealLaneCount) {
+      // roots of spheres that are not hit are NaN, which fails the comparison
+      const RealLanes kRoots = closestRoots(kBroadcastRay, block + lane);
+      hit_mask |= realLanesLessEqualMask(kRoots, kRoots);
+    }
+    if (hit_mask != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void sphere_set::finalizeHit(const ray& kRay, HitRecord& hit_record) const {
+  const size_t i = hit_record.primitive_index_;
+  const point3 kCenter = point3(center_x_[i], center_y_[i], center_z_[i]);
+  hit_record.point_of_intersection_ = kRay.at(hit_record.t_);
+  const vec3 kOutwardNormal = unitVector(hit_record.point_of_intersection_ - kCenter);
+  hit_record.setFaceNormal(kRay, kOutwardNormal);
+}
+
+bool sphere_set::boundingBox(real time0, real time1, aabb& output_box) const {
+  if (size_ == 0) {
+    return false;
+  }
+  aabb surrounding_box = aabb(); // defaults to an empty box
+  for (size_t i = 0; i < size_; ++i) {
+    const point3 kCenter = point3(center_x_[i], center_y_[i], center_z_[i]);
+    const vec3 kRadiusVector = vec3(radius_[i], radius_[i], radius_[i]);
+    surrounding_box = surroundingBox(surrounding_box, 
+        aabb(kCenter - kRadiusVector, kCenter + kRadiusVector));
+  }
+  output_box = surrounding_box;
+  return true;
+}
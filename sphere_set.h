@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "aabb.h"
+#include "Hittable.h"
+#include "real_lanes.h"
+
+#ifndef RAYTRACER_SPHERE_SET_WIDTH
+// number of spheres tested against a ray at once (4, 8, or 16; build with 
+// -DRAYTRACER_SPHERE_SET_WIDTH=n, or make SPHERE_SET_WIDTH=n, to change it)
+#define RAYTRACER_SPHERE_SET_WIDTH 8
+#endif
+
+// number of spheres in every block of a sphere_set, which are tested against a ray at once
+const int kSphereSetWidth = RAYTRACER_SPHERE_SET_WIDTH;
+
+static_assert(kSphereSetWidth == 4 || kSphereSetWidth == 8 || kSphereSetWidth == 16,
+    "RAYTRACER_SPHERE_SET_WIDTH must be 4, 8, or 16");
+static_assert(kSphereSetWidth % kRealLaneCount == 0,
+    "RAYTRACER_SPHERE_SET_WIDTH must be a multiple of the number of reals in a register");
+
+/**
+ * Struct storing a ray and a range of t values broadcast to every lane of a register, ready to 
+ * be tested against kRealLaneCount spheres of a sphere_set at once
+ */
+struct SphereSetRay {
+  // x, y, and z components of the origin and direction of the ray
+  RealLanes origin_x_;
+  RealLanes origin_y_;
+  RealLanes origin_z_;
+  RealLanes direction_x_;
+  RealLanes direction_y_;
+  RealLanes direction_z_;
+
+  // dot product of the direction with itself (a in the quadratic, the same for every sphere)
+  RealLanes a_;
+
+  // minimum and maximum t values for an intersection
+  RealLanes min_t_;
+  RealLanes max_t_;
+
+  // NaN, which marks a sphere that is not hit since it fails every comparison
+  RealLanes no_hit_;
+};
+
+/**
+ * Class storing a set of spheres as a structure of arrays (SoA)
+ *
+ * The centers, radii, and material IDs of the spheres are stored in separate arrays padded to 
+ * a multiple of kSphereSetWidth, and intersect tests a ray against kSphereSetWidth spheres at 
+ * once with RealLanes (see real_lanes.h). The closest hit is the same one, with bit-identical t 
+ * values, that a hittable_list of the same spheres finds
+ *
+ * Every sphere of a block is fully tested (there is no early out for a missed sphere), so in 
+ * scalar builds a sphere_set is slower than a hittable_list; build with make SIMD=sse4|avx2
+ */
+class sphere_set : public Hittable {
+  public:
+    /**
+     * Default Constructor (makes an empty set)
+     */
+    sphere_set() : size_(0) {}
+
+    /**
+     * Adds a sphere to the set
+     *
+     * @param center point3 representing the center of the sphere to add
+     * @param radius real representing the radius of the sphere to add
+     * @param material_id the material ID (in the scene's material_table) of the material of 
+     *     the sphere
+     */
+    void add(point3 center, real radius, uint32_t material_id);
+
+    /**
+     * Returns the number of spheres in the set
+     *
+     * @return a size_t representing the number of spheres in the set
+     */
+    size_t size() const;
+
+    /**
+     * Returns true if any of the spheres in the set are hit by the given ray
+     * Updates the t value, hit object, primitive index (the index of the sphere in the set), and 
+     * material ID of the hit record with the closest intersection (does nothing if no hits)
+     *
+     * @param kRay constant reference to the ray to check if it hits a sphere in the set
+     * @param min_t real representing the minimum t value for the intersection
+     * @param max_t real representing the maximum t value for the intersection
+     * @param hit_record reference to a hit record to update with the closest intersection (not 
+     *     updated if no spheres in the set are hit within the acceptable t value range)
+     * @return true if a sphere in the set was hit by the given ray in the given range of values 
+     *     for t and false otherwise
+     */
+    virtual bool intersect(const ray& kRay, real min_t, real max_t, 
+        HitRecord& hit_record) const override;
+
+    /**
+     * Returns true if any of the spheres in the set are hit by the given ray, stopping at the 
+     * first block of spheres with a hit
+     *
+     * @param kRay constant reference to the ray to check if it hits a sphere in the set
+     * @param min_t real representing the minimum t value for the intersection
+     * @param max_t real representing the maximum t value for the intersection
+     * @return true if a sphere in the set was hit by the given ray in the given range of values 
+     *     for t and false otherwise
+     */
+    virtual bool isOccluded(const ray& kRay, real min_t, real max_t) const override;
+
+    // see hittable docs
+    virtual void finalizeHit(const ray& kRay, HitRecord& hit_record) const override;
+
+    // see hittable docs
+    virtual bool boundingBox(real time0, real time1, aabb& output_box) const override;
+
+  private:
+    /**
+     * Broadcasts the given ray and range of t values to every lane of a register
+     *
+     * @param kRay constant reference to the ray to broadcast
+     * @param min_t real representing the minimum t value for an intersection
+     * @param max_t real representing the maximum t value for an intersection
+     * @return a SphereSetRay storing the broadcast ray
+     */
+    static SphereSetRay broadcastRay(const ray& kRay, real min_t, real max_t);
+
+    /**
+     * Returns the closest root in range of the given ray with each of the kRealLaneCount 
+     * spheres starting at the given index
+     *
+     * @param kRay constant reference to the broadcast ray
+     * @param index the index of the first of the spheres (a multiple of kRealLaneCount)
+     * @return RealLanes storing the closest t value in range at which the ray hits every 
+     *     sphere, or NaN for spheres it does not hit
+     */
+    RealLanes closestRoots(const SphereSetRay& kRay, size_t index) const;
+
+    // number of spheres in the set (the arrays also hold padding spheres that are never hit)
+    size_t size_;
+
+    // x, y, and z components of the centers of the spheres
+    std::vector<real> center_x_;
+    std::vector<real> center_y_;
+    std::vector<real> center_z_;
+
+    // radii of the spheres
+    std::vector<real> radius_;
+
+    // squares of the radii of the spheres (NaN for padding spheres, so they are never hit)
+    std::vector<real> radius_squared_;
+
+    // material IDs (in the scene's material_table) of the materials of the spheres
+    std::vector<uint32_t> material_ids_;
+};
@@ -0,0 +1,25 @@
+#include "../project/catch/catch.hpp"
+
+#include "../aabb.h"
+#include "../ray.h"
+#include "../vec3.h"
+
+TEST_CASE("aabb::wasHit ignores the slabs a ray is parallel to", "[aabb]") {
+  const aabb kBox = aabb(point3(0, 0, 0), point3(1, 1, 1));
+
+  SECTION("rays inside the slab") {
+    REQUIRE(kBox.wasHit(ray(point3(0.5, 0.5, -1), vec3(0, 0, 1)), 0, infinity));
+    REQUIRE_FALSE(kBox.wasHit(ray(point3(2, 0.5, -1), vec3(0, 0, 1)), 0, infinity));
+  }
+  SECTION("rays starting on a plane of the slab (a NaN t value)") {
+    REQUIRE(kBox.wasHit(ray(point3(0, 0.5, -1), vec3(0, 0, 1)), 0, infinity));
+    REQUIRE(kBox.wasHit(ray(point3(1, 0.5, -1), vec3(0, 0, 1)), 0, infinity));
+    REQUIRE(kBox.wasHit(ray(point3(0, 0.5, -1), vec3(-0.0, 0, 1)), 0, infinity));
+    REQUIRE(kBox.wasHit(ray(point3(1, 0.5, -1), vec3(-0.0, 0, 1)), 0, infinity));
+    REQUIRE(kBox.wasHit(ray(point3(0, 1, 2), vec3(0, 0, -1)), 0, infinity));
+  }
+  SECTION("the t range still applies") {
+    REQUIRE_FALSE(kBox.wasHit(ray(point3(0, 0.5, -1), vec3(0, 0, 1)), 0, 0.5));
+    REQUIRE_FALSE(kBox.wasHit(ray(point3(0, 0.5, -1), vec3(0, 0, 1)), 2.5, infinity));
+  }
+}
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "../project/catch/catch.hpp"
+
+#include "../bvh.h"
+#include "../compressed_bvh.h"
+#include "../hittable_list.h"
+#include "../sphere.h"
+#include "../sphere_set.h"
+#include "../thread_pool.h"
+#include "../wide_bvh.h"
+#include "test_scenes.h"
+
+// number of spheres in the test scenes, and half of the width of the cube they fill
+const size_t kTestSphereCount = 2000;
+const real kTestHalfSize = 10;
+
+// number of random rays traced through every structure
+const size_t kTestRayCount = 4000;
+
+TEST_CASE("bvh finds the same closest hits as a hittable_list", "[bvh]") {
+  const hittable_list kList = randomSpheres(kTestSphereCount, kTestHalfSize);
+  const std::vector<ray> kRays = randomRays(kTestRayCount, kTestHalfSize);
+  thread_pool pool(2);
+
+  SECTION("sweep SAH build") {
+    requireSameClosestHits(kList, bvh(kList), kRays);
+  }
+  SECTION("binned SAH build") {
+    requireSameClosestHits(kList, bvh(kList, BvhBuildSettings{BvhBuilder::kBinnedSah, 63, false},
+        pool), kRays);
+  }
+  SECTION("linear build with 30-bit Morton codes") {
+    requireSameClosestHits(kList, bvh(kList, BvhBuildSettings{BvhBuilder::kLinear, 30, false},
+        pool), kRays);
+  }
+  SECTION("linear build with 63-bit Morton codes") {
+    requireSameClosestHits(kList, bvh(kList, BvhBuildSettings{BvhBuilder::kLinear, 63, false},
+        pool), kRays);
+  }
+  SECTION("linear build with optimized treelets") {
+    requireSameClosestHits(kList, bvh(kList, BvhBuildSettings{BvhBuilder::kLinear, 63, true},
+        pool), kRays);
+  }
+}
+
+TEST_CASE("refit and rebuilt bvhs find the same closest hits as a hittable_list", "[bvh]") {
+  // enough spheres that the top subtrees are refit in parallel (over 8192 nodes)
+  hittable_list list = randomSpheres(20000, 2 * kTestHalfSize);
+  thread_pool pool(2);
+  bvh hierarchy = bvh(list, BvhBuildSettings{BvhBuilder::kBinnedSah, 63, false}, pool);
+  REQUIRE(hierarchy.nodes().size() > (1 << 13));
+
+  // the hierarchy shares the spheres of the list, so moving them moves them in both
+  setRandomStream(6, 0, 0);
+  for (const std::shared_ptr<Hittable>& kObject : list.objects()) {
+    sphere& moved_sphere = dynamic_cast<sphere&>(*kObject);
+    moved_sphere.setCenter(moved_sphere.center() + randomVector(-2, 2));
+  }
+  const std::vector<ray> kRays = randomRays(kTestRayCount, 2 * kTestHalfSize);
+
+  SECTION("refit") {
+    REQUIRE_FALSE(hierarchy.refitOrRebuild(1e9, pool));
+    REQUIRE(hierarchy.sahCostGrowth() > 1);
+    requireSameClosestHits(list, hierarchy, kRays);
+  }
+  SECTION("rebuild") {
+    REQUIRE(hierarchy.refitOrRebuild(1, pool));
+    REQUIRE(hierarchy.sahCostGrowth() == 1);
+    requireSameClosestHits(list, hierarchy, kRays);
+  }
+}
+
+/**
+ * Returns the depth of the deepest node of the given hierarchy
+ *
+ * @param kHierarchy constant reference to the hierarchy to measure
+ * @return the number of levels between the root and the deepest leaf
+ */
+size_t bvhDepth(const bvh& kHierarchy) {
+  const std::vector<BvhNode>& kNodes = kHierarchy.nodes();
+  std::vector<std::pair<uint32_t, size_t>> pending = {{0, 0}};
+  size_t depth = 0;
+  while (!pending.empty()) {
+    const std::pair<uint32_t, size_t> kNode = pending.back();
+    pending.pop_back();
+    depth = std::max(depth, kNode.second);
+    if (!kNodes[kNode.first].isLeaf()) {
+      pending.push_back({kNode.first + 1, kNode.second + 1});
+      pending.push_back({kNodes[kNode.first].offset_, kNode.second + 1});
+    }
+  }
+  return depth;
+}
+
+TEST_CASE("optimized treelets keep the tree within the traversal stack", "[bvh]") {
+  // without the depth limit, this scene's optimized tree is over 100 levels deep
+  const hittable_list kList = nestedSpheres(kTestSphereCount);
+  thread_pool pool(2);
+  const bvh kHierarchy = bvh(kList, BvhBuildSettings{BvhBuilder::kLinear, 63, true}, pool);
+  REQUIRE(bvhDepth(kHierarchy) > kMaxSahDepth);
+  REQUIRE(bvhDepth(kHierarchy) <= kMaxBvhDepth);
+  requireSameClosestHits(kList, kHierarchy, randomRays(kTestRayCount, 1));
+  requireSameClosestHits(kList, wide_bvh(kHierarchy), randomRays(kTestRayCount, 1));
+  requireSameClosestHits(kList, compressed_bvh(kHierarchy), randomRays(kTestRayCount, 1));
+}
+
+TEST_CASE("sphere_set finds the same closest hits as a hittable_list", "[sphere_set]") {
+  // few enough spheres that the list is quick to trace, in a small cube so most rays hit one
+  const hittable_list kList = randomSpheres(200, 3);
+  sphere_set set = sphere_set();
+  for (const std::shared_ptr<Hittable>& kObject : kList.objects()) {
+    const sphere& kSphere = dynamic_cast<const sphere&>(*kObject);
+    set.add(kSphere.center(), kSphere.radius(), kSphere.materialId());
+  }
+  requireSameClosestHits(kList, set, randomRays(kTestRayCount, 3));
+}
+
+TEST_CASE("wide_bvh finds the same closest hits as a hittable_list", "[wide_bvh]") {
+  const hittable_list kList = randomSpheres(kTestSphereCount, kTestHalfSize);
+  requireSameClosestHits(kList, wide_bvh(bvh(kList)), randomRays(kTestRayCount, kTestHalfSize));
+}
+
+TEST_CASE("compressed_bvh finds the same closest hits as a hittable_list", "[compressed_bvh]") {
+  const hittable_list kList = randomSpheres(kTestSphereCount, kTestHalfSize);
+  requireSameClosestHits(kList, compressed_bvh(bvh(kList)),
+      randomRays(kTestRayCount, kTestHalfSize));
+}
+
+TEST_CASE("isOccluded agrees with intersect for every structure", "[occlusion]") {
+  const hittable_list kList = randomSpheres(kTestSphereCount, kTestHalfSize);
+  const bvh kHierarchy = bvh(kList);
+  const wide_bvh kWideHierarchy = wide_bvh(kHierarchy);
+  const compressed_bvh kCompressedHierarchy = compressed_bvh(kHierarchy);
+  const Hittable* kStructures[4] = {&kList, &kHierarchy, &kWideHierarchy, &kCompressedHierarchy};
+
+  // segments between random points, which leave some rays unblocked
+  setRandomStream(3, 0, 0);
+  size_t num_blocked = 0;
+  for (size_t i = 0; i < kTestRayCount; ++i) {
+    const point3 kStart = randomVector(-kTestHalfSize, kTestHalfSize);
+    const ray kSegment = ray(kStart, randomVector(-kTestHalfSize, kTestHalfSize) - kStart);
+    HitRecord hit_record = HitRecord();
+    const bool kBlocked = kList.intersect(kSegment, 0.001, 0.999, hit_record);
+    num_blocked += kBlocked ? 1 : 0;
+    for (const Hittable* kStructure : kStructures) {
+      REQUIRE(kStructure->isOccluded(kSegment, 0.001, 0.999) == kBlocked);
+    }
+  }
+  REQUIRE(num_blocked > 0);
+  REQUIRE(num_blocked < kTestRayCount);
+}
+
+TEST_CASE("intersectPacket finds the same closest hits as intersect", "[packets]") {
+  const hittable_list kList = randomSpheres(kTestSphereCount, kTestHalfSize);
+  const bvh kHierarchy = bvh(kList);
+  const Hittable* kStructures[2] = {&kList, &kHierarchy};
+
+  // bundles of nearly parallel rays from a shared origin, like the camera rays of a block of
+  // pixels, cut down to every packet size (including ones that leave lanes unused)
+  setRandomStream(4, 0, 0);
+  for (size_t packet_size = 1; packet_size <= kMaxRayPacketSize; ++packet_size) {
+    for (int bundle = 0; bundle < 50; ++bundle) {
+      const point3 kOrigin = randomVector(-kTestHalfSize, kTestHalfSize);
+      const vec3 kDirection = randomUnitVector();
+      RayPacket packet = RayPacket();
+      packet.clear();
+      for (size_t i = 0; i < packet_size; ++i) {
+        packet.add(ray(kOrigin, kDirection + (randomVector(-0.05, 0.05))), infinity);
+      }
+      for (const Hittable* kStructure : kStructures) {
+        RayPacket traced_packet = packet;
+        kStructure->intersectPacket(traced_packet, 0.001);
+        for (size_t i = 0; i < packet_size; ++i) {
+          HitRecord hit_record = HitRecord();
+          const bool kWasHit = kStructure->intersect(packet.rays_[i], 0.001, infinity, hit_record);
+          REQUIRE(traced_packet.was_hit_[i] == kWasHit);
+          if (kWasHit) {
+            REQUIRE(traced_packet.max_t_[i] == hit_record.t_);
+            REQUIRE(traced_packet.hit_records_[i].hit_object_ == hit_record.hit_object_);
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("rays along a face of a bounding box still find the object inside", "[aabb]") {
+  // the ray touches the sphere where it meets the minimum y plane of its box, so every slab test
+  // on the way down sees 0 * infinity for the y axis
+  hittable_list list = hittable_list();
+  list.add(std::make_shared<sphere>(point3(0, 0, 0), 1, 0));
+  list.add(std::make_shared<sphere>(point3(4, 2, 0), 1, 1));
+  const bvh kHierarchy = bvh(list);
+  const wide_bvh kWideHierarchy = wide_bvh(kHierarchy);
+  const compressed_bvh kCompressedHierarchy = compressed_bvh(kHierarchy);
+  const Hittable* kStructures[4] = {&list, &kHierarchy, &kWideHierarchy, &kCompressedHierarchy};
+  const ray kRay = ray(point3(0, -1, -5), vec3(0, 0, 1));
+
+  for (const Hittable* kStructure : kStructures) {
+    HitRecord hit_record = HitRecord();
+    REQUIRE(kStructure->intersect(kRay, 0.001, infinity, hit_record));
+    REQUIRE(hit_record.t_ == 5);
+    REQUIRE(kStructure->isOccluded(kRay, 0.001, infinity));
+    RayPacket packet = RayPacket();
+    packet.clear();
+    packet.add(kRay, infinity);
+    packet.add(kRay, infinity);
+    kStructure->intersectPacket(packet, 0.001);
+    REQUIRE(packet.was_hit_[0]);
+    REQUIRE(packet.was_hit_[1]);
+  }
+}
@@ -0,0 +1,74 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "../project/catch/catch.hpp"
+
+#include "../image_compare.h"
+
+/**
+ * Returns a 2x1 image whose pixels are the given gray values
+ *
+ * @param first_gray the value of every channel of the first pixel
+ * @param second_gray the value of every channel of the second pixel
+ * @return a PpmImage of the two pixels
+ */
+PpmImage grayImage(int first_gray, int second_gray) {
+  PpmImage image = PpmImage();
+  image.width_ = 2;
+  image.height_ = 1;
+  image.channels_ = {first_gray, first_gray, first_gray, second_gray, second_gray, second_gray};
+  return image;
+}
+
+/**
+ * Writes the given image to an ASCII (P3) PPM file
+ *
+ * @param kFileName constant reference to the name of the file to write
+ * @param kImage constant reference to the image to write
+ */
+void writeTestImage(const std::string& kFileName, const PpmImage& kImage) {
+  std::ofstream image_file = std::ofstream(kFileName);
+  image_file << "P3\n" << kImage.width_ << " " << kImage.height_ << "\n255\n";
+  for (int channel : kImage.channels_) {
+    image_file << channel << "\n";
+  }
+}
+
+TEST_CASE("compareImages measures how much two images differ", "[image_compare]") {
+  const ImageDifference kSame = compareImages(grayImage(10, 20), grayImage(10, 20));
+  REQUIRE(kSame.max_channel_difference_ == 0);
+  REQUIRE(kSame.fraction_of_pixels_differing_ == 0);
+  REQUIRE(std::isinf(kSame.peak_signal_to_noise_ratio_));
+
+  // one pixel off by 4 in every channel: a mean squared error of 8
+  const ImageDifference kDifferent = compareImages(grayImage(10, 20), grayImage(10, 24));
+  REQUIRE(kDifferent.max_channel_difference_ == 4);
+  REQUIRE(kDifferent.mean_channel_difference_ == 2);
+  REQUIRE(kDifferent.fraction_of_pixels_differing_ == 0.5);
+  REQUIRE(kDifferent.peak_signal_to_noise_ratio_
+      == Approx(10 * std::log10((255.0 * 255.0) / 8)));
+}
+
+TEST_CASE("image comparisons fail past their limits", "[image_compare]") {
+  const ImageDifference kDifference = compareImages(grayImage(10, 20), grayImage(10, 24));
+  REQUIRE(isWithinLimits(kDifference, ImageDifferenceLimits{4, 30}));
+  REQUIRE_FALSE(isWithinLimits(kDifference, ImageDifferenceLimits{3, 30}));
+  REQUIRE_FALSE(isWithinLimits(kDifference, ImageDifferenceLimits{4, 50}));
+
+  const std::string kReferenceFile = "test_reference.ppm";
+  const std::string kImageFile = "test_image.ppm";
+  writeTestImage(kReferenceFile, grayImage(10, 20));
+  writeTestImage(kImageFile, grayImage(10, 200));
+  std::ostringstream stream;
+  // without limits, only unreadable or mismatched images fail
+  REQUIRE(comparePpmFiles(kReferenceFile, kImageFile, stream));
+  REQUIRE_FALSE(comparePpmFiles(kReferenceFile, kImageFile, ImageDifferenceLimits{16, 50},
+      stream));
+  REQUIRE(comparePpmFiles(kReferenceFile, kReferenceFile, ImageDifferenceLimits{0, 100}, stream));
+  REQUIRE_FALSE(comparePpmFiles(kReferenceFile, "missing.ppm", stream));
+  std::remove(kReferenceFile.c_str());
+  std::remove(kImageFile.c_str());
+}
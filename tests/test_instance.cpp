@@ -0,0 +1,66 @@
+#include <memory>
+#include <stdexcept>
+
+#include "../project/catch/catch.hpp"
+
+#include "../affine_transform.h"
+#include "../instance.h"
+#include "../ray.h"
+#include "../sphere.h"
+#include "../vec3.h"
+
+TEST_CASE("an instance of a sphere hits like the sphere it places", "[instance]") {
+  // a unit sphere scaled by 2.5, rotated, and moved is the sphere of radius 2.5 at the offset
+  const point3 kCenter = point3(3, -1, 2);
+  const real kRadius = 2.5;
+  const affine_transform kObjectToWorld = affine_transform::translation(kCenter)
+      * affine_transform::rotation(vec3(1, 2, 3), 40)
+      * affine_transform::scaling(vec3(kRadius, kRadius, kRadius));
+  const instance kInstance = instance(std::make_shared<sphere>(point3(0, 0, 0), 1, 0),
+      kObjectToWorld);
+  const sphere kSphere = sphere(kCenter, kRadius, 0);
+
+  // rays towards random points near the sphere, some of them starting inside it
+  setRandomStream(7, 0, 0);
+  size_t num_hits = 0;
+  for (int i = 0; i < 1000; ++i) {
+    const point3 kOrigin = kCenter + randomVector(-8, 8);
+    const ray kRay = ray(kOrigin, kCenter + randomVector(-3, 3) - kOrigin);
+    HitRecord instance_hit = HitRecord();
+    HitRecord sphere_hit = HitRecord();
+    const bool kSphereWasHit = kSphere.wasHit(kRay, 0.001, infinity, sphere_hit);
+    REQUIRE(kInstance.wasHit(kRay, 0.001, infinity, instance_hit) == kSphereWasHit);
+    REQUIRE(kInstance.isOccluded(kRay, 0.001, infinity) == kSphereWasHit);
+    if (kSphereWasHit) {
+      ++num_hits;
+      REQUIRE(instance_hit.t_ == Approx(sphere_hit.t_));
+      REQUIRE(instance_hit.surface_normal_.x()
+          == Approx(sphere_hit.surface_normal_.x()).margin(1e-4));
+      REQUIRE(instance_hit.surface_normal_.y()
+          == Approx(sphere_hit.surface_normal_.y()).margin(1e-4));
+      REQUIRE(instance_hit.surface_normal_.z()
+          == Approx(sphere_hit.surface_normal_.z()).margin(1e-4));
+      REQUIRE(instance_hit.front_facing_ == sphere_hit.front_facing_);
+    }
+  }
+  REQUIRE(num_hits > 100);
+}
+
+TEST_CASE("affine_transform::inverse undoes the transform", "[instance]") {
+  SECTION("points round trip") {
+    const affine_transform kTransform = affine_transform::translation(vec3(1, 2, 3))
+        * affine_transform::rotation(vec3(0, 1, 1), 75)
+        * affine_transform::scaling(vec3(2, 0.5, 3));
+    const point3 kPoint = point3(-4, 5, 0.25);
+    const point3 kRoundTrip =
+        kTransform.inverse().transformPoint(kTransform.transformPoint(kPoint));
+    REQUIRE(kRoundTrip.x() == Approx(kPoint.x()));
+    REQUIRE(kRoundTrip.y() == Approx(kPoint.y()));
+    REQUIRE(kRoundTrip.z() == Approx(kPoint.z()));
+  }
+  SECTION("singular transforms have no inverse") {
+    REQUIRE_THROWS_AS(affine_transform::scaling(vec3(1, 0, 1)).inverse(), std::invalid_argument);
+    REQUIRE_THROWS_AS(instance(std::make_shared<sphere>(point3(0, 0, 0), 1, 0),
+        affine_transform::scaling(vec3(0, 0, 0))), std::invalid_argument);
+  }
+}
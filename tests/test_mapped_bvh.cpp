@@ -0,0 +1,120 @@
+#include <cstdio>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+#include "../project/catch/catch.hpp"
+
+#include "../bvh.h"
+#include "../hittable_list.h"
+#include "../mapped_bvh.h"
+#include "../scenes.h"
+#include "../sphere.h"
+#include "test_scenes.h"
+
+// cache file written by the tests (removed by every test that writes it)
+const char* const kTestCacheFile = "test_bvh_cache.bin";
+
+TEST_CASE("mapped_bvh finds the same closest hits as the bvh it was written from", "[mapped_bvh]") {
+  const RandomSpheresDescription kDescription = randomSpheresDescription(2000, 10);
+  const hittable_list kList = randomSpheres(2000, 10);
+  REQUIRE(writeBvhCache(kTestCacheFile, bvh(kList), sceneHash(kDescription)));
+
+  mapped_bvh mapped_hierarchy;
+  REQUIRE(mapped_hierarchy.load(kTestCacheFile, sceneHash(kDescription)));
+  requireSameClosestHits(kList, mapped_hierarchy, randomRays(4000, 10));
+  std::remove(kTestCacheFile);
+}
+
+TEST_CASE("mapped_bvh rejects the cache of a different scene", "[mapped_bvh]") {
+  const RandomSpheresDescription kDescription = randomSpheresDescription(100, 3);
+  REQUIRE(writeBvhCache(kTestCacheFile, bvh(randomSpheres(100, 3)), sceneHash(kDescription)));
+
+  // the same scene with one sphere fewer, and the scene drawn from another seed
+  RandomSpheresDescription smaller_description = kDescription;
+  --smaller_description.sphere_count_;
+  RandomSpheresDescription reseeded_description = kDescription;
+  ++reseeded_description.seed_;
+  for (const RandomSpheresDescription& kOtherDescription :
+      {smaller_description, reseeded_description}) {
+    mapped_bvh mapped_hierarchy;
+    REQUIRE_FALSE(mapped_hierarchy.load(kTestCacheFile, sceneHash(kOtherDescription)));
+    REQUIRE(mapped_hierarchy.nodeCount() == 0);
+  }
+  std::remove(kTestCacheFile);
+}
+
+/**
+ * Overwrites one node of the test cache file
+ *
+ * @param node_index the index of the node to overwrite
+ * @param kNode constant reference to the node to write in its place
+ */
+void writeTestCacheNode(size_t node_index, const BvhNode& kNode) {
+  std::FILE* cache_file = std::fopen(kTestCacheFile, "r+b");
+  REQUIRE(cache_file != nullptr);
+  BvhCacheHeader header = BvhCacheHeader();
+  REQUIRE(std::fread(&header, sizeof(header), 1, cache_file) == 1);
+  REQUIRE(std::fseek(cache_file, static_cast<long>(header.nodes_offset_
+      + (node_index * sizeof(BvhNode))), SEEK_SET) == 0);
+  REQUIRE(std::fwrite(&kNode, sizeof(kNode), 1, cache_file) == 1);
+  std::fclose(cache_file);
+}
+
+TEST_CASE("mapped_bvh rejects a cache with corrupt nodes", "[mapped_bvh]") {
+  const RandomSpheresDescription kDescription = randomSpheresDescription(100, 3);
+  const bvh kHierarchy = bvh(randomSpheres(100, 3));
+  const std::vector<BvhNode>& kNodes = kHierarchy.nodes();
+  REQUIRE_FALSE(kNodes[0].isLeaf());
+  size_t leaf_index = 0;
+  while (!kNodes[leaf_index].isLeaf()) {
+    ++leaf_index;
+  }
+
+  // every corruption of an interior node (the root) or a leaf that traversal could follow out
+  // of the arrays or around in circles
+  std::vector<std::pair<size_t, BvhNode>> corrupt_nodes;
+  BvhNode node = kNodes[0];
+  node.offset_ = static_cast<uint32_t>(kNodes.size());
+  corrupt_nodes.push_back({0, node});
+  node.offset_ = 0;
+  corrupt_nodes.push_back({0, node});
+  node = kNodes[0];
+  node.split_axis_ = 3;
+  corrupt_nodes.push_back({0, node});
+  node = kNodes[leaf_index];
+  node.object_count_ = 101;
+  corrupt_nodes.push_back({leaf_index, node});
+  node.offset_ = 0xffffffffu;
+  node.object_count_ = 2;
+  corrupt_nodes.push_back({leaf_index, node});
+
+  for (const std::pair<size_t, BvhNode>& kCorruptNode : corrupt_nodes) {
+    REQUIRE(writeBvhCache(kTestCacheFile, kHierarchy, sceneHash(kDescription)));
+    mapped_bvh mapped_hierarchy;
+    REQUIRE(mapped_hierarchy.load(kTestCacheFile, sceneHash(kDescription)));
+    writeTestCacheNode(kCorruptNode.first, kCorruptNode.second);
+    REQUIRE_FALSE(mapped_hierarchy.load(kTestCacheFile, sceneHash(kDescription)));
+    REQUIRE(mapped_hierarchy.nodeCount() == 0);
+  }
+  std::remove(kTestCacheFile);
+}
+
+TEST_CASE("a scene description always generates the same scene", "[scenes]") {
+  const RandomSpheresDescription kDescription = randomSpheresDescription(100, 3);
+  hittable_list first_list = hittable_list();
+  hittable_list second_list = hittable_list();
+  addRandomSpheresScene(first_list, kDescription);
+  addRandomSpheresScene(second_list, kDescription);
+  REQUIRE(first_list.objects().size() == 100);
+  REQUIRE(second_list.objects().size() == 100);
+  for (size_t i = 0; i < first_list.objects().size(); ++i) {
+    const sphere& kFirst = dynamic_cast<const sphere&>(*first_list.objects()[i]);
+    const sphere& kSecond = dynamic_cast<const sphere&>(*second_list.objects()[i]);
+    REQUIRE(kFirst.center().x() == kSecond.center().x());
+    REQUIRE(kFirst.center().y() == kSecond.center().y());
+    REQUIRE(kFirst.center().z() == kSecond.center().z());
+    REQUIRE(kFirst.radius() == kSecond.radius());
+    REQUIRE(kFirst.materialId() == kSecond.materialId());
+  }
+}
@@ -0,0 +1,83 @@
+#include <stdexcept>
+#include <vector>
+
+#include "../project/catch/catch.hpp"
+
+#include "../bvh.h"
+#include "../camera.h"
+#include "../hittable_list.h"
+#include "../material_table.h"
+#include "../renderer.h"
+#include "../scenes.h"
+
+/**
+ * Returns small render settings for the tests
+ *
+ * @return a RenderSettings for a 48x27 image with 4 samples per pixel on 2 threads
+ */
+RenderSettings testRenderSettings() {
+  RenderSettings settings = RenderSettings();
+  settings.image_width_ = 48;
+  settings.image_height_ = 27;
+  settings.samples_per_pixel_ = 4;
+  settings.max_ray_bounces_ = 50;
+  settings.tile_size_ = 16;
+  settings.num_threads_ = 2;
+  settings.use_russian_roulette_ = true;
+  settings.russian_roulette_min_bounces_ = 5;
+  return settings;
+}
+
+/**
+ * Requires that the two given framebuffers store exactly the same colors
+ *
+ * @param kFirst constant reference to the first framebuffer
+ * @param kSecond constant reference to the second framebuffer
+ */
+void requireSameFramebuffers(const std::vector<color>& kFirst, const std::vector<color>& kSecond) {
+  REQUIRE(kFirst.size() == kSecond.size());
+  for (size_t i = 0; i < kFirst.size(); ++i) {
+    REQUIRE(kFirst[i].x() == kSecond[i].x());
+    REQUIRE(kFirst[i].y() == kSecond[i].y());
+    REQUIRE(kFirst[i].z() == kSecond[i].z());
+  }
+}
+
+TEST_CASE("renders do not depend on how the image is traced", "[renderer]") {
+  hittable_list world = hittable_list();
+  material_table materials = material_table();
+  addGlassSpheresScene(world, materials);
+  const bvh kWorldHierarchy = bvh(world);
+  RenderSettings settings = testRenderSettings();
+  const std::vector<color> kReference = renderImage(camera(), kWorldHierarchy, materials,
+      settings);
+
+  SECTION("other tile sizes and thread counts") {
+    settings.tile_size_ = 7;
+    settings.num_threads_ = 3;
+    requireSameFramebuffers(kReference, renderImage(camera(), kWorldHierarchy, materials,
+        settings));
+  }
+  SECTION("wavefront") {
+    settings.use_wavefront_ = true;
+    requireSameFramebuffers(kReference, renderImage(camera(), kWorldHierarchy, materials,
+        settings));
+  }
+  SECTION("camera ray packets of every size") {
+    for (int packet_size : {4, 8, 16}) {
+      settings.ray_packet_size_ = packet_size;
+      requireSameFramebuffers(kReference, renderImage(camera(), kWorldHierarchy, materials,
+          settings));
+    }
+  }
+}
+
+TEST_CASE("renderImage rejects unsupported ray packet sizes", "[renderer]") {
+  hittable_list world = hittable_list();
+  material_table materials = material_table();
+  addMetalSpheresScene(world, materials);
+  RenderSettings settings = testRenderSettings();
+  settings.ray_packet_size_ = 5;
+  REQUIRE_THROWS_AS(renderImage(camera(), bvh(world), materials, settings),
+      std::invalid_argument);
+}
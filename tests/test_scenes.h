@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "../project/catch/catch.hpp"
+
+#include "../constants_and_utilities.h"
+#include "../Hittable.h"
+#include "../hittable_list.h"
+#include "../ray.h"
+#include "../scenes.h"
+#include "../sphere.h"
+#include "../vec3.h"
+
+/**
+ * Returns the description of a scene of random spheres scattered through a cube, drawn from a
+ * fixed random stream so every run of the tests sees the same scene
+ *
+ * @param num_spheres the number of spheres in the scene
+ * @param half_size half of the width of the cube the centers are in
+ * @return a RandomSpheresDescription of the scene, with material IDs 0 to 3
+ */
+inline RandomSpheresDescription randomSpheresDescription(size_t num_spheres, real half_size) {
+  return RandomSpheresDescription{1, num_spheres, half_size, 0.1, 0.6, 4};
+}
+
+/**
+ * Returns a list of the spheres of the scene randomSpheresDescription describes
+ *
+ * @param num_spheres the number of spheres in the list
+ * @param half_size half of the width of the cube the centers are in
+ * @return a hittable_list of the spheres, with material IDs 0 to 3
+ */
+inline hittable_list randomSpheres(size_t num_spheres, real half_size) {
+  hittable_list list = hittable_list();
+  addRandomSpheresScene(list, randomSpheresDescription(num_spheres, half_size));
+  return list;
+}
+
+/**
+ * Returns a list of random spheres whose radii span six orders of magnitude, each centered within
+ * half its radius of the origin, drawn from a fixed random stream
+ *
+ * Optimizing the treelets of such a scene peels the largest spheres off one level at a time,
+ * which makes the tree far deeper than a Morton code split alone would
+ *
+ * @param num_spheres the number of spheres in the list
+ * @return a hittable_list of the spheres, with material ID 0
+ */
+inline hittable_list nestedSpheres(size_t num_spheres) {
+  setRandomStream(5, 0, 0);
+  hittable_list list = hittable_list();
+  for (size_t i = 0; i < num_spheres; ++i) {
+    const real kRadius = std::pow(10, randomDouble(-4, 2));
+    list.add(std::make_shared<sphere>(randomVector(-0.5, 0.5) * kRadius, kRadius, 0));
+  }
+  return list;
+}
+
+/**
+ * Returns random rays starting inside a cube, drawn from a fixed random stream
+ *
+ * @param num_rays the number of rays to return
+ * @param half_size half of the width of the cube the origins are in
+ * @return a vector of the rays, whose directions are unit vectors
+ */
+inline std::vector<ray> randomRays(size_t num_rays, real half_size) {
+  setRandomStream(2, 0, 0);
+  std::vector<ray> rays;
+  for (size_t i = 0; i < num_rays; ++i) {
+    rays.push_back(ray(randomVector(-half_size, half_size), randomUnitVector()));
+  }
+  return rays;
+}
+
+/**
+ * Requires that the closest hit of every given ray with the given objects is exactly the same as
+ * with the reference objects
+ *
+ * @param kReference constant reference to the objects to compare against (usually a
+ *     hittable_list)
+ * @param kObjects constant reference to the objects to check
+ * @param kRays constant reference to the rays to trace through both
+ */
+inline void requireSameClosestHits(const Hittable& kReference, const Hittable& kObjects,
+    const std::vector<ray>& kRays) {
+  size_t num_hits = 0;
+  for (const ray& kRay : kRays) {
+    HitRecord reference_hit = HitRecord();
+    HitRecord hit = HitRecord();
+    const bool kReferenceWasHit = kReference.wasHit(kRay, 0.001, infinity, reference_hit);
+    REQUIRE(kObjects.wasHit(kRay, 0.001, infinity, hit) == kReferenceWasHit);
+    if (kReferenceWasHit) {
+      ++num_hits;
+      REQUIRE(hit.t_ == reference_hit.t_);
+      REQUIRE(hit.material_id_ == reference_hit.material_id_);
+      REQUIRE(hit.point_of_intersection_.x() == reference_hit.point_of_intersection_.x());
+      REQUIRE(hit.point_of_intersection_.y() == reference_hit.point_of_intersection_.y());
+      REQUIRE(hit.point_of_intersection_.z() == reference_hit.point_of_intersection_.z());
+      REQUIRE(hit.surface_normal_.x() == reference_hit.surface_normal_.x());
+      REQUIRE(hit.surface_normal_.y() == reference_hit.surface_normal_.y());
+      REQUIRE(hit.surface_normal_.z() == reference_hit.surface_normal_.z());
+      REQUIRE(hit.front_facing_ == reference_hit.front_facing_);
+    }
+  }
+  // the scenes are dense enough that most rays hit something, or the test would prove little
+  REQUIRE(num_hits > kRays.size() / 2);
+}
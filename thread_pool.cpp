@@ -0,0 +1,119 @@
+#include "thread_pool.h"
+
+// index of the queue owned by the current thread (only meaningful on worker threads)
+thread_local size_t current_worker_index = 0;
+// pool that the current thread is a worker of (nullptr for threads outside every pool)
+thread_local const thread_pool* current_worker_pool = nullptr;
+
+thread_pool::thread_pool(size_t num_threads) : queued_task_count_(0), next_queue_index_(0) {
+  if (num_threads == 0) {
+    num_threads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+  }
+  for (size_t i = 0; i < num_threads; ++i) {
+    queues_.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+  }
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads_.push_back(std::thread(&thread_pool::workerLoop, this, i));
+  }
+}
+
+thread_pool::~thread_pool() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+  for (std::thread& worker : threads_) {
+    worker.join();
+  }
+}
+
+void thread_pool::submit(std::function<void()> task) {
+  size_t queue_index;
+  if (current_worker_pool == this) {
+    queue_index = current_worker_index;
+  } else {
+    queue_index = next_queue_index_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+  }
+  {
+    // count the task before it becomes visible so the count never drops below zero, and
+    // do it under the sleep mutex so a worker checking for work cannot miss the wakeup
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    queued_task_count_.fetch_add(1, std::memory_order_release);
+  }
+  {
+    std::lock_guard<std::mutex> lock(queues_[queue_index]->mutex_);
+    queues_[queue_index]->tasks_.push_back(std::move(task));
+  }
+  work_available_.notify_one();
+}
+
+void thread_pool::parallelFor(size_t count, const std::function<void(size_t)>& kBody) {
+  std::atomic<size_t> remaining_count(count);
+  for (size_t i = 0; i < count; ++i) {
+    submit([&kBody, &remaining_count, i]() {
+      kBody(i);
+      remaining_count.fetch_sub(1, std::memory_order_release);
+    });
+  }
+
+  // help with the queued work instead of blocking until the last index finishes
+  const size_t kQueueIndex = current_worker_pool == this ? current_worker_index : 0;
+  std::function<void()> task;
+  while (remaining_count.load(std::memory_order_acquire) > 0) {
+    if (popTask(kQueueIndex, task)) {
+      task();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+size_t thread_pool::threadCount() const {
+  return threads_.size();
+}
+
+bool thread_pool::popTask(size_t queue_index, std::function<void()>& task) {
+  // own queue first, newest task first
+  {
+    WorkerQueue& own_queue = *queues_[queue_index];
+    std::lock_guard<std::mutex> lock(own_queue.mutex_);
+    if (!own_queue.tasks_.empty()) {
+      task = std::move(own_queue.tasks_.back());
+      own_queue.tasks_.pop_back();
+      queued_task_count_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  // then steal the oldest task from the other queues
+  for (size_t i = 1; i < queues_.size(); ++i) {
+    WorkerQueue& victim_queue = *queues_[(queue_index + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim_queue.mutex_);
+    if (!victim_queue.tasks_.empty()) {
+      task = std::move(victim_queue.tasks_.front());
+      victim_queue.tasks_.pop_front();
+      queued_task_count_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+void thread_pool::workerLoop(size_t worker_index) {
+  current_worker_index = worker_index;
+  current_worker_pool = this;
+  std::function<void()> task;
+  while (true) {
+    if (popTask(worker_index, task)) {
+      task();
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    work_available_.wait(lock, [this]() {
+      return stopping_ || queued_task_count_.load(std::memory_order_acquire) > 0;
+    });
+    if (stopping_ && queued_task_count_.load(std::memory_order_acquire) == 0) {
+      return;
+    }
+  }
+}
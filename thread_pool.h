@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Class representing a pool of worker threads that share work by stealing
+ *
+ * Every worker owns a queue of tasks. Workers take tasks from the back of their own queue
+ * (most recently added, so nested work stays cache-warm) and, when their queue is empty,
+ * steal from the front of the other workers' queues (oldest, so the stolen work is large)
+ */
+class thread_pool {
+  public:
+    /**
+     * Constructor that starts the given number of worker threads
+     *
+     * @param num_threads the number of worker threads to start (0 uses one thread per
+     *     hardware thread)
+     */
+    explicit thread_pool(size_t num_threads);
+
+    /**
+     * Destructor that waits for the queued tasks to finish and joins the worker threads
+     */
+    ~thread_pool();
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    /**
+     * Queues the given task to be run by one of the worker threads
+     * Tasks submitted from a worker thread go to that worker's own queue
+     *
+     * @param task a function to run on a worker thread
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * Runs kBody(i) for every i in [0, count) on the pool and returns once all of them are done
+     * The calling thread runs queued tasks while it waits, so parallelFor can be nested inside
+     * tasks that are already running on the pool
+     *
+     * @param count the number of indices to run the body for
+     * @param kBody constant reference to the function to run for every index
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)>& kBody);
+
+    /**
+     * Returns the number of worker threads in the pool
+     *
+     * @return a size_t representing the number of worker threads in the pool
+     */
+    size_t threadCount() const;
+
+  private:
+    /**
+     * Struct storing the queue of tasks owned by a single worker
+     */
+    struct WorkerQueue {
+      // mutex guarding tasks_
+      std::mutex mutex_;
+      // deque of tasks waiting to run (owner pops from the back, thieves from the front)
+      std::deque<std::function<void()>> tasks_;
+    };
+
+    /**
+     * Takes a task from the given worker's queue or, if that is empty, steals one from
+     * another worker's queue
+     *
+     * @param queue_index the index of the queue to look in first
+     * @param task reference to a function to update with the task that was taken
+     * @return true if a task was taken and false if every queue was empty
+     */
+    bool popTask(size_t queue_index, std::function<void()>& task);
+
+    /**
+     * Loop run by every worker thread until the pool is destroyed
+     *
+     * @param worker_index the index of the worker (and of its queue in queues_)
+     */
+    void workerLoop(size_t worker_index);
+
+    // vector storing one task queue per worker
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    // vector storing the worker threads
+    std::vector<std::thread> threads_;
+    // mutex guarding stopping_ and used to put idle workers to sleep
+    std::mutex sleep_mutex_;
+    // condition variable signalled whenever a task is queued or the pool is stopping
+    std::condition_variable work_available_;
+    // number of tasks that are queued but have not been taken by a thread yet
+    std::atomic<size_t> queued_task_count_;
+    // index of the queue that the next task submitted from outside the pool goes to
+    std::atomic<size_t> next_queue_index_;
+    // true once the destructor has asked the workers to exit
+    bool stopping_ = false;
+};
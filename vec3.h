@@ -1,64 +1,107 @@
 #pragma once
 
 #include <cmath>
+#include <iostream>
+#include <type_traits>
 
 #include "constants_and_utilities.h"
+#include "vec3_simd.h"
 
 /**
  * class representing a 3D vector
+ * 
+ * vec3 is a trivially copyable value type (24 bytes, or 32 bytes with a SIMD backend) and 
+ * every arithmetic operation is defined inline in this header, so vectors can be kept in 
+ * registers across the intersection and scattering code. The arithmetic itself is done by 
+ * the backend selected in vec3_simd.h
  */
 class vec3 {
   public:
     /**
      * Default Constructor - Sets all values to 0
      */
-    vec3();
+    constexpr vec3() : data_{0.0, 0.0, 0.0} {}
 
     /**
      * Constructor that initializes values to provided values
      * 
-     * @param value1 double to assign to the x (first) value
-     * @param value2 double to assign to the y (second) value
-     * @param value3 double to assign to the z (third) value
+     * @param value1 real to assign to the x (first) value
+     * @param value2 real to assign to the y (second) value
+     * @param value3 real to assign to the z (third) value
+     */
+#ifdef RAYTRACER_VEC3_SIMD
+    // built in registers so the first full-width load does not stall on three scalar stores
+    vec3(real value1, real value2, real value3) {
+      lanesStore(data_, lanesSet(value1, value2, value3));
+    }
+#else
+    constexpr vec3(real value1, real value2, real value3) : data_{value1, value2, value3} {}
+#endif
+
+    /**
+     * Constructor that stores the values held in the given registers
+     * 
+     * @param kLanes constant reference to the register form of a vec3
+     */
+    explicit vec3(const Vec3Lanes& kLanes) {
+      lanesStore(data_, kLanes);
+    }
+
+    /**
+     * Returns the values of the vector loaded into registers for the SIMD backend
+     * 
+     * @return a Vec3Lanes holding the x, y, and z values of the vector
      */
-    vec3(double value1, double value2, double value3);
+    inline Vec3Lanes lanes() const {
+      return lanesLoad(data_);
+    }
 
     /**
      * Returns the x value(first value)
      * 
-     * @return double representing the x value (first value)
+     * @return real representing the x value (first value)
      */
-    double x() const;
+    constexpr real x() const {
+      return data_[0];
+    }
 
     /**
      * Returns the y value (second value)
      * 
-     * @return double representing the y value (second value)
+     * @return real representing the y value (second value)
      */
-    double y() const;
+    constexpr real y() const {
+      return data_[1];
+    }
 
     /**
      * Returns the z value (third value)
      * 
-     * @return double representing the z value (third value)
+     * @return real representing the z value (third value)
      */
-    double z() const;
+    constexpr real z() const {
+      return data_[2];
+    }
 
     /**
      * Overloaded Unary Minus Operator
      * 
      * @return a vec3 with all stored values multiplied by -1
      */
-    vec3 operator-() const;
+    inline vec3 operator-() const {
+      return vec3(lanesNegate(lanes()));
+    }
 
     /**
      * Overloaded Subscript Operator
      * 
      * @param i int representing the index in data_ to get the value of
-     * @return double representing the value stored in the given index of data_
+     * @return real representing the value stored in the given index of data_
      * @throws out_of_range_error for values not 0-2
      */
-    double operator[](int i) const;
+    constexpr real operator[](int i) const {
+      return data_[i];
+    }
 
     /**
      * Overloaded Addition Assignment Operator
@@ -68,48 +111,64 @@ class vec3 {
      * @param kToAdd constant reference to a vec3 to add to this vec3
      * @return a reference to this vec3 after the addition
      */
-    vec3& operator+=(const vec3& kToAdd);
+    inline vec3& operator+=(const vec3& kToAdd) {
+      lanesStore(data_, lanesAdd(lanes(), kToAdd.lanes()));
+      return *this;
+    }
 
     /**
      * Overloaded Multiplication Assignment Operator
      * Multiplies each member of data_ by the given scalar multiple
      * 
-     * @param kScalarMultiple constant double representing the scalar to multiply each 
+     * @param kScalarMultiple constant real representing the scalar to multiply each 
      *     member of data_ by
      * @return a reference to this vec3 after the multiplications
      */
-    vec3& operator*=(const double kScalarMultiple);
+    inline vec3& operator*=(const real kScalarMultiple) {
+      lanesStore(data_, lanesScale(lanes(), kScalarMultiple));
+      return *this;
+    }
 
     /**
      * Overloaded Division Assignment Operator
      * Divides each member of data_ the given divisor
      * 
-     * @param kDivisor constant double representing the scalar to divide each
+     * @param kDivisor constant real representing the scalar to divide each
      *     member of data_ by
      * @return a reference to this vec3 after the divisions
      */
-    vec3& operator/=(const double kDivisor);
+    inline vec3& operator/=(const real kDivisor) {
+      return *this *= (1 / kDivisor);
+    }
 
     /**
      * Get the length of the vector
      * 
-     * @return a double representing the length of the vector
+     * @return a real representing the length of the vector
      */
-    double length() const;
+    inline real length() const {
+      return std::sqrt(lengthSquared());
+    }
 
     /**
      * Get the length of the vector squared
      * 
-     * @return a double representing the lenght of the vector squared
+     * @return a real representing the lenght of the vector squared
      */
-    double lengthSquared() const;
+    inline real lengthSquared() const {
+      return lanesDot(lanes(), lanes());
+    }
 
     /**
      * Returns true if the vector is close to 0 in all directions
      * 
      * @return true if the vector is close to 0 in all directions and false otherwise
      */
-    bool nearZero() const;
+    inline bool nearZero() const {
+      const real kValueCloseToZero = 1e-8;
+      return std::fabs(data_[0] < kValueCloseToZero) && std::fabs(data_[1] < kValueCloseToZero)
+          && std::fabs(data_[2] < kValueCloseToZero);
+    }
 
   private:
     /**
@@ -117,19 +176,14 @@ class vec3 {
      * Index 0 stores the x (first) value
      * Index 1 stores the y (second) value
      * Index 2 stores the z (third) value
+     * Index 3 (SIMD backends only) is padding that is never read back
      */
-    double data_[3];
-    
-    // size_t storing the index in data_ of the x (first) value
-    size_t x_index_ = 0;
-
-    // size_t storing the index in data_ of the y (second) value
-    size_t y_index_ = 1;
-
-    // size_t storing the index in data_ of the z (third) value
-    size_t z_index_ = 2;
+    alignas(kVec3Alignment) real data_[kVec3StorageSize];
 };
 
+static_assert(sizeof(vec3) == kVec3StorageSize * sizeof(real), "vec3 must stay a packed vector");
+static_assert(std::is_trivially_copyable<vec3>::value, "vec3 must stay trivially copyable");
+
 // Type aliases for vec3 (point3 and color)
 using point3 = vec3;
 using color = vec3;
@@ -143,7 +197,10 @@ using color = vec3;
  * @param kVectorToPrint constant reference to a vec3 to add the values from
  * @return a reference to the given stream with the values of the given vector added to it
  */
-inline std::ostream& operator<<(std::ostream& stream, const vec3& kVectorToPrint);
+inline std::ostream& operator<<(std::ostream& stream, const vec3& kVectorToPrint) {
+  stream << kVectorToPrint.x() << ' ' << kVectorToPrint.y() << ' ' << kVectorToPrint.z();
+  return stream;
+}
 
 /**
  * Overloaded Adition Operator
@@ -154,7 +211,9 @@ inline std::ostream& operator<<(std::ostream& stream, const vec3& kVectorToPrint
  * @param kVectorTwo constant reference to the second vector to add
  * @return a vec3 that is the result of the addition of the given vectors 
  */
-inline vec3 operator+(const vec3& kVectorOne, const vec3& kVectorTwo);
+inline vec3 operator+(const vec3& kVectorOne, const vec3& kVectorTwo) {
+  return vec3(lanesAdd(kVectorOne.lanes(), kVectorTwo.lanes()));
+}
 
 /**
  * Overloaded Subtraction Operator 
@@ -168,7 +227,9 @@ inline vec3 operator+(const vec3& kVectorOne, const vec3& kVectorTwo);
  * @return a vec3 that is the result of the subtraction of the second vector
  *     from the first
  */
-inline vec3 operator-(const vec3& kVector, const vec3& kToSubtract);
+inline vec3 operator-(const vec3& kVector, const vec3& kToSubtract) {
+  return vec3(lanesSubtract(kVector.lanes(), kToSubtract.lanes()));
+}
 
 /**
  * Overloaded Multiplication Operator
@@ -179,38 +240,46 @@ inline vec3 operator-(const vec3& kVector, const vec3& kToSubtract);
  * @param kVectorTwo constant reference to the second vector to multiply
  * @return a vec3 that is the result of the multiplication of the given vectors 
  */
-inline vec3 operator*(const vec3& kVectorOne, const vec3& kVectorTwo);
+inline vec3 operator*(const vec3& kVectorOne, const vec3& kVectorTwo) {
+  return vec3(lanesMultiply(kVectorOne.lanes(), kVectorTwo.lanes()));
+}
 
 /**
  * Overloaded Multiplication Operator
  * Multiplies each member of data_ of the given vectorby the given scalar multiple
  * 
  * @param kVector constant reference to the vec3 to scale
- * @param kScalarMultiple constant double representing the scalar to multiply each 
+ * @param kScalarMultiple constant real representing the scalar to multiply each 
  *     member of data_ in the given vector by
  * @return a vec3 that is the result of the scalar multiplication
  */
-inline vec3 operator*(const vec3& kVector, const double kScalarMultiple);
+inline vec3 operator*(const vec3& kVector, const real kScalarMultiple) {
+  return vec3(lanesScale(kVector.lanes(), kScalarMultiple));
+}
 
 /**
  * Overloaded Division Operator
  * Divides each member of data_ in the given vector by the divisor
  * 
  * @param kVector constant reference to the vec3 to scale
- * @param kDivisor constant double representing the scalar to divide each
+ * @param kDivisor constant real representing the scalar to divide each
  *     member of data_ in the given vector by
  * @return a vec3 that is the result of the scalar division
  */
-inline vec3 operator/(const vec3& kVector, const double kDivisor);
+inline vec3 operator/(const vec3& kVector, const real kDivisor) {
+  return kVector * (1 / kDivisor);
+}
 
 /**
  * Returns the dot product of the given vectors
  * 
  * @param kVectorOne constant reference to the first vector to dot 
  * @param kVectorTwo constant reference to the second vector to dot
- * @return a double representing the dot product of the given vectors
+ * @return a real representing the dot product of the given vectors
  */
-inline double dot(const vec3& kVectorOne, const vec3& kVectorTwo);
+inline real dot(const vec3& kVectorOne, const vec3& kVectorTwo) {
+  return lanesDot(kVectorOne.lanes(), kVectorTwo.lanes());
+}
 
 /**
  * Returns the cross product of the given vectors
@@ -219,7 +288,11 @@ inline double dot(const vec3& kVectorOne, const vec3& kVectorTwo);
  * @param kVectorTwo constant reference to the second vector in the cross product
  * @return a vec3 representing the cross product of the given vectors
  */
-inline vec3 cross(const vec3& kVectorOne, const vec3& kVectorTwo);
+inline vec3 cross(const vec3& kVectorOne, const vec3& kVectorTwo) {
+  return vec3((kVectorOne.y() * kVectorTwo.z()) - (kVectorOne.z() - kVectorTwo.y()),
+      (kVectorTwo.x() * kVectorOne.z()) - (kVectorOne.x() * kVectorTwo.z()), 
+      (kVectorOne.x() * kVectorTwo.y()) - (kVectorOne.y() * kVectorTwo.x()));
+}
 
 /**
  * Returns the unit vector of the given vector
@@ -227,7 +300,9 @@ inline vec3 cross(const vec3& kVectorOne, const vec3& kVectorTwo);
  * @param vector vec3 to normalize
  * @retunr a vec3 representing the unit vector of the given vector
  */
-inline vec3 unitVector(vec3 vector);
+inline vec3 unitVector(vec3 vector) {
+  return vector / vector.length();
+}
 
 /**
  * Adds the given color's [0, 255] values to the given stream
@@ -247,7 +322,9 @@ void writeColor(std::ostream& stream, color pixel_color, double num_samples);
  * @return a random vector where x, y, and z components are 
  *     in range [0, 1)
  */
-inline vec3 randomVector();
+inline vec3 randomVector() {
+  return vec3(randomDouble(), randomDouble(), randomDouble());
+}
 
 /**
  * Returns a random vector where x, y, and z components are in
@@ -260,14 +337,24 @@ inline vec3 randomVector();
  * @return a random vector where x, y, and z components are in
  *     the range [min, max)
  */
-inline vec3 randomVector(double min, double max);
+inline vec3 randomVector(real min, real max) {
+  return vec3(randomDouble(min, max), randomDouble(min, max), 
+      randomDouble(min, max));
+}
 
 /**
  * Returns a random point in the unit sphere
  * 
  * @return a point3 representing a random point in the unit sphere
  */
-inline point3 randomPointInUnitSphere();
+inline point3 randomPointInUnitSphere() {
+  while (true) {
+    const point3 kRandomPoint = randomVector(-1, 1);
+    if (kRandomPoint.lengthSquared() < 1) {
+      return kRandomPoint;
+    }
+  }
+}
 
 /**
  * Returns a random unit vector
@@ -285,7 +372,9 @@ vec3 randomUnitVector();
  * @return a vec3 representing the reflected ray of the given ray off of a surface
  *     with the given surface normal
  */
-vec3 reflect(const vec3& kRayToReflect, const vec3& kNormal);
+inline vec3 reflect(const vec3& kRayToReflect, const vec3& kNormal) {
+  return kRayToReflect - kNormal * (dot(kRayToReflect, kNormal) * 2);
+}
 
 /**
  * Computes the refracted ray of the given ray with a surface with the given surface normal
@@ -294,8 +383,15 @@ vec3 reflect(const vec3& kRayToReflect, const vec3& kNormal);
  * @param kRayToRefract a constant reference to a vec3 representing the ray to be refracted
  * @param kNormal a constant reference to a vec3 representing the surface normal of the surface for
  *     the given ray to refract with
- * @param kEtaIntialOverEtaFinal a constant double representing the value of 𝜂/𝜂' for the refraction
+ * @param kEtaIntialOverEtaFinal a constant real representing the value of 𝜂/𝜂' for the refraction
  * @return a vec3 representing the refracted ray of the given ray with a surface with the given
  *     surface normal and the given value of 𝜂/𝜂'
  */
-vec3 refract(const vec3& kRayToRefract, const vec3& kNormal, const double kEtaIntialOverEtaFinal);
+inline vec3 refract(const vec3& kRayToRefract, const vec3& kNormal, const real kEtaIntialOverEtaFinal) {
+  const real kCosTheta = std::fmin(dot(-kRayToRefract, kNormal), 1.0);
+  const vec3 kPerpendicularComponentRefractedRay =(kRayToRefract + (kNormal * kCosTheta))
+      *  kEtaIntialOverEtaFinal;
+  const vec3 kParallelComponentRefractedRay = kNormal * (-std::sqrt(std::fabs(1.0 
+      - kPerpendicularComponentRefractedRay.lengthSquared())));
+  return kPerpendicularComponentRefractedRay + kParallelComponentRefractedRay;
+}
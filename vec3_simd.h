@@ -0,0 +1,206 @@
+#pragma once
+
+/**
+ * Compile-time selectable backends for the arithmetic of vec3
+ *
+ * Build with -DRAYTRACER_SIMD_SSE4 (and -msse4.1) to keep a double vec3 in two 128 bit
+ * registers (or a float vec3 in one), or without it for plain scalar code. The SSE4 backend pads
+ * a vec3 with a fourth lane that is never read back, so every horizontal operation only combines
+ * the first three lanes
+ *
+ * Builds with -DRAYTRACER_SIMD_AVX2 keep the scalar vec3 and only use AVX2 for RealLanes (see
+ * real_lanes.h): a vec3 in a 256 bit register has to be padded to 32 bytes, which made every
+ * vec3 load, copy, and horizontal sum slower than the 24 byte scalar vec3 it replaced
+ *
+ * Every backend provides the same interface:
+ *   Vec3Lanes                     the register form of a vec3
+ *   lanesSet                      builds the register form from x, y, and z values
+ *   lanesLoad / lanesStore        move a vec3's values between memory and registers
+ *   lanesAdd / lanesSubtract / lanesMultiply   component-wise arithmetic
+ *   lanesScale                    multiplies every component by a scalar
+ *   lanesNegate                   flips the sign of every component
+ *   lanesDot                      dot product of the x, y, and z components, summed as (x + y) + z
+ *                                 so every backend rounds identically
+ */
+
+#if defined(RAYTRACER_SIMD_SSE4)
+#include <smmintrin.h>
+#endif
+
+#include "constants_and_utilities.h"
+
+#if defined(RAYTRACER_SIMD_SSE4)
+// defined when vec3 is backed by SIMD registers
+#define RAYTRACER_VEC3_SIMD
+#endif
+
+#if defined(RAYTRACER_VEC3_SIMD)
+// number of reals stored in a vec3 (x, y, z, and padding)
+const int kVec3StorageSize = 4;
+// alignment of a vec3, so that copies move whole registers
+const int kVec3Alignment = 16;
+#else
+// number of reals stored in a vec3 (x, y, and z)
+const int kVec3StorageSize = 3;
+// alignment of a vec3
+const int kVec3Alignment = alignof(real);
+#endif
+
+#if defined(RAYTRACER_VEC3_SIMD) && defined(RAYTRACER_USE_FLOAT)
+
+// name of the backend, for reports
+const char* const kVec3BackendName = "sse4 (float)";
+
+/**
+ * Struct storing the x, y, z (and padding) values of a float vec3 in a 128 bit register
+ */
+struct Vec3Lanes {
+  __m128 xyzw_;
+};
+
+inline Vec3Lanes lanesSet(float x, float y, float z) {
+  return Vec3Lanes{_mm_set_ps(0.0f, z, y, x)};
+}
+
+inline Vec3Lanes lanesLoad(const float* kData) {
+  return Vec3Lanes{_mm_load_ps(kData)};
+}
+
+inline void lanesStore(float* data, Vec3Lanes lanes) {
+  _mm_store_ps(data, lanes.xyzw_);
+}
+
+inline Vec3Lanes lanesAdd(Vec3Lanes first, Vec3Lanes second) {
+  return Vec3Lanes{_mm_add_ps(first.xyzw_, second.xyzw_)};
+}
+
+inline Vec3Lanes lanesSubtract(Vec3Lanes first, Vec3Lanes second) {
+  return Vec3Lanes{_mm_sub_ps(first.xyzw_, second.xyzw_)};
+}
+
+inline Vec3Lanes lanesMultiply(Vec3Lanes first, Vec3Lanes second) {
+  return Vec3Lanes{_mm_mul_ps(first.xyzw_, second.xyzw_)};
+}
+
+inline Vec3Lanes lanesScale(Vec3Lanes lanes, float scalar) {
+  return Vec3Lanes{_mm_mul_ps(lanes.xyzw_, _mm_set1_ps(scalar))};
+}
+
+inline Vec3Lanes lanesNegate(Vec3Lanes lanes) {
+  return Vec3Lanes{_mm_xor_ps(lanes.xyzw_, _mm_set1_ps(-0.0f))};
+}
+
+inline float lanesDot(Vec3Lanes first, Vec3Lanes second) {
+  const __m128 kProducts = _mm_mul_ps(first.xyzw_, second.xyzw_);
+  // (x + y) + z, the same order as the scalar backend
+  const __m128 kXPlusY = _mm_add_ss(kProducts, _mm_shuffle_ps(kProducts, kProducts, 1));
+  return _mm_cvtss_f32(_mm_add_ss(kXPlusY, _mm_movehl_ps(kProducts, kProducts)));
+}
+
+#elif defined(RAYTRACER_SIMD_SSE4)
+
+// name of the backend, for reports
+const char* const kVec3BackendName = "sse4";
+
+/**
+ * Struct storing the x, y, z (and padding) values of a vec3 in two 128 bit registers
+ */
+struct Vec3Lanes {
+  __m128d xy_;
+  __m128d zw_;
+};
+
+inline Vec3Lanes lanesSet(double x, double y, double z) {
+  return Vec3Lanes{_mm_set_pd(y, x), _mm_set_pd(0.0, z)};
+}
+
+inline Vec3Lanes lanesLoad(const double* kData) {
+  return Vec3Lanes{_mm_load_pd(kData), _mm_load_pd(kData + 2)};
+}
+
+inline void lanesStore(double* data, Vec3Lanes lanes) {
+  _mm_store_pd(data, lanes.xy_);
+  _mm_store_pd(data + 2, lanes.zw_);
+}
+
+inline Vec3Lanes lanesAdd(Vec3Lanes first, Vec3Lanes second) {
+  return Vec3Lanes{_mm_add_pd(first.xy_, second.xy_), _mm_add_pd(first.zw_, second.zw_)};
+}
+
+inline Vec3Lanes lanesSubtract(Vec3Lanes first, Vec3Lanes second) {
+  return Vec3Lanes{_mm_sub_pd(first.xy_, second.xy_), _mm_sub_pd(first.zw_, second.zw_)};
+}
+
+inline Vec3Lanes lanesMultiply(Vec3Lanes first, Vec3Lanes second) {
+  return Vec3Lanes{_mm_mul_pd(first.xy_, second.xy_), _mm_mul_pd(first.zw_, second.zw_)};
+}
+
+inline Vec3Lanes lanesScale(Vec3Lanes lanes, double scalar) {
+  const __m128d kScalar = _mm_set1_pd(scalar);
+  return Vec3Lanes{_mm_mul_pd(lanes.xy_, kScalar), _mm_mul_pd(lanes.zw_, kScalar)};
+}
+
+inline Vec3Lanes lanesNegate(Vec3Lanes lanes) {
+  const __m128d kSignBits = _mm_set1_pd(-0.0);
+  return Vec3Lanes{_mm_xor_pd(lanes.xy_, kSignBits), _mm_xor_pd(lanes.zw_, kSignBits)};
+}
+
+inline double lanesDot(Vec3Lanes first, Vec3Lanes second) {
+  // dp_pd with mask 0x31 sums x and y into the low lane, then z is added on (x + y) + z
+  const __m128d kXPlusY = _mm_dp_pd(first.xy_, second.xy_, 0x31);
+  return _mm_cvtsd_f64(_mm_add_sd(kXPlusY, _mm_mul_sd(first.zw_, second.zw_)));
+}
+
+#else
+
+// name of the backend, for reports
+const char* const kVec3BackendName = "scalar";
+
+/**
+ * Struct storing the x, y, and z values of a vec3 as plain scalars
+ */
+struct Vec3Lanes {
+  real x_;
+  real y_;
+  real z_;
+};
+
+inline Vec3Lanes lanesSet(real x, real y, real z) {
+  return Vec3Lanes{x, y, z};
+}
+
+inline Vec3Lanes lanesLoad(const real* kData) {
+  return Vec3Lanes{kData[0], kData[1], kData[2]};
+}
+
+inline void lanesStore(real* data, Vec3Lanes lanes) {
+  data[0] = lanes.x_;
+  data[1] = lanes.y_;
+  data[2] = lanes.z_;
+}
+
+inline Vec3Lanes lanesAdd(Vec3Lanes first, Vec3Lanes second) {
+  return Vec3Lanes{first.x_ + second.x_, first.y_ + second.y_, first.z_ + second.z_};
+}
+
+inline Vec3Lanes lanesSubtract(Vec3Lanes first, Vec3Lanes second) {
+  return Vec3Lanes{first.x_ - second.x_, first.y_ - second.y_, first.z_ - second.z_};
+}
+
+inline Vec3Lanes lanesMultiply(Vec3Lanes first, Vec3Lanes second) {
+  return Vec3Lanes{first.x_ * second.x_, first.y_ * second.y_, first.z_ * second.z_};
+}
+
+inline Vec3Lanes lanesScale(Vec3Lanes lanes, real scalar) {
+  return Vec3Lanes{lanes.x_ * scalar, lanes.y_ * scalar, lanes.z_ * scalar};
+}
+
+inline Vec3Lanes lanesNegate(Vec3Lanes lanes) {
+  return Vec3Lanes{-lanes.x_, -lanes.y_, -lanes.z_};
+}
+
+inline real lanesDot(Vec3Lanes first, Vec3Lanes second) {
+  return (first.x_ * second.x_) + (first.y_ * second.y_) + (first.z_ * second.z_);
+}
+
+#endif
@@ -0,0 +1,251 @@
+#include <chrono>
+
+#include "wavefront.h"
+
+void RayQueue::resize(size_t num_paths) {
+  origin_x_.resize(num_paths);
+  origin_y_.resize(num_paths);
+  origin_z_.resize(num_paths);
+  direction_x_.resize(num_paths);
+  direction_y_.resize(num_paths);
+  direction_z_.resize(num_paths);
+  throughput_r_.resize(num_paths);
+  throughput_g_.resize(num_paths);
+  throughput_b_.resize(num_paths);
+  path_index_.resize(num_paths);
+  pixel_index_.resize(num_paths);
+  sample_index_.resize(num_paths);
+  bounces_.resize(num_paths);
+  hit_t_.resize(num_paths);
+  hit_object_.resize(num_paths);
+  hit_primitive_index_.resize(num_paths);
+  hit_instanced_object_.resize(num_paths);
+  hit_material_id_.resize(num_paths);
+  is_active_.resize(num_paths);
+}
+
+void RayQueue::setRay(size_t index, const ray& kRay) {
+  const point3 kOrigin = kRay.origin();
+  const vec3 kDirection = kRay.direction();
+  origin_x_[index] = kOrigin.x();
+  origin_y_[index] = kOrigin.y();
+  origin_z_[index] = kOrigin.z();
+  direction_x_[index] = kDirection.x();
+  direction_y_[index] = kDirection.y();
+  direction_z_[index] = kDirection.z();
+}
+
+void RayQueue::setThroughput(size_t index, const color& kThroughput) {
+  throughput_r_[index] = kThroughput.x();
+  throughput_g_[index] = kThroughput.y();
+  throughput_b_[index] = kThroughput.z();
+}
+
+void RayQueue::copyPath(size_t from, size_t to) {
+  origin_x_[to] = origin_x_[from];
+  origin_y_[to] = origin_y_[from];
+  origin_z_[to] = origin_z_[from];
+  direction_x_[to] = direction_x_[from];
+  direction_y_[to] = direction_y_[from];
+  direction_z_[to] = direction_z_[from];
+  throughput_r_[to] = throughput_r_[from];
+  throughput_g_[to] = throughput_g_[from];
+  throughput_b_[to] = throughput_b_[from];
+  path_index_[to] = path_index_[from];
+  pixel_index_[to] = pixel_index_[from];
+  sample_index_[to] = sample_index_[from];
+  bounces_[to] = bounces_[from];
+  is_active_[to] = is_active_[from];
+}
+
+void generateCameraRays(const camera& kCamera, const RenderSettings& kSettings,
+    const ImageTile& kTile, RayQueue& queue) {
+  const int kTileWidth = kTile.end_column_ - kTile.first_column_;
+  const size_t kNumPixels = static_cast<size_t>(kTile.end_row_ - kTile.first_row_) * kTileWidth;
+  const size_t kSamplesPerPixel = static_cast<size_t>(kSettings.samples_per_pixel_);
+  queue.resize(kNumPixels * kSamplesPerPixel);
+
+  size_t path_index = 0;
+  for (int row = kTile.first_row_; row < kTile.end_row_; ++row) {
+    for (int j = kTile.first_column_; j < kTile.end_column_; ++j) {
+      const size_t kPixelIndex = (static_cast<size_t>(row) * kSettings.image_width_) + j;
+      for (size_t k = 0; k < kSamplesPerPixel; ++k) {
+        queue.setRay(path_index, cameraRay(kCamera, kSettings, row, j, static_cast<uint32_t>(k)));
+        queue.setThroughput(path_index, color(1, 1, 1));
+        queue.path_index_[path_index] = static_cast<uint32_t>(path_index);
+        queue.pixel_index_[path_index] = static_cast<uint32_t>(kPixelIndex);
+        queue.sample_index_[path_index] = static_cast<uint32_t>(k);
+        queue.bounces_[path_index] = 0;
+        queue.is_active_[path_index] = 1;
+        ++path_index;
+      }
+    }
+  }
+}
+
+size_t intersectRays(RayQueue& queue, const Hittable& kObjects, const RenderSettings& kSettings,
+    std::vector<color>& path_radiance) {
+  // ignore hits that are extremely close to 0 to fix shadow acne
+  const real kMinT = 0.001;
+  size_t num_bounces = 0;
+  HitRecord hit_record = HitRecord();
+  for (size_t i = 0; i < queue.size(); ++i) {
+    // gather no more light after the bounce limit has been exceeded
+    if (queue.bounces_[i] >= kSettings.max_ray_bounces_) {
+      queue.is_active_[i] = 0;
+      continue;
+    }
+    ++queue.bounces_[i];
+    ++num_bounces;
+
+    const ray kRay = queue.getRay(i);
+    if (kObjects.intersect(kRay, kMinT, infinity, hit_record)) {
+      queue.hit_t_[i] = hit_record.t_;
+      queue.hit_object_[i] = hit_record.hit_object_;
+      queue.hit_primitive_index_[i] = hit_record.primitive_index_;
+      queue.hit_instanced_object_[i] = hit_record.instanced_object_;
+      queue.hit_material_id_[i] = hit_record.material_id_;
+    } else {
+      // the path ends in the background
+      path_radiance[queue.path_index_[i]] += queue.getThroughput(i) * backgroundColor(kRay);
+      queue.is_active_[i] = 0;
+    }
+  }
+  return num_bounces;
+}
+
+/**
+ * Finalizes the hit of the active path at the given index of the queue and scatters the path 
+ * off of the material of the hit, ending the path if it is absorbed or loses Russian roulette
+ *
+ * @param queue reference to the queue of the path
+ * @param index the index of the path in the queue
+ * @param kMaterials constant reference to the table of the materials of the objects
+ * @param kSettings constant reference to the settings to render with
+ */
+inline void scatterPath(RayQueue& queue, size_t index, const material_table& kMaterials,
+    const RenderSettings& kSettings) {
+  // the scatter of a bounce draws from the same stream as when the path is traced alone
+  setRandomStream(queue.pixel_index_[index], queue.sample_index_[index], queue.bounces_[index]);
+
+  const ray kRay = queue.getRay(index);
+  HitRecord hit_record = HitRecord();
+  hit_record.t_ = queue.hit_t_[index];
+  hit_record.hit_object_ = queue.hit_object_[index];
+  hit_record.primitive_index_ = queue.hit_primitive_index_[index];
+  hit_record.instanced_object_ = queue.hit_instanced_object_[index];
+  hit_record.material_id_ = queue.hit_material_id_[index];
+  hit_record.hit_object_->finalizeHit(kRay, hit_record);
+
+  // an absorbed path gathers no more light
+  ray scattered_ray;
+  color attenuation;
+  if (!scatterHit(kMaterials, hit_record.material_id_, kSettings, kRay, hit_record, attenuation, 
+      scattered_ray)) {
+    queue.is_active_[index] = 0;
+    return;
+  }
+  color throughput = queue.getThroughput(index) * attenuation;
+  if (!survivesRussianRoulette(throughput, queue.bounces_[index], kSettings)) {
+    queue.is_active_[index] = 0;
+    return;
+  }
+  queue.setRay(index, scattered_ray);
+  queue.setThroughput(index, throughput);
+}
+
+void shadeRays(RayQueue& queue, const material_table& kMaterials, const RenderSettings& kSettings,
+    RenderStatistics& statistics) {
+  // count the hits of every material
+  std::vector<size_t> group_sizes = std::vector<size_t>(kMaterials.size());
+  for (size_t i = 0; i < queue.size(); ++i) {
+    if (queue.is_active_[i]) {
+      ++group_sizes[queue.hit_material_id_[i]];
+    }
+  }
+  for (size_t material_id = 0; material_id < group_sizes.size(); ++material_id) {
+    statistics.material_shade_counts_[material_id] += group_sizes[material_id];
+  }
+
+  if (!kSettings.sort_by_material_) {
+    for (size_t i = 0; i < queue.size(); ++i) {
+      if (queue.is_active_[i]) {
+        scatterPath(queue, i, kMaterials, kSettings);
+      }
+    }
+    return;
+  }
+
+  // counting sort of the active paths by material, with the groups laid out by material type
+  std::vector<size_t> group_ends = std::vector<size_t>(kMaterials.size());
+  size_t num_sorted = 0;
+  for (uint32_t material_id : kMaterials.materialsByType()) {
+    group_ends[material_id] = num_sorted;
+    num_sorted += group_sizes[material_id];
+  }
+  std::vector<uint32_t> shading_order = std::vector<uint32_t>(num_sorted);
+  for (size_t i = 0; i < queue.size(); ++i) {
+    if (queue.is_active_[i]) {
+      shading_order[group_ends[queue.hit_material_id_[i]]++] = static_cast<uint32_t>(i);
+    }
+  }
+
+  // scatter every group off of its material in one loop
+  size_t group_begin = 0;
+  for (uint32_t material_id : kMaterials.materialsByType()) {
+    const size_t kGroupEnd = group_ends[material_id];
+    if (group_begin == kGroupEnd) {
+      continue;
+    }
+    const std::chrono::steady_clock::time_point kStart = std::chrono::steady_clock::now();
+    for (size_t i = group_begin; i < kGroupEnd; ++i) {
+      scatterPath(queue, shading_order[i], kMaterials, kSettings);
+    }
+    statistics.material_shade_seconds_[material_id] += std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - kStart).count();
+    group_begin = kGroupEnd;
+  }
+}
+
+void compactRays(RayQueue& queue) {
+  size_t num_active = 0;
+  for (size_t i = 0; i < queue.size(); ++i) {
+    if (queue.is_active_[i]) {
+      if (i != num_active) {
+        queue.copyPath(i, num_active);
+      }
+      ++num_active;
+    }
+  }
+  queue.resize(num_active);
+}
+
+void renderTileWavefront(const camera& kCamera, const Hittable& kObjects, 
+    const material_table& kMaterials, const RenderSettings& kSettings, const ImageTile& kTile, 
+    std::vector<color>& framebuffer, RenderStatistics& statistics) {
+  RayQueue queue = RayQueue();
+  generateCameraRays(kCamera, kSettings, kTile, queue);
+  std::vector<color> path_radiance = std::vector<color>(queue.size());
+  statistics.num_paths_ += queue.size();
+  statistics.material_shade_counts_.resize(kMaterials.size());
+  statistics.material_shade_seconds_.resize(kMaterials.size());
+
+  while (queue.size() > 0) {
+    statistics.num_bounces_ += intersectRays(queue, kObjects, kSettings, path_radiance);
+    shadeRays(queue, kMaterials, kSettings, statistics);
+    compactRays(queue);
+  }
+
+  // sum the samples of every pixel in sample order, as when the paths are traced one at a time
+  const size_t kSamplesPerPixel = static_cast<size_t>(kSettings.samples_per_pixel_);
+  size_t path_index = 0;
+  for (int row = kTile.first_row_; row < kTile.end_row_; ++row) {
+    for (int j = kTile.first_column_; j < kTile.end_column_; ++j) {
+      color pixel_color = color(); // defaults to zero vector
+      for (size_t k = 0; k < kSamplesPerPixel; ++k) {
+        pixel_color += path_radiance[path_index++];
+      }
+      framebuffer[(static_cast<size_t>(row) * kSettings.image_width_) + j] = pixel_color;
+    }
+  }
+}
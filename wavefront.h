@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "camera.h"
+#include "Hittable.h"
+#include "material_table.h"
+#include "ray.h"
+#include "renderer.h"
+#include "vec3.h"
+
+/**
+ * Struct storing a batch of in-flight paths as a structure of arrays (SoA)
+ *
+ * Entry i of every array belongs to the same path. Each stage of the wavefront is a tight loop 
+ * over the queue that only touches the arrays it needs
+ */
+struct RayQueue {
+  // x, y, and z components of the origins of the rays the paths continue along
+  std::vector<real> origin_x_;
+  std::vector<real> origin_y_;
+  std::vector<real> origin_z_;
+
+  // x, y, and z components of the directions of the rays the paths continue along
+  std::vector<real> direction_x_;
+  std::vector<real> direction_y_;
+  std::vector<real> direction_z_;
+
+  // red, green, and blue components of the throughputs of the paths
+  std::vector<real> throughput_r_;
+  std::vector<real> throughput_g_;
+  std::vector<real> throughput_b_;
+
+  // index of every path in the batch (where its radiance is stored)
+  std::vector<uint32_t> path_index_;
+
+  // index of the pixel of every path in the image (its random stream)
+  std::vector<uint32_t> pixel_index_;
+
+  // index of the sample of the pixel of every path (its random stream)
+  std::vector<uint32_t> sample_index_;
+
+  // number of bounces every path has taken so far
+  std::vector<uint32_t> bounces_;
+
+  // t value of the closest hit of every path found by the intersect stage
+  std::vector<real> hit_t_;
+
+  // primitive object of the closest hit of every path found by the intersect stage
+  std::vector<const Hittable*> hit_object_;
+
+  // index of the primitive (within the hit object) of the closest hit of every path found by 
+  // the intersect stage
+  std::vector<uint32_t> hit_primitive_index_;
+
+  // object hit inside an instance by the closest hit of every path found by the intersect stage
+  std::vector<const Hittable*> hit_instanced_object_;
+
+  // material ID of the closest hit of every path found by the intersect stage
+  std::vector<uint32_t> hit_material_id_;
+
+  // 1 for every path that is still being traced, 0 for paths to remove when compacting
+  std::vector<uint8_t> is_active_;
+
+  /**
+   * Returns the number of paths in the queue
+   *
+   * @return a size_t representing the number of paths in the queue
+   */
+  inline size_t size() const {
+    return path_index_.size();
+  }
+
+  /**
+   * Resizes every array of the queue to hold the given number of paths
+   *
+   * @param num_paths the number of paths the queue holds
+   */
+  void resize(size_t num_paths);
+
+  /**
+   * Returns the ray that the path at the given index continues along
+   *
+   * @param index the index of the path in the queue
+   * @return the ray of the path
+   */
+  inline ray getRay(size_t index) const {
+    return ray(point3(origin_x_[index], origin_y_[index], origin_z_[index]),
+        vec3(direction_x_[index], direction_y_[index], direction_z_[index]));
+  }
+
+  /**
+   * Sets the ray that the path at the given index continues along
+   *
+   * @param index the index of the path in the queue
+   * @param kRay constant reference to the new ray of the path
+   */
+  void setRay(size_t index, const ray& kRay);
+
+  /**
+   * Returns the throughput of the path at the given index
+   *
+   * @param index the index of the path in the queue
+   * @return a color representing the throughput of the path
+   */
+  inline color getThroughput(size_t index) const {
+    return color(throughput_r_[index], throughput_g_[index], throughput_b_[index]);
+  }
+
+  /**
+   * Sets the throughput of the path at the given index
+   *
+   * @param index the index of the path in the queue
+   * @param kThroughput constant reference to the new throughput of the path
+   */
+  void setThroughput(size_t index, const color& kThroughput);
+
+  /**
+   * Copies every array entry of the path at one index to another index, except for the hit, 
+   * which is rewritten by the next intersect stage
+   *
+   * @param from the index of the path to copy
+   * @param to the index to copy the path to
+   */
+  void copyPath(size_t from, size_t to);
+};
+
+/**
+ * Fills the given queue with the camera rays of every sample of every pixel of the given tile
+ *
+ * @param kCamera constant reference to the camera to render from
+ * @param kSettings constant reference to the settings to render with
+ * @param kTile constant reference to the tile to generate the camera rays of
+ * @param queue reference to the queue to fill (the path index of a sample is 
+ *     (pixel in the tile) * samples per pixel + sample index)
+ */
+void generateCameraRays(const camera& kCamera, const RenderSettings& kSettings,
+    const ImageTile& kTile, RayQueue& queue);
+
+/**
+ * Finds the closest hit of every path in the queue, ending the paths that have run out of 
+ * bounces or that miss every object (which gather the background light)
+ *
+ * @param queue reference to the queue of paths to intersect
+ * @param kObjects constant reference to the hittable objects the paths can hit
+ * @param kSettings constant reference to the settings to render with
+ * @param path_radiance reference to the light gathered by every path of the batch
+ * @return the number of bounces (closest hit queries) traced
+ */
+size_t intersectRays(RayQueue& queue, const Hittable& kObjects, const RenderSettings& kSettings,
+    std::vector<color>& path_radiance);
+
+/**
+ * Scatters every active path in the queue off of the material of its hit (finalizing the hit 
+ * first), ending the paths that are absorbed or lose Russian roulette
+ *
+ * If the settings ask to sort by material, the hits are first grouped by material type and 
+ * then material (with a counting sort on the material ID), and each group is scattered in one 
+ * tight loop over the same material, so the branches and the call target of scatter stay the 
+ * same from one hit to the next
+ *
+ * @param queue reference to the queue of paths to shade
+ * @param kMaterials constant reference to the table of the materials of the objects
+ * @param kSettings constant reference to the settings to render with
+ * @param statistics reference to a RenderStatistics to add the per material counts to (its 
+ *     per material vectors must have an entry for every material)
+ */
+void shadeRays(RayQueue& queue, const material_table& kMaterials, const RenderSettings& kSettings,
+    RenderStatistics& statistics);
+
+/**
+ * Removes the paths that have ended from the queue, keeping the order of the others
+ *
+ * @param queue reference to the queue of paths to compact
+ */
+void compactRays(RayQueue& queue);
+
+/**
+ * Renders the pixels of the given tile as a wavefront: every sample of the tile is generated 
+ * at once, and then the intersect, shade, and compact stages each run over the whole batch 
+ * until every path has ended
+ *
+ * Paths draw from the same random streams as when they are traced one at a time, and the 
+ * samples of every pixel are summed in the same order, so both modes render the same image
+ *
+ * @param kCamera constant reference to the camera to render from
+ * @param kObjects constant reference to the hittable objects to render
+ * @param kMaterials constant reference to the table of the materials of the objects
+ * @param kSettings constant reference to the settings to render with
+ * @param kTile constant reference to the tile of the image to render
+ * @param framebuffer reference to the framebuffer to store the pixels of the tile in
+ * @param statistics reference to a RenderStatistics to add the counts of the tile to
+ */
+void renderTileWavefront(const camera& kCamera, const Hittable& kObjects, 
+    const material_table& kMaterials, const RenderSettings& kSettings, const ImageTile& kTile, 
+    std::vector<color>& framebuffer, RenderStatistics& statistics);
@@ -0,0 +1,288 @@
+#include <cassert>
+
+#include "wide_bvh.h"
+
+// maximum number of children that can be waiting on the traversal stack (a node pushes at most
+// kBvhWidth of them, and a collapsed tree is no deeper than the bvh it was collapsed from)
+const size_t kMaxWideTraversalStackSize = kMaxTraversalStackSize * kBvhWidth;
+
+/**
+ * Struct storing a child of a wide_bvh node that is waiting to be visited
+ */
+struct WideBvhStackEntry {
+  // index of the child node, or of the first object of a leaf child
+  uint32_t offset_;
+  // number of objects in a leaf child (0 for interior children)
+  uint32_t object_count_;
+  // t value at which the ray enters the box of the child
+  real entry_t_;
+};
+
+wide_bvh::wide_bvh(const hittable_list& kObjects) : wide_bvh(bvh(kObjects)) {}
+
+wide_bvh::wide_bvh(const bvh& kHierarchy) {
+  const std::vector<BvhNode>& kBinaryNodes = kHierarchy.nodes();
+  if (kBinaryNodes.empty()) {
+    return;
+  }
+
+  // a full collapse has about 2 / kBvhWidth as many nodes as the binary tree
+  nodes_.reserve(kBinaryNodes.size() / (kBvhWidth / 2));
+  collapse(kBinaryNodes, 0);
+  bounds_ = kBinaryNodes[0].bounds_;
+
+  // leaf offsets are copied unchanged, so the objects stay in the binary tree's leaf order
+  objects_ = kHierarchy.leafObjects();
+  owned_objects_ = kHierarchy.objects();
+}
+
+uint32_t wide_bvh::collapse(const std::vector<BvhNode>& kBinaryNodes, uint32_t binary_node_index) {
+  // start from the children of the binary node (or the node itself if the whole tree is one
+  // leaf), then keep opening the interior child with the largest box, which the most rays hit
+  uint32_t children[kBvhWidth];
+  int child_count = 0;
+  const BvhNode& kBinaryNode = kBinaryNodes[binary_node_index];
+  if (kBinaryNode.isLeaf()) {
+    children[child_count++] = binary_node_index;
+  } else {
+    children[child_count++] = binary_node_index + 1;
+    children[child_count++] = kBinaryNode.offset_;
+  }
+  while (child_count < kBvhWidth) {
+    int largest_child = -1;
+    real largest_area = -1;
+    for (int i = 0; i < child_count; ++i) {
+      const BvhNode& kChild = kBinaryNodes[children[i]];
+      if (!kChild.isLeaf() && kChild.bounds_.surfaceArea() > largest_area) {
+        largest_area = kChild.bounds_.surfaceArea();
+        largest_child = i;
+      }
+    }
+    if (largest_child < 0) {
+      break;
+    }
+    // the left child takes the opened child's slot so the children stay in spatial order
+    const uint32_t kOpenedIndex = children[largest_child];
+    children[largest_child] = kOpenedIndex + 1;
+    children[child_count++] = kBinaryNodes[kOpenedIndex].offset_;
+  }
+
+  const uint32_t kNodeIndex = static_cast<uint32_t>(nodes_.size());
+  nodes_.push_back(WideBvhNode());
+  WideBvhNode& node = nodes_[kNodeIndex];
+  for (int slot = 0; slot < kWideBvhSlotCount; ++slot) {
+    node.minimum_x_[slot] = infinity;
+    node.minimum_y_[slot] = infinity;
+    node.minimum_z_[slot] = infinity;
+    node.maximum_x_[slot] = -infinity;
+    node.maximum_y_[slot] = -infinity;
+    node.maximum_z_[slot] = -infinity;
+    node.child_offsets_[slot] = 0;
+    node.child_object_counts_[slot] = 0;
+  }
+  node.child_count_ = static_cast<uint32_t>(child_count);
+
+  for (int slot = 0; slot < child_count; ++slot) {
+    const BvhNode& kChild = kBinaryNodes[children[slot]];
+    const point3 kMinimum = kChild.bounds_.minimum();
+    const point3 kMaximum = kChild.bounds_.maximum();
+    // collapsing the child can grow nodes_, so node is not used past this point
+    uint32_t offset = kChild.offset_;
+    if (!kChild.isLeaf()) {
+      offset = collapse(kBinaryNodes, children[slot]);
+    }
+    WideBvhNode& parent = nodes_[kNodeIndex];
+    parent.minimum_x_[slot] = kMinimum.x();
+    parent.minimum_y_[slot] = kMinimum.y();
+    parent.minimum_z_[slot] = kMinimum.z();
+    parent.maximum_x_[slot] = kMaximum.x();
+    parent.maximum_y_[slot] = kMaximum.y();
+    parent.maximum_z_[slot] = kMaximum.z();
+    parent.child_offsets_[slot] = offset;
+    parent.child_object_counts_[slot] = kChild.object_count_;
+  }
+  return kNodeIndex;
+}
+
+bool wide_bvh::intersect(const ray& kRay, real min_t, real max_t, HitRecord& hit_record) const {
+  if (nodes_.empty()) {
+    return false;
+  }
+
+  const point3 kOrigin = kRay.origin();
+  const vec3 kInverseDirection = inverseDirection(kRay.direction());
+  const RealLanes kOriginX = realLanesBroadcast(kOrigin.x());
+  const RealLanes kOriginY = realLanesBroadcast(kOrigin.y());
+  const RealLanes kOriginZ = realLanesBroadcast(kOrigin.z());
+  const RealLanes kInverseX = realLanesBroadcast(kInverseDirection.x());
+  const RealLanes kInverseY = realLanesBroadcast(kInverseDirection.y());
+  const RealLanes kInverseZ = realLanesBroadcast(kInverseDirection.z());
+  const RealLanes kMinT = realLanesBroadcast(min_t);
+  // the ray enters a box through its minimum plane on axes it travels along in the positive
+  // direction and through its maximum plane on the others
+  const bool kNegativeX = kInverseDirection.x() < 0;
+  const bool kNegativeY = kInverseDirection.y() < 0;
+  const bool kNegativeZ = kInverseDirection.z() < 0;
+
+  WideBvhStackEntry stack[kMaxWideTraversalStackSize];
+  size_t stack_size = 0;
+  uint32_t node_index = 0;
+  bool has_hit_anything = false;
+  real closest_t_value = max_t;
+
+  while (true) {
+    const WideBvhNode& kNode = nodes_[node_index];
+    const real* kEntryX = kNegativeX ? kNode.maximum_x_ : kNode.minimum_x_;
+    const real* kEntryY = kNegativeY ? kNode.maximum_y_ : kNode.minimum_y_;
+    const real* kEntryZ = kNegativeZ ? kNode.maximum_z_ : kNode.minimum_z_;
+    const real* kExitX = kNegativeX ? kNode.minimum_x_ : kNode.maximum_x_;
+    const real* kExitY = kNegativeY ? kNode.minimum_y_ : kNode.maximum_y_;
+    const real* kExitZ = kNegativeZ ? kNode.minimum_z_ : kNode.maximum_z_;
+    const RealLanes kMaxT = realLanesBroadcast(closest_t_value);
+
+    // slab test of the ray against every child box at once
+    real entry_t_values[kWideBvhSlotCount];
+    int hit_mask = 0;
+    for (int slot = 0; slot < kWideBvhSlotCount; slot += kRealLaneCount) {
+      // folded in the same order as aabb::wasHit, so an axis whose t value is NaN is skipped
+      RealLanes entry_t = realLanesMax(realLanesMultiply(
+          realLanesSubtract(realLanesLoad(kEntryX + slot), kOriginX), kInverseX), kMinT);
+      entry_t = realLanesMax(realLanesMultiply(
+          realLanesSubtract(realLanesLoad(kEntryY + slot), kOriginY), kInverseY), entry_t);
+      entry_t = realLanesMax(realLanesMultiply(
+          realLanesSubtract(realLanesLoad(kEntryZ + slot), kOriginZ), kInverseZ), entry_t);
+      RealLanes exit_t = realLanesMin(realLanesMultiply(
+          realLanesSubtract(realLanesLoad(kExitX + slot), kOriginX), kInverseX), kMaxT);
+      exit_t = realLanesMin(realLanesMultiply(
+          realLanesSubtract(realLanesLoad(kExitY + slot), kOriginY), kInverseY), exit_t);
+      exit_t = realLanesMin(realLanesMultiply(
+          realLanesSubtract(realLanesLoad(kExitZ + slot), kOriginZ), kInverseZ), exit_t);
+      hit_mask |= realLanesLessEqualMask(entry_t, exit_t) << slot;
+      realLanesStore(entry_t_values + slot, entry_t);
+    }
+
+    // push the hit children farthest first, so the nearest one is visited next and farther
+    // ones can be culled by the closest hit found so far
+    const size_t kFirstPushed = stack_size;
+    for (int slot = 0; slot < kBvhWidth; ++slot) {
+      if ((hit_mask & (1 << slot)) == 0) {
+        continue;
+      }
+      const WideBvhStackEntry kEntry = WideBvhStackEntry{kNode.child_offsets_[slot],
+          kNode.child_object_counts_[slot], entry_t_values[slot]};
+      assert(stack_size < kMaxWideTraversalStackSize);
+      size_t position = stack_size++;
+      while (position > kFirstPushed && stack[position - 1].entry_t_ < kEntry.entry_t_) {
+        stack[position] = stack[position - 1];
+        --position;
+      }
+      stack[position] = kEntry;
+    }
+
+    // intersect leaves until the next interior child to visit comes up
+    bool has_next_node = false;
+    while (!has_next_node && stack_size > 0) {
+      const WideBvhStackEntry kEntry = stack[--stack_size];
+      if (kEntry.entry_t_ > closest_t_value) {
+        continue;
+      }
+      if (kEntry.object_count_ == 0) {
+        node_index = kEntry.offset_;
+        has_next_node = true;
+        continue;
+      }
+      for (uint32_t i = kEntry.offset_; i < kEntry.offset_ + kEntry.object_count_; ++i) {
+        if (objects_[i]->intersect(kRay, min_t, closest_t_value, hit_record)) {
+          closest_t_value = hit_record.t_;
+          has_hit_anything = true;
+        }
+      }
+    }
+    if (!has_next_node) {
+      break;
+    }
+  }
+  return has_hit_anything;
+}
+
+bool wide_bvh::isOccluded(const ray& kRay, real min_t, real max_t) const {
+  if (nodes_.empty()) {
+    return false;
+  }
+
+  const point3 kOrigin = kRay.origin();
+  const vec3 kInverseDirection = inverseDirection(kRay.direction());
+  const RealLanes kOriginX = realLanesBroadcast(kOrigin.x());
+  const RealLanes kOriginY = realLanesBroadcast(kOrigin.y());
+  const RealLanes kOriginZ = realLanesBroadcast(kOrigin.z());
+  const RealLanes kInverseX = realLanesBroadcast(kInverseDirection.x());
+  const RealLanes kInverseY = realLanesBroadcast(kInverseDirection.y());
+  const RealLanes kInverseZ = realLanesBroadcast(kInverseDirection.z());
+  const RealLanes kMinT = realLanesBroadcast(min_t);
+  const RealLanes kMaxT = realLanesBroadcast(max_t);
+  const bool kNegativeX = kInverseDirection.x() < 0;
+  const bool kNegativeY = kInverseDirection.y() < 0;
+  const bool kNegativeZ = kInverseDirection.z() < 0;
+
+  // without a closest hit to cull by, children are visited in slot order and need no entry t
+  WideBvhStackEntry stack[kMaxWideTraversalStackSize];
+  size_t stack_size = 0;
+  stack[stack_size++] = WideBvhStackEntry{0, 0, 0};
+
+  while (stack_size > 0) {
+    const WideBvhStackEntry kEntry = stack[--stack_size];
+    if (kEntry.object_count_ > 0) {
+      for (uint32_t i = kEntry.offset_; i < kEntry.offset_ + kEntry.object_count_; ++i) {
+        if (objects_[i]->isOccluded(kRay, min_t, max_t)) {
+          return true;
+        }
+      }
+      continue;
+    }
+
+    const WideBvhNode& kNode = nodes_[kEntry.offset_];
+    const real* kEntryX = kNegativeX ? kNode.maximum_x_ : kNode.minimum_x_;
+    const real* kEntryY = kNegativeY ? kNode.maximum_y_ : kNode.minimum_y_;
+    const real* kEntryZ = kNegativeZ ? kNode.maximum_z_ : kNode.minimum_z_;
+    const real* kExitX = kNegativeX ? kNode.minimum_x_ : kNode.maximum_x_;
+    const real* kExitY = kNegativeY ? kNode.minimum_y_ : kNode.maximum_y_;
+    const real* kExitZ = kNegativeZ ? kNode.minimum_z_ : kNode.maximum_z_;
+    int hit_mask = 0;
+    for (int slot = 0; slot < kWideBvhSlotCount; slot += kRealLaneCount) {
+      // the same slab test as intersect
+      RealLanes entry_t = realLanesMax(realLanesMultiply(
+          realLanesSubtract(realLanesLoad(kEntryX + slot), kOriginX), kInverseX), kMinT);
+      entry_t = realLanesMax(realLanesMultiply(
+          realLanesSubtract(realLanesLoad(kEntryY + slot), kOriginY), kInverseY), entry_t);
+      entry_t = realLanesMax(realLanesMultiply(
+          realLanesSubtract(realLanesLoad(kEntryZ + slot), kOriginZ), kInverseZ), entry_t);
+      RealLanes exit_t = realLanesMin(realLanesMultiply(
+          realLanesSubtract(realLanesLoad(kExitX + slot), kOriginX), kInverseX), kMaxT);
+      exit_t = realLanesMin(realLanesMultiply(
+          realLanesSubtract(realLanesLoad(kExitY + slot), kOriginY), kInverseY), exit_t);
+      exit_t = realLanesMin(realLanesMultiply(
+          realLanesSubtract(realLanesLoad(kExitZ + slot), kOriginZ), kInverseZ), exit_t);
+      hit_mask |= realLanesLessEqualMask(entry_t, exit_t) << slot;
+    }
+    for (int slot = 0; slot < kBvhWidth; ++slot) {
+      if ((hit_mask & (1 << slot)) != 0) {
+        assert(stack_size < kMaxWideTraversalStackSize);
+        stack[stack_size++] = WideBvhStackEntry{kNode.child_offsets_[slot],
+            kNode.child_object_counts_[slot], 0};
+      }
+    }
+  }
+  return false;
+}
+
+bool wide_bvh::boundingBox(real time0, real time1, aabb& output_box) const {
+  if (nodes_.empty()) {
+    return false;
+  }
+  output_box = bounds_;
+  return true;
+}
+
+size_t wide_bvh::nodeCount() const {
+  return nodes_.size();
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "aabb.h"
+#include "bvh.h"
+#include "Hittable.h"
+#include "hittable_list.h"
+#include "real_lanes.h"
+
+#ifndef RAYTRACER_BVH_WIDTH
+// maximum number of children of a wide_bvh node (4 or 8; build with -DRAYTRACER_BVH_WIDTH=n,
+// or make BVH_WIDTH=n, to change it)
+#define RAYTRACER_BVH_WIDTH 4
+#endif
+
+// maximum number of children of a wide_bvh node
+const int kBvhWidth = RAYTRACER_BVH_WIDTH;
+
+static_assert(kBvhWidth == 4 || kBvhWidth == 8, "RAYTRACER_BVH_WIDTH must be 4 or 8");
+
+// number of child slots stored in a wide_bvh node, which is kBvhWidth padded to whole registers
+const int kWideBvhSlotCount = kBvhWidth > kRealLaneCount ? kBvhWidth : kRealLaneCount;
+
+/**
+ * Struct storing a single node of a wide bounding volume hierarchy
+ *
+ * The boxes of the children are stored as a structure of arrays (SoA) so the slab test of a ray
+ * against all of them is a handful of RealLanes operations. Unused slots hold empty boxes,
+ * which no ray hits
+ */
+struct WideBvhNode {
+  // minimum x, y, and z of the box of every child
+  real minimum_x_[kWideBvhSlotCount];
+  real minimum_y_[kWideBvhSlotCount];
+  real minimum_z_[kWideBvhSlotCount];
+
+  // maximum x, y, and z of the box of every child
+  real maximum_x_[kWideBvhSlotCount];
+  real maximum_y_[kWideBvhSlotCount];
+  real maximum_z_[kWideBvhSlotCount];
+
+  // for interior children, the index of the child node
+  // for leaf children, the index of the first object in the leaf
+  uint32_t child_offsets_[kWideBvhSlotCount];
+
+  // number of objects in every leaf child (0 for interior children)
+  uint32_t child_object_counts_[kWideBvhSlotCount];
+
+  // number of slots in use
+  uint32_t child_count_;
+};
+
+/**
+ * Class representing a bounding volume hierarchy whose nodes have up to kBvhWidth children
+ *
+ * The hierarchy is made by collapsing a binary SAH bvh: every node repeatedly replaces its
+ * largest interior child with that child's children until it has kBvhWidth of them. A ray is
+ * tested against all children of a node at once, so the lanes a binary bvh leaves idle do
+ * useful work and far fewer nodes are visited. It finds the same closest hits as the bvh it was
+ * collapsed from
+ */
+class wide_bvh : public Hittable {
+  public:
+    /**
+     * Default Constructor (makes an empty hierarchy that is never hit)
+     */
+    wide_bvh() {}
+
+    /**
+     * Constructor that builds a binary bvh over all of the objects in the given list and
+     * collapses it
+     *
+     * @param kObjects constant reference to the list of objects to build the hierarchy over
+     * @throws std::invalid_argument if an object in the list has no bounding box
+     */
+    explicit wide_bvh(const hittable_list& kObjects);
+
+    /**
+     * Constructor that collapses the given binary hierarchy
+     *
+     * @param kHierarchy constant reference to the binary hierarchy to collapse
+     */
+    explicit wide_bvh(const bvh& kHierarchy);
+
+    /**
+     * Returns true if any of the objects in the hierarchy are hit by the given ray
+     * Updates the t value and hit object of the hit record with the closest intersection
+     * (does nothing if no hits)
+     *
+     * @param kRay constant reference to the ray to check if it hits a
+     *     hittable object in the hierarchy
+     * @param min_t real representing the minimum t value for the intersection
+     * @param max_t real representing the maximum t value for the intersection
+     * @param hit_record reference to a hit record to update with the details of the
+     *     intersection of the ray and the closest hit object (not updated if no
+     *     objects in the hierarchy are hit within the acceptable t value range)
+     * @return true if a hittable object in the hierarchy was hit by the given ray in the
+     *     given range of values for t and false otherwise
+     */
+    virtual bool intersect(const ray& kRay, real min_t, real max_t,
+        HitRecord& hit_record) const override;
+
+    /**
+     * Returns true if any of the objects in the hierarchy are hit by the given ray, stopping at
+     * the first object found to be hit
+     *
+     * @param kRay constant reference to the ray to check if it hits a
+     *     hittable object in the hierarchy
+     * @param min_t real representing the minimum t value for the intersection
+     * @param max_t real representing the maximum t value for the intersection
+     * @return true if a hittable object in the hierarchy was hit by the given ray in the
+     *     given range of values for t and false otherwise
+     */
+    virtual bool isOccluded(const ray& kRay, real min_t, real max_t) const override;
+
+    // see hittable docs
+    virtual bool boundingBox(real time0, real time1, aabb& output_box) const override;
+
+    /**
+     * Returns the number of nodes in the hierarchy
+     *
+     * @return a size_t representing the number of nodes in the hierarchy
+     */
+    size_t nodeCount() const;
+
+  private:
+    /**
+     * Recursively collapses the subtree of the given binary node into wide nodes, appending them
+     * to nodes_ in depth first order
+     *
+     * @param kBinaryNodes constant reference to the nodes of the binary hierarchy
+     * @param binary_node_index the index in kBinaryNodes of the root of the subtree to collapse
+     * @return the index in nodes_ of the root of the collapsed subtree
+     */
+    uint32_t collapse(const std::vector<BvhNode>& kBinaryNodes, uint32_t binary_node_index);
+
+    // vector storing the nodes of the hierarchy in depth first order (root at index 0)
+    std::vector<WideBvhNode> nodes_;
+
+    // aabb bounding every object in the hierarchy
+    aabb bounds_;
+
+    // vector of raw pointers to the objects of the hierarchy in leaf order, used by traversal
+    std::vector<const Hittable*> objects_;
+
+    // vector of shared pointers that keep the objects of the hierarchy alive
+    std::vector<std::shared_ptr<Hittable>> owned_objects_;
+};